@@ -0,0 +1,120 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wintoastlib.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    constexpr std::size_t PairCounts[] = {1, 4, 16, 64};
+
+    // Keys are shuffled so neither container gets them in order, values need escaping like real arguments.
+    std::vector<std::pair<std::wstring, std::wstring>> makePairs(std::size_t count) {
+        std::vector<std::pair<std::wstring, std::wstring>> pairs;
+        pairs.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            const std::size_t key = (i * 37 + 11) % count;
+            pairs.emplace_back(L"key" + std::to_wstring(key), L"value " + std::to_wstring(i) + L" & more;");
+        }
+        return pairs;
+    }
+
+    std::string suffix(std::size_t count) {
+        return "/" + std::to_string(count);
+    }
+}
+
+void WinToastBenchmarks::argumentsBenchmarks(Suite &suite) {
+    for (const std::size_t count: PairCounts) {
+        const auto pairs = makePairs(count);
+        WinToastArguments arguments;
+        std::map<std::wstring, std::wstring, std::less<>> map;
+        for (const auto &[key, value]: pairs) {
+            arguments.add(key, value);
+            map.emplace(key, value);
+        }
+        const std::wstring serialized = arguments.toString();
+
+        suite.run("arguments/parse" + suffix(count), [&](std::uint64_t iterations) {
+            WinToastArguments parsed;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                parsed.parse(serialized);
+                doNotOptimize(parsed);
+            }
+        });
+
+        suite.run("arguments/view_find" + suffix(count), [&](std::uint64_t iterations) {
+            const WinToastArgumentsView view(serialized);
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(view.find(pairs[i % count].first));
+            }
+        });
+
+        suite.run("arguments/to_string" + suffix(count), [&](std::uint64_t iterations) {
+            std::wstring buffer;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                buffer.clear();
+                arguments.toString(buffer);
+                doNotOptimize(buffer);
+            }
+        });
+
+        // The sorted vector against the map it replaced.
+        suite.run("arguments/build_flat" + suffix(count), [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                WinToastArguments built;
+                for (const auto &[key, value]: pairs) {
+                    built.add(key, value);
+                }
+                doNotOptimize(built);
+            }
+        });
+
+        suite.run("arguments/build_map" + suffix(count), [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                std::map<std::wstring, std::wstring, std::less<>> built;
+                for (const auto &[key, value]: pairs) {
+                    built.insert_or_assign(key, value);
+                }
+                doNotOptimize(built);
+            }
+        });
+
+        suite.run("arguments/lookup_flat" + suffix(count), [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(arguments.contains(std::wstring_view(pairs[i % count].first)));
+            }
+        });
+
+        suite.run("arguments/lookup_map" + suffix(count), [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(map.find(std::wstring_view(pairs[i % count].first)) != map.end());
+            }
+        });
+    }
+}
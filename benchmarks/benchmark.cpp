@@ -0,0 +1,166 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+using namespace WinToastBenchmarks;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<std::uint64_t> allocations{0};
+
+    constexpr std::chrono::milliseconds MinimumRunTime{50};
+    constexpr int Repetitions = 5;
+
+    double elapsedNs(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    void appendEscaped(std::string &json, const std::string &text) {
+        for (const char c: text) {
+            if (c == '"' || c == '\\') {
+                json += '\\';
+            }
+            json += c;
+        }
+    }
+}
+
+// Counts the allocations of every benchmark. The array, nothrow and sized forms end up here or in the matching
+// operator delete.
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+Suite::Suite(std::string filter) : _filter(std::move(filter)) {}
+
+void Suite::run(const std::string &name, const std::function<void(std::uint64_t)> &body) {
+    if (!selected(name)) {
+        return;
+    }
+
+    std::uint64_t iterations = 1;
+    for (;;) {
+        const auto start = Clock::now();
+        body(iterations);
+        const double ns = elapsedNs(start);
+        if (ns >= std::chrono::duration<double, std::nano>(MinimumRunTime).count()) {
+            break;
+        }
+        // Aim a bit past the minimum so the next round likely is the last one.
+        const double scale = ns > 0 ? 1.4 * std::chrono::duration<double, std::nano>(MinimumRunTime).count() / ns
+                                    : 100.0;
+        iterations = std::max<std::uint64_t>(iterations + 1,
+                                             static_cast<std::uint64_t>(static_cast<double>(iterations) *
+                                                                        std::min(scale, 100.0)));
+    }
+
+    double best = std::numeric_limits<double>::max();
+    std::uint64_t fewestAllocations = std::numeric_limits<std::uint64_t>::max();
+    for (int i = 0; i < Repetitions; i++) {
+        const std::uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        body(iterations);
+        best = std::min(best, elapsedNs(start));
+        fewestAllocations = std::min(fewestAllocations,
+                                     allocations.load(std::memory_order_relaxed) - allocationsBefore);
+    }
+
+    const double perIteration = best / static_cast<double>(iterations);
+    const double allocationsPerIteration = static_cast<double>(fewestAllocations) / static_cast<double>(iterations);
+    _results.push_back(Result{name, iterations, perIteration, 1e9 / perIteration, allocationsPerIteration});
+    std::fprintf(stderr, "%-60s %14.1f ns %10.2f allocs\n", name.c_str(), perIteration, allocationsPerIteration);
+}
+
+void Suite::measure(const std::string &name, std::uint64_t items, const std::function<void()> &body,
+                    int repetitions) {
+    if (!selected(name)) {
+        return;
+    }
+
+    double best = std::numeric_limits<double>::max();
+    std::uint64_t fewestAllocations = std::numeric_limits<std::uint64_t>::max();
+    for (int i = 0; i < repetitions; i++) {
+        const std::uint64_t allocationsBefore = allocations.load(std::memory_order_relaxed);
+        const auto start = Clock::now();
+        body();
+        best = std::min(best, elapsedNs(start));
+        fewestAllocations = std::min(fewestAllocations,
+                                     allocations.load(std::memory_order_relaxed) - allocationsBefore);
+    }
+
+    const double itemsPerSecond = static_cast<double>(items) * 1e9 / best;
+    _results.push_back(Result{name, 1, best, itemsPerSecond, static_cast<double>(fewestAllocations)});
+    std::fprintf(stderr, "%-60s %14.1f ns %14.0f items/s %10llu allocs\n", name.c_str(), best, itemsPerSecond,
+                 static_cast<unsigned long long>(fewestAllocations));
+}
+
+const std::vector<Result> &Suite::results() const noexcept {
+    return _results;
+}
+
+std::string Suite::toJson() const {
+    std::string json = "{\n  \"benchmarks\": [";
+    char number[64];
+    for (std::size_t i = 0; i < _results.size(); i++) {
+        const Result &result = _results[i];
+        json += i == 0 ? "\n" : ",\n";
+        json += "    {\"name\": \"";
+        appendEscaped(json, result.name);
+        std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(result.iterations));
+        json += "\", \"iterations\": ";
+        json += number;
+        std::snprintf(number, sizeof(number), "%.3f", result.nsPerIteration);
+        json += ", \"ns_per_iteration\": ";
+        json += number;
+        std::snprintf(number, sizeof(number), "%.1f", result.itemsPerSecond);
+        json += ", \"items_per_second\": ";
+        json += number;
+        std::snprintf(number, sizeof(number), "%.3f", result.allocationsPerIteration);
+        json += ", \"allocations_per_iteration\": ";
+        json += number;
+        json += "}";
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+bool Suite::selected(const std::string &name) const {
+    return _filter.empty() || name.find(_filter) != std::string::npos;
+}
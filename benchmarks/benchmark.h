@@ -0,0 +1,100 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_BENCHMARK_H
+#define WINTOAST_BENCHMARK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "wintoastlib.h"
+
+namespace WinToastBenchmarks {
+
+    // Keeps the compiler from optimizing away the computation of value.
+    template<typename T>
+    inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static const void *volatile sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    struct Result {
+        std::string name;
+        std::uint64_t iterations;
+        double nsPerIteration;
+        // Work items per second, for benchmarks where an iteration handles many of them.
+        double itemsPerSecond;
+        // Calls to operator new per iteration, on every thread.
+        double allocationsPerIteration;
+    };
+
+    class Suite {
+    public:
+        // Only benchmarks whose name contains filter run.
+        explicit Suite(std::string filter);
+
+        // Calls body(iterations) with growing iteration counts until a run takes long enough to be timed, then
+        // keeps the fastest of a few runs of that size.
+        void run(const std::string &name, const std::function<void(std::uint64_t)> &body);
+
+        // Times single calls of body, each handling items work items, and keeps the fastest.
+        void measure(const std::string &name, std::uint64_t items, const std::function<void()> &body,
+                     int repetitions = 3);
+
+        [[nodiscard]] const std::vector<Result> &results() const noexcept;
+
+        [[nodiscard]] std::string toJson() const;
+
+    private:
+        [[nodiscard]] bool selected(const std::string &name) const;
+
+        std::string _filter;
+        std::vector<Result> _results;
+    };
+
+    // A template of the given type with every field it has filled in, shared by the template and payload
+    // benchmarks.
+    WinToastLib::WinToastTemplate makeBenchmarkToast(WinToastLib::WinToastTemplate::WinToastTemplateType type);
+
+    void argumentsBenchmarks(Suite &suite);
+
+    void templateBenchmarks(Suite &suite);
+
+    void escapeBenchmarks(Suite &suite);
+
+    void payloadBenchmarks(Suite &suite);
+
+    void pipelineBenchmarks(Suite &suite);
+
+    void registryBenchmarks(Suite &suite);
+
+    void timingWheelBenchmarks(Suite &suite);
+}
+
+#endif //WINTOAST_BENCHMARK_H
@@ -0,0 +1,102 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "xml_escape.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    constexpr std::size_t Lengths[] = {16, 256, 4096};
+
+    // Chat text as toasts carry it: mostly plain, now and then a character to escape.
+    std::wstring makeChat(std::size_t length) {
+        constexpr std::wstring_view Sentence = L"See you at 5? Bring the slides & the demo, it's <almost> ready. ";
+        std::wstring text;
+        while (text.size() < length) {
+            text += Sentence;
+        }
+        text.resize(length);
+        return text;
+    }
+
+    // Nothing to escape, every character can be copied in bulk.
+    std::wstring makeClean(std::size_t length) {
+        constexpr std::wstring_view Sentence = L"Build 1024 finished in 3 minutes without warnings ";
+        std::wstring text;
+        while (text.size() < length) {
+            text += Sentence;
+        }
+        text.resize(length);
+        return text;
+    }
+
+    // Non ASCII text with an emoji now and then, a surrogate pair where wchar_t is 16 bits. Still clean.
+    std::wstring makeWide(std::size_t length) {
+        std::wstring text;
+        while (text.size() < length) {
+            text += L"\u65E5\u672C\u8A9E\u306E\u30C6\u30AD\u30B9\u30C8 \U0001F600 ";
+        }
+        text.resize(length);
+        // Don't leave half a pair at the end, it would be dropped.
+        if (!text.empty() && static_cast<std::uint32_t>(text.back()) >= 0xD800 &&
+            static_cast<std::uint32_t>(text.back()) < 0xDC00) {
+            text.back() = L' ';
+        }
+        return text;
+    }
+
+    void compare(Suite &suite, const std::string &input, const std::wstring &text, XmlEscape::Context context) {
+        const std::string suffix = input + "/" + std::to_string(text.size());
+
+        suite.run("escape/simd/" + suffix, [&](std::uint64_t iterations) {
+            std::wstring buffer;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                buffer.clear();
+                XmlEscape::append(buffer, text, context);
+                doNotOptimize(buffer);
+            }
+        });
+
+        suite.run("escape/scalar/" + suffix, [&](std::uint64_t iterations) {
+            std::wstring buffer;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                buffer.clear();
+                XmlEscape::appendScalar(buffer, text, context);
+                doNotOptimize(buffer);
+            }
+        });
+    }
+}
+
+void WinToastBenchmarks::escapeBenchmarks(Suite &suite) {
+    for (const std::size_t length: Lengths) {
+        compare(suite, "clean", makeClean(length), XmlEscape::Context::Text);
+        compare(suite, "chat", makeChat(length), XmlEscape::Context::Text);
+        compare(suite, "chat_attribute", makeChat(length), XmlEscape::Context::Attribute);
+        compare(suite, "wide", makeWide(length), XmlEscape::Context::Text);
+    }
+}
@@ -0,0 +1,74 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace WinToastBenchmarks;
+
+namespace {
+    void printUsage() {
+        std::fprintf(stderr, "WinToastBenchmarks [--filter=TEXT] [--json=FILE]\n"
+                             "\t--filter : Only run the benchmarks whose name contains TEXT\n"
+                             "\t--json   : Write the results to FILE instead of the standard output\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string filter;
+    std::string jsonPath;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--json=", 7) == 0) {
+            jsonPath = argv[i] + 7;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Suite suite(filter);
+    argumentsBenchmarks(suite);
+    templateBenchmarks(suite);
+    escapeBenchmarks(suite);
+    payloadBenchmarks(suite);
+    pipelineBenchmarks(suite);
+    registryBenchmarks(suite);
+    timingWheelBenchmarks(suite);
+
+    const std::string json = suite.toJson();
+    if (jsonPath.empty()) {
+        std::fputs(json.c_str(), stdout);
+        return 0;
+    }
+
+    FILE *file = std::fopen(jsonPath.c_str(), "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "Could not open %s\n", jsonPath.c_str());
+        return 1;
+    }
+    std::fputs(json.c_str(), file);
+    std::fclose(file);
+    return 0;
+}
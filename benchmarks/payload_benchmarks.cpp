@@ -0,0 +1,72 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <string>
+#include <utility>
+
+#include "wintoastlib.h"
+#include "toast_xml_serializer.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+
+    constexpr std::pair<Type, const char *> Types[] = {
+            {Type::ImageAndText02, "ImageAndText02"},
+            {Type::ImageAndText04, "ImageAndText04"},
+            {Type::Text01,         "Text01"},
+            {Type::Text04,         "Text04"},
+    };
+}
+
+void WinToastBenchmarks::payloadBenchmarks(Suite &suite) {
+    for (const auto &[type, name]: Types) {
+        const WinToastTemplate toast = makeBenchmarkToast(type);
+
+        suite.run(std::string("payload/modern/") + name, [&toast](std::uint64_t iterations) {
+            std::wstring buffer;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                ToastXmlSerializer::serialize(toast, true, buffer);
+                doNotOptimize(buffer);
+            }
+        });
+
+        suite.run(std::string("payload/legacy/") + name, [&toast](std::uint64_t iterations) {
+            std::wstring buffer;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                ToastXmlSerializer::serialize(toast, false, buffer);
+                doNotOptimize(buffer);
+            }
+        });
+
+        // A fresh buffer every time, like a caller that doesn't keep one around.
+        suite.run(std::string("payload/cold_buffer/") + name, [&toast](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                std::wstring buffer;
+                ToastXmlSerializer::serialize(toast, true, buffer);
+                doNotOptimize(buffer);
+            }
+        });
+    }
+}
@@ -0,0 +1,80 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "wintoastlib.h"
+#include "toast_pipeline.h"
+#include "loopback_backend.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+
+    constexpr std::pair<Type, const char *> Types[] = {
+            {Type::ImageAndText04, "ImageAndText04"},
+            {Type::Text01,         "Text01"},
+    };
+
+    constexpr std::size_t BatchSize = 64;
+}
+
+// The whole showToast path short of the notification platform: payload, registry and hide.
+void WinToastBenchmarks::pipelineBenchmarks(Suite &suite) {
+    for (const auto &[type, name]: Types) {
+        const WinToastTemplate toast = makeBenchmarkToast(type);
+
+        suite.run(std::string("pipeline/show_hide/") + name, [&toast](std::uint64_t iterations) {
+            ToastPipeline pipeline(std::make_unique<LoopbackBackend>());
+            WinToast::WinToastError error;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                const INT64 id = pipeline.show(toast, true, error);
+                doNotOptimize(id);
+                pipeline.hide(id);
+            }
+        });
+
+        // Every toast is a duplicate of the first one.
+        suite.run(std::string("pipeline/deduplicated/") + name, [&toast](std::uint64_t iterations) {
+            ToastPipeline pipeline(std::make_unique<LoopbackBackend>());
+            pipeline.setDeduplicationWindow(std::chrono::hours(1));
+            WinToast::WinToastError error;
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(pipeline.show(toast, true, error));
+            }
+        });
+
+        const std::vector<WinToastTemplate> batch(BatchSize, toast);
+        suite.run(std::string("pipeline/batch_of_64/") + name, [&batch](std::uint64_t iterations) {
+            ToastPipeline pipeline(std::make_unique<LoopbackBackend>());
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(pipeline.show(batch.data(), batch.size(), true));
+                pipeline.clear();
+            }
+        });
+    }
+}
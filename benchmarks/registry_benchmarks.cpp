@@ -0,0 +1,111 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "toast_registry.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    constexpr std::size_t ThreadCounts[] = {1, 4, 16};
+    constexpr std::size_t OperationsPerThread = 100000;
+    // Every thread keeps this many of its entries alive, so lookups and erases hit a populated registry.
+    constexpr std::size_t Window = 64;
+
+    // The baseline: one map behind one mutex.
+    class GlobalMutexRegistry {
+    public:
+        INT64 insert(int value) {
+            std::lock_guard lock(_mutex);
+            const INT64 id = ++_lastId;
+            _values.emplace(id, value);
+            return id;
+        }
+
+        [[nodiscard]] std::optional<int> find(INT64 id) const {
+            std::lock_guard lock(_mutex);
+            const auto it = _values.find(id);
+            if (it == _values.end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+
+        bool erase(INT64 id) {
+            std::lock_guard lock(_mutex);
+            return _values.erase(id) > 0;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::unordered_map<INT64, int> _values;
+        INT64 _lastId{0};
+    };
+
+    // Each thread inserts, looks up and erases its own entries, the way concurrent showToast and hideToast
+    // calls use the registry.
+    template<typename Registry>
+    void churn(Registry &registry, std::size_t threads) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (std::size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&registry] {
+                INT64 ids[Window];
+                for (std::size_t i = 0; i < Window; i++) {
+                    ids[i] = registry.insert(static_cast<int>(i));
+                }
+                for (std::size_t i = 0; i < OperationsPerThread; i++) {
+                    INT64 &id = ids[i % Window];
+                    doNotOptimize(registry.find(id));
+                    registry.erase(id);
+                    id = registry.insert(static_cast<int>(i));
+                }
+                for (const INT64 id: ids) {
+                    registry.erase(id);
+                }
+            });
+        }
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+    }
+}
+
+void WinToastBenchmarks::registryBenchmarks(Suite &suite) {
+    for (const std::size_t threads: ThreadCounts) {
+        const std::uint64_t operations = threads * OperationsPerThread * 3;
+        const std::string suffix = "/" + std::to_string(threads) + "_threads";
+
+        ToastRegistry<int> sharded(threads * Window * 2);
+        suite.measure("registry/sharded" + suffix, operations, [&] { churn(sharded, threads); });
+
+        GlobalMutexRegistry global;
+        suite.measure("registry/global_mutex" + suffix, operations, [&] { churn(global, threads); });
+    }
+}
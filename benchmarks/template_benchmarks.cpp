@@ -0,0 +1,174 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <string>
+#include <utility>
+
+#include "wintoastlib.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+
+    constexpr std::pair<Type, const char *> Types[] = {
+            {Type::ImageAndText01, "ImageAndText01"},
+            {Type::ImageAndText02, "ImageAndText02"},
+            {Type::ImageAndText03, "ImageAndText03"},
+            {Type::ImageAndText04, "ImageAndText04"},
+            {Type::Text01,         "Text01"},
+            {Type::Text02,         "Text02"},
+            {Type::Text03,         "Text03"},
+            {Type::Text04,         "Text04"},
+    };
+
+    // The copy textFields() returns is what callers used to get a reference to, and what every template kept.
+    std::size_t copiedTextFieldsSize(const WinToastTemplate &toast) {
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4996)
+#else
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+        std::size_t size = 0;
+        for (const std::wstring &field: toast.textFields()) {
+            size += field.size();
+        }
+        return size;
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#else
+#pragma GCC diagnostic pop
+#endif
+    }
+
+    constexpr int AudioSystemFileCount = static_cast<int>(WinToastTemplate::AudioSystemFile::Call10) + 1;
+}
+
+WinToastTemplate WinToastBenchmarks::makeBenchmarkToast(WinToastTemplate::WinToastTemplateType type) {
+    WinToastTemplate toast(type);
+    for (std::size_t i = 0; i < toast.textFieldsCount(); i++) {
+        toast.setTextField(L"Line " + std::to_wstring(i) + L" of the toast <with> markup & entities",
+                           static_cast<WinToastTemplate::TextField>(i));
+    }
+    if (toast.hasImage()) {
+        toast.setImagePath(L"C:\\Users\\Public\\Pictures\\toast image.png");
+    }
+    toast.setAttributionText(L"via WinToastBenchmarks");
+    toast.setAudioPath(WinToastTemplate::AudioSystemFile::Reminder);
+    toast.addAction(L"Open");
+    toast.addAction(L"Dismiss");
+    return toast;
+}
+
+void WinToastBenchmarks::templateBenchmarks(Suite &suite) {
+    for (const auto &[type, name]: Types) {
+        suite.run(std::string("template/construct/") + name, [type = type](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                WinToastTemplate toast(type);
+                doNotOptimize(toast);
+            }
+        });
+
+        suite.run(std::string("template/populate/") + name, [type = type](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(makeBenchmarkToast(type));
+            }
+        });
+
+        suite.run(std::string("template/builder/") + name, [type = type](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(WinToastTemplate::Builder(type)
+                                      .firstLine(L"Line 0 of the toast <with> markup & entities")
+                                      .attributionText(L"via WinToastBenchmarks")
+                                      .audioPath(WinToastTemplate::AudioSystemFile::Reminder)
+                                      .reserveActions(2)
+                                      .action(L"Open")
+                                      .action(L"Dismiss")
+                                      .build());
+            }
+        });
+
+        // Handing a template over to another owner, like showToastAsync() does.
+        suite.run(std::string("template/move/") + name, [type = type](std::uint64_t iterations) {
+            WinToastTemplate toast = makeBenchmarkToast(type);
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                WinToastTemplate moved(std::move(toast));
+                doNotOptimize(moved);
+                toast = std::move(moved);
+            }
+        });
+
+        const WinToastTemplate populated = makeBenchmarkToast(type);
+        suite.run(std::string("template/copy/") + name, [&populated](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                WinToastTemplate copy(populated);
+                doNotOptimize(copy);
+            }
+        });
+
+        suite.run(std::string("template/text_fields_view/") + name, [&populated](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                std::size_t size = 0;
+                for (const std::wstring &field: populated.textFieldsView()) {
+                    size += field.size();
+                }
+                doNotOptimize(size);
+            }
+        });
+
+        suite.run(std::string("template/text_fields_copy/") + name, [&populated](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                doNotOptimize(copiedTextFieldsSize(populated));
+            }
+        });
+    }
+
+    // The same toast through the compile time checked template and through the dynamic one.
+    suite.run("template/typed_text_fields/Text04", [](std::uint64_t iterations) {
+        TypedToastTemplate<Type::Text04> toast;
+        for (std::uint64_t i = 0; i < iterations; i++) {
+            toast.setFirstLine(L"First").setSecondLine(L"Second").setThirdLine(L"Third");
+            doNotOptimize(toast);
+        }
+    });
+
+    suite.run("template/dynamic_text_fields/Text04", [](std::uint64_t iterations) {
+        WinToastTemplate toast(Type::Text04);
+        for (std::uint64_t i = 0; i < iterations; i++) {
+            toast.setFirstLine(L"First");
+            toast.setSecondLine(L"Second");
+            toast.setThirdLine(L"Third");
+            doNotOptimize(toast);
+        }
+    });
+
+    suite.run("template/set_audio_path", [](std::uint64_t iterations) {
+        WinToastTemplate toast(Type::Text01);
+        for (std::uint64_t i = 0; i < iterations; i++) {
+            toast.setAudioPath(static_cast<WinToastTemplate::AudioSystemFile>(i % AudioSystemFileCount));
+            doNotOptimize(toast.audioPath());
+        }
+    });
+}
@@ -0,0 +1,172 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "benchmark.h"
+
+#include <list>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "timing_wheel.h"
+
+using namespace WinToastLib;
+using namespace WinToastBenchmarks;
+
+namespace {
+    constexpr std::size_t Deadlines = 1000000;
+    // Deadlines spread over about 17 minutes of 10ms ticks, like the expirations of a busy app.
+    constexpr std::uint64_t Horizon = 1u << 17;
+
+    std::vector<std::uint64_t> makeDeadlines(std::size_t count) {
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<std::uint64_t> tick(1, Horizon);
+        std::vector<std::uint64_t> deadlines(count);
+        for (std::uint64_t &deadline: deadlines) {
+            deadline = tick(random);
+        }
+        return deadlines;
+    }
+
+    // The baseline: deadlines ordered in a tree, cancelled through the iterator handed out on insert.
+    class MultimapTimers {
+    public:
+        using Handle = std::multimap<std::uint64_t, std::uint64_t>::iterator;
+
+        Handle schedule(std::uint64_t deadline, std::uint64_t key) {
+            return _timers.emplace(deadline, key);
+        }
+
+        void cancel(Handle handle) {
+            _timers.erase(handle);
+        }
+
+        void advance(std::uint64_t now, std::vector<std::uint64_t> &expired) {
+            auto it = _timers.begin();
+            for (; it != _timers.end() && it->first <= now; ++it) {
+                expired.push_back(it->second);
+            }
+            _timers.erase(_timers.begin(), it);
+        }
+
+    private:
+        std::multimap<std::uint64_t, std::uint64_t> _timers;
+    };
+
+    // What the registry did before the wheel: every live entry remembers its deadline, and once the earliest one
+    // passed an expiry pass walks all of them to drop the expired ones and find the next earliest.
+    class SweepTimers {
+    public:
+        struct Timer {
+            std::uint64_t deadline;
+            std::uint64_t key;
+        };
+
+        using Handle = std::list<Timer>::iterator;
+
+        Handle schedule(std::uint64_t deadline, std::uint64_t key) {
+            if (_next == 0 || deadline < _next) {
+                _next = deadline;
+            }
+            return _timers.insert(_timers.end(), Timer{deadline, key});
+        }
+
+        void cancel(Handle handle) {
+            _timers.erase(handle);
+        }
+
+        void advance(std::uint64_t now, std::vector<std::uint64_t> &expired) {
+            if (_next == 0 || _next > now) {
+                return;
+            }
+            _next = 0;
+            for (auto it = _timers.begin(); it != _timers.end();) {
+                if (it->deadline <= now) {
+                    expired.push_back(it->key);
+                    it = _timers.erase(it);
+                } else {
+                    if (_next == 0 || it->deadline < _next) {
+                        _next = it->deadline;
+                    }
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        std::list<Timer> _timers;
+        // The earliest deadline, 0 when nothing is pending.
+        std::uint64_t _next = 0;
+    };
+
+    // Schedules every deadline, cancels every other one like hidden toasts, then ticks through the horizon.
+    template<typename Timers>
+    void lifecycle(const std::vector<std::uint64_t> &deadlines) {
+        Timers timers;
+        std::vector<typename std::decay_t<decltype(timers.schedule(0, 0))>> handles;
+        handles.reserve(deadlines.size());
+        for (std::size_t i = 0; i < deadlines.size(); i++) {
+            handles.push_back(timers.schedule(deadlines[i], i));
+        }
+        for (std::size_t i = 0; i < handles.size(); i += 2) {
+            timers.cancel(handles[i]);
+        }
+        std::vector<std::uint64_t> expired;
+        for (std::uint64_t now = 1; now <= Horizon; now++) {
+            timers.advance(now, expired);
+            expired.clear();
+        }
+    }
+
+    // With the wheel full, the cost of one more schedule and cancel pair.
+    template<typename Timers>
+    void steadyState(Suite &suite, const std::string &name, const std::vector<std::uint64_t> &deadlines) {
+        Timers timers;
+        for (std::size_t i = 0; i < deadlines.size(); i++) {
+            timers.schedule(deadlines[i], i);
+        }
+        suite.run(name, [&](std::uint64_t iterations) {
+            for (std::uint64_t i = 0; i < iterations; i++) {
+                timers.cancel(timers.schedule(deadlines[i % deadlines.size()], i));
+            }
+        });
+    }
+}
+
+void WinToastBenchmarks::timingWheelBenchmarks(Suite &suite) {
+    const std::vector<std::uint64_t> deadlines = makeDeadlines(Deadlines);
+
+    suite.measure("timers/lifecycle_wheel/1000000", Deadlines, [&] { lifecycle<TimingWheel>(deadlines); }, 1);
+    suite.measure("timers/lifecycle_multimap/1000000", Deadlines, [&] { lifecycle<MultimapTimers>(deadlines); }, 1);
+
+    steadyState<TimingWheel>(suite, "timers/schedule_cancel_wheel/1000000_pending", deadlines);
+    steadyState<MultimapTimers>(suite, "timers/schedule_cancel_multimap/1000000_pending", deadlines);
+
+    // Every pass of the sweep walks all pending deadlines, so it is compared at sizes where it finishes in
+    // reasonable time: at 100000 a lifecycle already takes seconds.
+    for (const std::size_t count: {std::size_t{1000}, std::size_t{10000}}) {
+        const std::vector<std::uint64_t> few = makeDeadlines(count);
+        const std::string suffix = "/" + std::to_string(count);
+        suite.measure("timers/lifecycle_wheel" + suffix, count, [&] { lifecycle<TimingWheel>(few); }, 1);
+        suite.measure("timers/lifecycle_sweep" + suffix, count, [&] { lifecycle<SweepTimers>(few); }, 1);
+    }
+}
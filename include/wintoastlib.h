@@ -22,18 +22,52 @@
 #define WINTOASTLIB_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <array>
 #include <functional>
+#include <future>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#ifdef __cpp_lib_span
+#include <span>
+#endif
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define WINTOAST_HAS_COROUTINES
+#endif
 
 #define TOAST_ACTIVATED_LAUNCH_ARG "-ToastActivated"
 
+#ifdef _WIN32
 typedef signed __int64 INT64, *PINT64;
+#else
+typedef signed long long INT64, *PINT64;
+#endif
 
 namespace WinToastLib {
 
+    // Toast arguments are few, so they are kept in a vector sorted by key instead of a tree. Iteration visits
+    // them in key order. Keys must not be modified through the iterators.
     class WinToastArguments {
     public:
+        using value_type = std::pair<std::wstring, std::wstring>;
+        using container_type = std::vector<value_type>;
+        using size_type = container_type::size_type;
+        using iterator = container_type::iterator;
+        using const_iterator = container_type::const_iterator;
+
         WinToastArguments() = default;
 
         explicit WinToastArguments(const std::wstring &arguments);
@@ -42,32 +76,208 @@ namespace WinToastLib {
 
         [[nodiscard]] std::wstring toString() const;
 
-        void add(const std::wstring &key, const std::wstring &value);
+        // Appends the serialized arguments to buffer.
+        void toString(std::wstring &buffer) const;
+
+        void add(std::wstring key, std::wstring value);
 
-        bool remove(const std::wstring &key) noexcept;
+        bool remove(std::wstring_view key) noexcept;
 
-        [[nodiscard]] std::wstring get(const std::wstring &key) const;
+        [[nodiscard]] std::wstring get(std::wstring_view key) const;
 
         [[nodiscard]] bool empty() const noexcept;
 
-        [[nodiscard]] bool contains(const std::wstring &key) const;
+        [[nodiscard]] bool contains(std::wstring_view key) const noexcept;
+
+        [[nodiscard]] size_type size() const noexcept;
+
+        [[nodiscard]] iterator begin() noexcept;
+
+        [[nodiscard]] const_iterator begin() const noexcept;
+
+        [[nodiscard]] const_iterator cbegin() const noexcept;
+
+        [[nodiscard]] iterator end() noexcept;
+
+        [[nodiscard]] const_iterator end() const noexcept;
+
+        [[nodiscard]] const_iterator cend() const noexcept;
+
+        std::wstring &operator[](std::wstring_view key);
+
+    private:
+        [[nodiscard]] iterator lowerBound(std::wstring_view key) noexcept;
+
+        [[nodiscard]] const_iterator find(std::wstring_view key) const noexcept;
+
+        container_type mPairs;
+    };
+
+    // A non owning view over serialized toast arguments, like the ones an activation hands over. Nothing is
+    // parsed upfront: lookups walk the string, and values are decoded only when they contain escape sequences.
+    // The viewed string must outlive the view.
+    class WinToastArgumentsView {
+    public:
+        // A key and its value, both still encoded.
+        using Pair = std::pair<std::wstring_view, std::wstring_view>;
+
+        class iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Pair;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Pair *;
+            using reference = const Pair &;
+
+            iterator() = default;
+
+            reference operator*() const noexcept { return _pair; }
+
+            pointer operator->() const noexcept { return &_pair; }
+
+            iterator &operator++() noexcept;
+
+            iterator operator++(int) noexcept {
+                iterator previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept {
+                return lhs._position == rhs._position;
+            }
+
+            friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept {
+                return !(lhs == rhs);
+            }
+
+        private:
+            friend class WinToastArgumentsView;
+
+            iterator(std::wstring_view arguments, std::size_t position) noexcept;
+
+            std::wstring_view _arguments{};
+            std::size_t _position{std::wstring_view::npos};
+            std::size_t _next{std::wstring_view::npos};
+            Pair _pair{};
+        };
+
+        WinToastArgumentsView() = default;
+
+        explicit WinToastArgumentsView(std::wstring_view arguments) noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        [[nodiscard]] bool contains(std::wstring_view key) const noexcept;
+
+        // The still encoded value of key. When a key appears more than once the last one wins, as with parse().
+        [[nodiscard]] std::optional<std::wstring_view> find(std::wstring_view key) const noexcept;
+
+        // The decoded value of key. It views the arguments themselves when there is nothing to decode,
+        // otherwise it is decoded into buffer and views it.
+        [[nodiscard]] std::optional<std::wstring_view> get(std::wstring_view key, std::wstring &buffer) const;
+
+        [[nodiscard]] std::wstring get(std::wstring_view key) const;
+
+        // The value of key parsed as an integer, a bool ("true", "false", "1" or "0") or an enum through its
+        // underlying type. Empty if the key is missing or the value doesn't parse as a whole.
+        template<typename T>
+        [[nodiscard]] std::optional<T> get(std::wstring_view key) const noexcept;
+
+        [[nodiscard]] WinToastArguments materialize() const;
 
-        [[nodiscard]] std::map<std::wstring, std::wstring>::size_type size() const noexcept;
+        [[nodiscard]] iterator begin() const noexcept;
 
-        [[nodiscard]] std::map<std::wstring, std::wstring>::iterator begin() noexcept;
+        [[nodiscard]] iterator end() const noexcept;
 
-        [[nodiscard]] std::map<std::wstring, std::wstring>::const_iterator cbegin() const noexcept;
+    private:
+        template<typename T>
+        [[nodiscard]] static std::optional<T> parseValue(std::wstring_view text) noexcept;
+
+        [[nodiscard]] static bool parseSigned(std::wstring_view text, long long &value) noexcept;
+
+        [[nodiscard]] static bool parseUnsigned(std::wstring_view text, unsigned long long &value) noexcept;
+
+        [[nodiscard]] static std::optional<bool> parseBool(std::wstring_view text) noexcept;
+
+        std::wstring_view _arguments{};
+    };
+
+    template<typename T>
+    std::optional<T> WinToastArgumentsView::get(std::wstring_view key) const noexcept {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                      "WinToastArgumentsView::get<T> supports integers, bool and enums");
+
+        const std::optional<std::wstring_view> value = find(key);
+        if (!value) {
+            return std::nullopt;
+        }
+        return parseValue<T>(*value);
+    }
+
+    template<typename T>
+    std::optional<T> WinToastArgumentsView::parseValue(std::wstring_view text) noexcept {
+        if constexpr (std::is_enum_v<T>) {
+            const auto value = parseValue<std::underlying_type_t<T>>(text);
+            return value ? std::optional<T>(static_cast<T>(*value)) : std::nullopt;
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return parseBool(text);
+        } else if constexpr (std::is_signed_v<T>) {
+            long long value;
+            if (!parseSigned(text, value) || value < std::numeric_limits<T>::min() ||
+                value > std::numeric_limits<T>::max()) {
+                return std::nullopt;
+            }
+            return static_cast<T>(value);
+        } else {
+            unsigned long long value;
+            if (!parseUnsigned(text, value) || value > std::numeric_limits<T>::max()) {
+                return std::nullopt;
+            }
+            return static_cast<T>(value);
+        }
+    }
+
+    // A key and the value the user entered for it, laid out like NOTIFICATION_USER_INPUT_DATA.
+    struct WinToastUserInput {
+        const wchar_t *key;
+        const wchar_t *value;
+    };
+
+    // Everything a toast activation carries. It views the buffers handed over by the system, so it is only
+    // valid for the duration of the activation callback; materialize() copies what a handler needs to keep.
+    class WinToastActivation {
+    public:
+        struct Data {
+            WinToastArguments arguments;
+            std::map<std::wstring, std::wstring> userInput;
+        };
+
+        WinToastActivation(std::wstring_view arguments, const WinToastUserInput *userInput,
+                           std::size_t userInputCount) noexcept;
+
+        [[nodiscard]] const WinToastArgumentsView &arguments() const noexcept;
 
-        [[nodiscard]] std::map<std::wstring, std::wstring>::iterator end() noexcept;
+        [[nodiscard]] std::size_t userInputCount() const noexcept;
 
-        [[nodiscard]] std::map<std::wstring, std::wstring>::const_iterator cend() const noexcept;
+        [[nodiscard]] std::pair<std::wstring_view, std::wstring_view> userInputAt(std::size_t index) const noexcept;
 
-        std::wstring &operator[](const std::wstring &key);
+        // The value of the input named key. When a key appears more than once the last one wins, as with the
+        // arguments and materialize().
+        [[nodiscard]] std::optional<std::wstring_view> userInput(std::wstring_view key) const noexcept;
+
+        [[nodiscard]] Data materialize() const;
 
     private:
-        std::map<std::wstring, std::wstring> mPairs;
+        WinToastArgumentsView _arguments;
+        const WinToastUserInput *_userInput;
+        std::size_t _userInputCount;
     };
 
+    // An interned string: templates keep paths, audio URIs and action labels in a table shared by every template,
+    // so copies only bump reference counts. Defined by the implementation.
+    struct InternedEntry;
+
     class WinToastTemplate {
     public:
         enum class Scenario {
@@ -123,25 +333,73 @@ namespace WinToastLib {
         };
 
 
+        class Builder;
+
+        // The text fields of a template, in order.
+        class TextFieldsView {
+        public:
+            using const_iterator = const std::wstring *;
+
+            TextFieldsView(const std::wstring *fields, std::size_t count) noexcept
+                    : _fields(fields), _count(count) {}
+
+            [[nodiscard]] const_iterator begin() const noexcept { return _fields; }
+
+            [[nodiscard]] const_iterator end() const noexcept { return _fields + _count; }
+
+            [[nodiscard]] std::size_t size() const noexcept { return _count; }
+
+            [[nodiscard]] bool empty() const noexcept { return _count == 0; }
+
+            [[nodiscard]] const std::wstring &operator[](std::size_t pos) const noexcept { return _fields[pos]; }
+
+        private:
+            const std::wstring *_fields;
+            std::size_t _count;
+        };
+
+        static constexpr std::size_t MaxTextFields = 3;
+
+        [[nodiscard]] static constexpr std::size_t textFieldsCountOf(WinToastTemplateType type) noexcept {
+            constexpr std::size_t Counts[] = {1, 2, 2, 3, 1, 2, 2, 3};
+            return Counts[static_cast<std::size_t>(type)];
+        }
+
+        [[nodiscard]] static constexpr bool hasImageOf(WinToastTemplateType type) noexcept {
+            return type < WinToastTemplateType::Text01;
+        }
+
         explicit WinToastTemplate(WinToastTemplateType type = WinToastTemplateType::ImageAndText02);
 
+        WinToastTemplate(const WinToastTemplate &other);
+
+        // A moved from template keeps its type and settings, with empty text fields and strings and no actions,
+        // so it can be filled in and shown again.
+        WinToastTemplate(WinToastTemplate &&other) noexcept;
+
+        WinToastTemplate &operator=(const WinToastTemplate &other);
+
+        WinToastTemplate &operator=(WinToastTemplate &&other) noexcept;
+
         ~WinToastTemplate();
 
-        void setFirstLine(const std::wstring &text);
+        // Text fields take their argument by value and move it in: pass temporaries or std::move to avoid a
+        // copy. The other strings are interned, setting one that is already in use elsewhere doesn't allocate.
+        void setFirstLine(std::wstring text);
 
-        void setSecondLine(const std::wstring &text);
+        void setSecondLine(std::wstring text);
 
-        void setThirdLine(const std::wstring &text);
+        void setThirdLine(std::wstring text);
 
-        void setTextField(const std::wstring &txt, TextField pos);
+        void setTextField(std::wstring txt, TextField pos);
 
-        void setAttributionText(const std::wstring &attributionText);
+        void setAttributionText(std::wstring_view attributionText);
 
-        void setImagePath(const std::wstring &imgPath);
+        void setImagePath(std::wstring_view imgPath);
 
         void setAudioPath(WinToastTemplate::AudioSystemFile audio);
 
-        void setAudioPath(const std::wstring &audioPath);
+        void setAudioPath(std::wstring_view audioPath);
 
         void setAudioOption(WinToastTemplate::AudioOption audioOption);
 
@@ -151,7 +409,7 @@ namespace WinToastLib {
 
         void setScenario(Scenario scenario);
 
-        void addAction(const std::wstring &label);
+        void addAction(std::wstring_view label);
 
         [[nodiscard]] std::size_t textFieldsCount() const;
 
@@ -159,7 +417,12 @@ namespace WinToastLib {
 
         [[nodiscard]] bool hasImage() const;
 
-        [[nodiscard]] const std::vector<std::wstring> &textFields() const;
+        // The text fields, in order, without copying them.
+        [[nodiscard]] TextFieldsView textFieldsView() const noexcept;
+
+        // Copies the text fields into a vector, which allocates. Kept for existing callers.
+        [[deprecated("Use textFieldsView(), which doesn't copy the fields")]]
+        [[nodiscard]] std::vector<std::wstring> textFields() const;
 
         [[nodiscard]] const std::wstring &textField(TextField pos) const;
 
@@ -173,6 +436,9 @@ namespace WinToastLib {
 
         [[nodiscard]] const std::wstring &scenario() const;
 
+        // The scenario as set, for code that branches on it rather than putting its name in the payload.
+        [[nodiscard]] Scenario scenarioKind() const noexcept;
+
         [[nodiscard]] INT64 expiration() const;
 
         [[nodiscard]] WinToastTemplateType type() const;
@@ -182,16 +448,231 @@ namespace WinToastLib {
         [[nodiscard]] Duration duration() const;
 
     private:
-        std::vector<std::wstring> _textFields{};
-        std::vector<std::wstring> _actions{};
-        std::wstring _imagePath{};
-        std::wstring _audioPath{};
-        std::wstring _attributionText{};
-        std::wstring _scenario{L"Default"};
+        // Inline, so a template with text only allocates for text that doesn't fit the small string buffer. The
+        // type decides how many of the slots are in use.
+        std::array<std::wstring, MaxTextFields> _textFields{};
+        // Each entry holds one reference, null is the empty string.
+        std::vector<InternedEntry *> _actions{};
+        InternedEntry *_imagePath{nullptr};
+        InternedEntry *_audioPath{nullptr};
+        InternedEntry *_attributionText{nullptr};
         INT64 _expiration{0};
         AudioOption _audioOption{WinToastTemplate::AudioOption::Default};
         WinToastTemplateType _type{WinToastTemplateType::Text01};
         Duration _duration{Duration::System};
+        Scenario _scenario{Scenario::Default};
+
+        template<WinToastTemplateType>
+        friend class TypedToastTemplate;
+    };
+
+    // Builds a template in one expression, text fields are constructed once and moved into place:
+    //
+    //     WinToastTemplate toast = WinToastTemplate::Builder(WinToastTemplate::WinToastTemplateType::Text02)
+    //             .firstLine(L"Build finished")
+    //             .secondLine(L"All tests passed")
+    //             .action(L"Open")
+    //             .build();
+    class WinToastTemplate::Builder {
+    public:
+        explicit Builder(WinToastTemplateType type = WinToastTemplateType::ImageAndText02);
+
+        Builder &firstLine(std::wstring text);
+
+        Builder &secondLine(std::wstring text);
+
+        Builder &thirdLine(std::wstring text);
+
+        Builder &textField(std::wstring text, TextField pos);
+
+        Builder &attributionText(std::wstring_view attributionText);
+
+        Builder &imagePath(std::wstring_view imgPath);
+
+        Builder &audioPath(AudioSystemFile audio);
+
+        Builder &audioPath(std::wstring_view audioPath);
+
+        Builder &audioOption(AudioOption audioOption);
+
+        Builder &duration(Duration duration);
+
+        Builder &expiration(INT64 millisecondsFromNow);
+
+        Builder &scenario(Scenario scenario);
+
+        // Reserves room for count actions, so adding them allocates the list once.
+        Builder &reserveActions(std::size_t count);
+
+        Builder &action(std::wstring_view label);
+
+        // Moves the template out. The builder is left with an empty template of the same type, like any moved from
+        // template.
+        [[nodiscard]] WinToastTemplate build();
+
+    private:
+        WinToastTemplate _toast;
+    };
+
+    // A template whose type is known at compile time. Text fields are addressed by a compile time position, so a
+    // field the type doesn't have, or an image on a text only type, fails to compile instead of tripping an
+    // assert. It is a correctness aid, not a faster path: get() hands WinToast the plain WinToastTemplate, which
+    // is serialized like any other.
+    //
+    //     TypedToastTemplate<WinToastTemplate::WinToastTemplateType::Text02> toast;
+    //     toast.setFirstLine(L"Build finished").setSecondLine(L"All tests passed");
+    //     WinToast::showToast(toast.get());
+    template<WinToastTemplate::WinToastTemplateType Type>
+    class TypedToastTemplate {
+    public:
+        using TextField = WinToastTemplate::TextField;
+
+        static constexpr WinToastTemplate::WinToastTemplateType type = Type;
+        static constexpr std::size_t textFieldsCount = WinToastTemplate::textFieldsCountOf(Type);
+        static constexpr bool hasImage = WinToastTemplate::hasImageOf(Type);
+
+        TypedToastTemplate() : _toast(Type) {}
+
+        template<TextField Field>
+        TypedToastTemplate &setTextField(std::wstring text) {
+            static_assert(static_cast<std::size_t>(Field) < textFieldsCount,
+                          "The template type doesn't have this text field");
+            _toast._textFields[static_cast<std::size_t>(Field)] = std::move(text);
+            return *this;
+        }
+
+        TypedToastTemplate &setFirstLine(std::wstring text) {
+            return setTextField<TextField::FirstLine>(std::move(text));
+        }
+
+        TypedToastTemplate &setSecondLine(std::wstring text) {
+            return setTextField<TextField::SecondLine>(std::move(text));
+        }
+
+        TypedToastTemplate &setThirdLine(std::wstring text) {
+            return setTextField<TextField::ThirdLine>(std::move(text));
+        }
+
+        template<TextField Field>
+        [[nodiscard]] const std::wstring &textField() const noexcept {
+            static_assert(static_cast<std::size_t>(Field) < textFieldsCount,
+                          "The template type doesn't have this text field");
+            return _toast._textFields[static_cast<std::size_t>(Field)];
+        }
+
+        // Only the ImageAndText types have an image. The member is only instantiated when called, so the check
+        // fires at the call.
+        TypedToastTemplate &setImagePath(std::wstring_view imgPath) {
+            static_assert(hasImage, "Only the ImageAndText template types show an image");
+            _toast.setImagePath(imgPath);
+            return *this;
+        }
+
+        TypedToastTemplate &setAttributionText(std::wstring_view attributionText) {
+            _toast.setAttributionText(attributionText);
+            return *this;
+        }
+
+        TypedToastTemplate &setAudioPath(WinToastTemplate::AudioSystemFile audio) {
+            _toast.setAudioPath(audio);
+            return *this;
+        }
+
+        TypedToastTemplate &setAudioPath(std::wstring_view audioPath) {
+            _toast.setAudioPath(audioPath);
+            return *this;
+        }
+
+        TypedToastTemplate &setAudioOption(WinToastTemplate::AudioOption audioOption) {
+            _toast.setAudioOption(audioOption);
+            return *this;
+        }
+
+        TypedToastTemplate &setDuration(WinToastTemplate::Duration duration) {
+            _toast.setDuration(duration);
+            return *this;
+        }
+
+        TypedToastTemplate &setExpiration(INT64 millisecondsFromNow) {
+            _toast.setExpiration(millisecondsFromNow);
+            return *this;
+        }
+
+        TypedToastTemplate &setScenario(WinToastTemplate::Scenario scenario) {
+            _toast.setScenario(scenario);
+            return *this;
+        }
+
+        TypedToastTemplate &addAction(std::wstring_view label) {
+            _toast.addAction(label);
+            return *this;
+        }
+
+        [[nodiscard]] const WinToastTemplate &get() const & noexcept {
+            return _toast;
+        }
+
+        // Moves the template out, for instance to hand it to WinToast::showToastAsync() without a copy.
+        [[nodiscard]] WinToastTemplate get() && noexcept {
+            return std::move(_toast);
+        }
+
+    private:
+        WinToastTemplate _toast;
+    };
+
+    // The pending result of an asynchronous WinToast call. Copies share the same result.
+    //
+    // Continuations, including coroutines awaiting the result, run on the WinToast submission thread, or right
+    // away on the calling thread if the result is already there. The submission thread runs one request at a
+    // time, so a continuation must not block on another pending result: calling get() there, or anything else
+    // waiting for a later request, deadlocks.
+    //
+    // The implementation defines the members for the results WinToast hands out, WinToast::ShowResult and bool.
+    // Only future() and the awaiter members are defined here, the awaiters build in C++20 code whatever standard
+    // WinToast was built with.
+    template<typename T>
+    class WinToastAsync {
+    public:
+        // The shared result, defined by the implementation.
+        class State;
+
+        explicit WinToastAsync(std::shared_ptr<State> state) noexcept;
+
+        [[nodiscard]] bool ready() const;
+
+        // Blocks until the result is there.
+        T get() const;
+
+        void then(std::function<void(const T &)> continuation) const;
+
+        // A std::future fallback for code that neither awaits nor subscribes continuations.
+        [[nodiscard]] std::future<T> future() const {
+            auto promise = std::make_shared<std::promise<T>>();
+            std::future<T> future = promise->get_future();
+            then([promise](const T &value) { promise->set_value(value); });
+            return future;
+        }
+
+#ifdef WINTOAST_HAS_COROUTINES
+        [[nodiscard]] bool await_ready() const {
+            return ready();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) const {
+            return subscribe([handle](const T &) { handle.resume(); });
+        }
+
+        T await_resume() const {
+            return get();
+        }
+#endif
+
+    private:
+        // Returns false, without keeping the continuation, if the result is already there.
+        bool subscribe(std::function<void(const T &)> continuation) const;
+
+        std::shared_ptr<State> _state;
     };
 
     namespace WinToast {
@@ -205,7 +686,8 @@ namespace WinToastLib {
             InvalidParameters,
             InvalidHandler,
             NotDisplayed,
-            UnknownError
+            UnknownError,
+            DeadlineExpired
         };
 
         enum class ShortcutResult {
@@ -228,6 +710,122 @@ namespace WinToastLib {
             SHORTCUT_POLICY_REQUIRE_CREATE = 2,
         };
 
+        // Counters of the asynchronous activation dispatch, see setActivationDispatch().
+        struct ActivationDispatchStats {
+            std::uint64_t dispatched;
+            std::uint64_t handled;
+            std::uint64_t overflows;
+            // Time between an activation being queued and its handler starting to run.
+            std::uint64_t totalLatencyNs;
+            std::uint64_t maxLatencyNs;
+        };
+
+        // The outcome of one toast of a batch, id is -1 when error isn't NoError.
+        struct ShowResult {
+            INT64 id;
+            WinToastError error;
+        };
+
+        // The stages of showToast() timed when the library is built with WINTOAST_ENABLE_STATS. Total covers the
+        // whole call, Deduplicate and Serialize are WinToast's own work, Notifier, Construct and Show are the
+        // calls into the notification platform and Register is the bookkeeping of the live toast.
+        enum class Stage {
+            Total,
+            Deduplicate,
+            Serialize,
+            Notifier,
+            Construct,
+            Register,
+            Show
+        };
+
+        inline constexpr std::size_t StageCount = 7;
+
+        struct LatencyHistogram {
+            // Bucket i counts the samples that took less than 2^i ns, and at least 2^(i-1) ns.
+            std::array<std::uint64_t, 64> buckets;
+            std::uint64_t count;
+            std::uint64_t totalNs;
+
+            // The upper bound of the bucket holding the p-th percentile, p between 0 and 1.
+            [[nodiscard]] std::uint64_t percentileNs(double p) const noexcept {
+                if (count == 0) {
+                    return 0;
+                }
+                const auto rank = static_cast<std::uint64_t>(p * static_cast<double>(count - 1)) + 1;
+                std::uint64_t seen = 0;
+                for (std::size_t i = 0; i < buckets.size(); i++) {
+                    seen += buckets[i];
+                    if (seen >= rank) {
+                        return i == 63 ? UINT64_MAX : std::uint64_t{1} << i;
+                    }
+                }
+                return UINT64_MAX;
+            }
+        };
+
+        struct Stats {
+            std::array<LatencyHistogram, StageCount> stages;
+
+            [[nodiscard]] const LatencyHistogram &operator[](Stage stage) const noexcept {
+                return stages[static_cast<std::size_t>(stage)];
+            }
+        };
+
+        enum class TraceLevel {
+            Debug,
+            Info,
+            Warning,
+            Error,
+            Off
+        };
+
+        // Bit flags, combine them to choose what setTraceFilter() lets through.
+        enum class TraceCategory : std::uint32_t {
+            // Initialization, the shortcut and the registration of the app.
+            Setup = 1u << 0,
+            // Showing and hiding toasts.
+            Toast = 1u << 1,
+            Schedule = 1u << 2,
+            Activation = 1u << 3,
+            // Failed calls into the Windows Runtime.
+            Platform = 1u << 4
+        };
+
+        inline constexpr std::uint32_t AllTraceCategories = 0x1F;
+
+        struct TraceRecord {
+            TraceLevel level;
+            TraceCategory category;
+            std::chrono::system_clock::time_point time;
+            // Identifies the thread that traced the record, the same for every record of one thread.
+            std::uint64_t thread;
+            std::wstring message;
+        };
+
+        // Metrics of the queue behind showToastAsync() and hideToastAsync(). Wait times run from submission until
+        // the request is taken off the queue.
+        struct SubmissionStats {
+            std::size_t queueDepth;
+            std::size_t maxQueueDepth;
+            // Requests queued so far, counted as they are queued, including the ones dropped later.
+            std::uint64_t submitted;
+            // Toasts whose deadline passed while they were queued.
+            std::uint64_t dropped;
+            std::uint64_t totalWaitNs;
+            std::uint64_t maxWaitNs;
+        };
+
+        // Gauges of the toasts WinToast keeps track of so they can be hidden later, see setLiveToastLimit().
+        struct LiveToastStats {
+            std::size_t resident;
+            std::size_t approximateBytes;
+            // Forgotten because their expiration passed.
+            std::uint64_t expired;
+            // Forgotten to stay under the limit.
+            std::uint64_t evicted;
+        };
+
         [[nodiscard]] bool isCompatible();
 
         [[nodiscard]] bool isSupportingModernFeatures();
@@ -250,8 +848,63 @@ namespace WinToastLib {
         INT64
         showToast(const WinToastTemplate &toast, WinToastError *error = nullptr);
 
+        // Shows several toasts at once: the payloads are built in parallel, then the toasts are shown in order.
+        // The results line up with the toasts.
+        std::vector<ShowResult> showToasts(const WinToastTemplate *toasts, std::size_t count);
+
+        std::vector<ShowResult> showToasts(const std::vector<WinToastTemplate> &toasts);
+
+        // Opt-in duplicate suppression: a toast identical to one shown less than window ago isn't shown again,
+        // showToast() returns the id of the toast already shown instead. Toasts are identical when their type,
+        // text fields, actions, image, audio, attribution, scenario and duration are. Only toasts still on screen
+        // count: once one is hidden, cleared, dismissed, failed or expired, its next duplicate is shown. A window
+        // of zero, the default, turns it off.
+        void setDeduplicationWindow(std::chrono::milliseconds window);
+
+        // How many toasts were suppressed as duplicates so far.
+        [[nodiscard]] std::uint64_t suppressedDuplicates();
+
+        // Asynchronous showToast() and hideToast(). The calls are queued to a dedicated submission thread and run
+        // there in order, so the calling thread never waits on the notification platform.
+        // The toast is moved to the submission thread, pass a temporary or std::move it to avoid a copy.
+        [[nodiscard]] WinToastAsync<ShowResult> showToastAsync(WinToastTemplate toast);
+
+        // A toast still queued when deadline passes isn't shown, it completes with WinToastError::DeadlineExpired.
+        [[nodiscard]] WinToastAsync<ShowResult> showToastAsync(WinToastTemplate toast,
+                                                               std::chrono::steady_clock::time_point deadline);
+
+        [[nodiscard]] WinToastAsync<bool> hideToastAsync(INT64 id);
+
+        // Off by default, the queue behind the asynchronous calls runs in submission order. When enabled hides
+        // run first, then toasts by the priority of their scenario: IncomingCall, Alarm, Reminder and
+        // everything else, earliest deadline first within the same scenario priority.
+        void setSubmissionPriorities(bool enabled);
+
+        [[nodiscard]] SubmissionStats submissionStats();
+
+        // Latency histograms of the showToast() stages, all empty unless built with WINTOAST_ENABLE_STATS.
+        [[nodiscard]] Stats stats();
+
+#ifdef __cpp_lib_span
+        inline std::vector<ShowResult> showToasts(std::span<const WinToastTemplate> toasts) {
+            return showToasts(toasts.data(), toasts.size());
+        }
+#endif
+
         void clear();
 
+        // Hands the toast to Windows to be shown at deliveryTime, even if the app isn't running by then. Its
+        // expiration counts from deliveryTime. Returns the id to cancel it with, which is unrelated to the ids of
+        // shown toasts, or -1 on failure.
+        INT64 scheduleToast(const WinToastTemplate &toast, std::chrono::system_clock::time_point deliveryTime,
+                            WinToastError *error = nullptr);
+
+        bool cancelScheduled(INT64 id);
+
+        // Cancels every toast scheduled by this process that is due in [from, to), returns how many.
+        std::size_t cancelScheduled(std::chrono::system_clock::time_point from,
+                                    std::chrono::system_clock::time_point to);
+
         ShortcutResult createShortcut();
 
         [[nodiscard]] const std::wstring &appName();
@@ -272,9 +925,48 @@ namespace WinToastLib {
 
         void setShortcutPolicy(ShortcutPolicy policy);
 
+        void setOnActivated(const std::function<void(const WinToastActivation &)> &callback);
+
+        // Handlers of this form get a copy of the activation, see WinToastActivation::materialize().
         void setOnActivated(
                 const std::function<void(const WinToastArguments &,
                                          const std::map<std::wstring, std::wstring> &)> &callback);
+
+        // By default the activation handler runs on the COM thread delivering the activation. With workers > 0
+        // activations are copied into bounded queues and handled by that many worker threads instead, so a slow
+        // handler doesn't hold up the COM server. Activations carrying the same arguments are handled in the
+        // order they arrived. Activations arriving while the queue of their worker is full are dropped and
+        // counted as overflows. Passing 0 goes back to synchronous handling. The previous workers finish what
+        // they have queued in the background, so this can be called from a handler and doesn't block.
+        void setActivationDispatch(std::size_t workers, std::size_t queueCapacity = 1024);
+
+        [[nodiscard]] ActivationDispatchStats activationDispatchStats();
+
+        // WinToast remembers shown toasts so hideToast() and clear() can reach them. A toast is forgotten once
+        // it is hidden, dismissed, activated, fails or expires, and the oldest toasts are forgotten when more than
+        // limit are remembered. Forgotten toasts stay in the action center but can't be hidden by id anymore.
+        // The default limit is 1024.
+        void setLiveToastLimit(std::size_t limit);
+
+        [[nodiscard]] LiveToastStats liveToastStats();
+
+        // Diagnostics are queued by the thread tracing them and handed to the sink on a background thread, in
+        // order for each thread. Debug builds start with a sink writing to std::wcout and std::wcerr, release
+        // builds without one. Passing an empty sink turns tracing off.
+        // The sink always runs on that background thread and without any WinToast lock held, so it may call
+        // setTraceSink(), setTraceFilter() and flushTrace(). A new sink takes over from the next batch of records.
+        void setTraceSink(std::function<void(const TraceRecord &)> sink);
+
+        // Records below level or outside categories aren't even formatted. Debug builds start at Debug, release
+        // builds at Warning.
+        void setTraceFilter(TraceLevel level, std::uint32_t categories = AllTraceCategories);
+
+        // Blocks until every record traced by the calling thread so far reached the sink. Called from the sink
+        // itself it returns right away.
+        void flushTrace();
+
+        // Records lost because the queue of their thread was full when they were traced.
+        [[nodiscard]] std::uint64_t droppedTraceRecords();
     }
 }
 
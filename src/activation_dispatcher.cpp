@@ -0,0 +1,231 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "activation_dispatcher.h"
+
+#include <deque>
+
+using namespace WinToastLib;
+
+namespace {
+    // The thread shutting down retired dispatchers. It is a function local static created by the first
+    // retirement, so it is destroyed, and joined after finishing the retirements still queued, before the
+    // statics that were around when the dispatchers were set up, such as the activation handler they call.
+    class Retirement {
+    public:
+        static Retirement &instance() {
+            static Retirement retirement;
+            return retirement;
+        }
+
+        ~Retirement() {
+            {
+                std::lock_guard lock(_mutex);
+                _stopping = true;
+            }
+            _wakeUp.notify_one();
+            _thread.join();
+        }
+
+        void add(std::shared_ptr<ActivationDispatcher> dispatcher) {
+            {
+                std::lock_guard lock(_mutex);
+                _retired.push_back(std::move(dispatcher));
+            }
+            _wakeUp.notify_one();
+        }
+
+    private:
+        Retirement() : _thread(&Retirement::run, this) {}
+
+        void run() {
+            std::unique_lock lock(_mutex);
+            for (;;) {
+                _wakeUp.wait(lock, [this] { return _stopping || !_retired.empty(); });
+                if (_retired.empty()) {
+                    return;
+                }
+                std::shared_ptr<ActivationDispatcher> dispatcher = std::move(_retired.front());
+                _retired.pop_front();
+
+                lock.unlock();
+                // Whoever still holds a reference is left with a dispatcher that refuses activations and has
+                // no threads to join.
+                dispatcher->shutdown();
+                dispatcher.reset();
+                lock.lock();
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::deque<std::shared_ptr<ActivationDispatcher>> _retired;
+        bool _stopping = false;
+        std::thread _thread;
+    };
+}
+
+ActivationDispatcher::ActivationDispatcher(std::size_t workers, std::size_t queueCapacity, Handler handler)
+        : _handler(std::move(handler)) {
+    _workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; i++) {
+        _workers.push_back(std::make_unique<Worker>(queueCapacity));
+    }
+    for (auto &worker: _workers) {
+        worker->thread = std::thread(&ActivationDispatcher::run, this, std::ref(*worker));
+    }
+}
+
+ActivationDispatcher::~ActivationDispatcher() {
+    shutdown();
+}
+
+void ActivationDispatcher::shutdown() {
+    {
+        std::unique_lock lock(_inFlightMutex);
+        _closed = true;
+        _idle.wait(lock, [this] { return _inFlight == 0; });
+    }
+
+    _stopping.store(true);
+    for (auto &worker: _workers) {
+        {
+            std::lock_guard lock(worker->mutex);
+        }
+        worker->wakeUp.notify_one();
+    }
+    for (auto &worker: _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool ActivationDispatcher::dispatch(std::wstring_view arguments, const WinToastUserInput *userInput,
+                                    std::size_t userInputCount) {
+    {
+        std::lock_guard lock(_inFlightMutex);
+        if (_closed) {
+            return false;
+        }
+        _inFlight++;
+    }
+    // Released however enqueue() leaves, so shutdown() never waits for a call that threw.
+    struct InFlight {
+        ActivationDispatcher &dispatcher;
+
+        ~InFlight() {
+            std::lock_guard lock(dispatcher._inFlightMutex);
+            if (--dispatcher._inFlight == 0) {
+                dispatcher._idle.notify_all();
+            }
+        }
+    } inFlight{*this};
+
+    return enqueue(arguments, userInput, userInputCount);
+}
+
+bool ActivationDispatcher::enqueue(std::wstring_view arguments, const WinToastUserInput *userInput,
+                                   std::size_t userInputCount) {
+    const WinToastActivation activation(arguments, userInput, userInputCount);
+    Event event{std::wstring(arguments), {}, std::chrono::steady_clock::now()};
+    event.userInput.reserve(activation.userInputCount());
+    for (std::size_t i = 0; i < activation.userInputCount(); i++) {
+        const auto [key, value] = activation.userInputAt(i);
+        event.userInput.emplace_back(key, value);
+    }
+
+    Worker &worker = *_workers[std::hash<std::wstring_view>{}(arguments) % _workers.size()];
+    if (!worker.queue.push(std::move(event))) {
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    _dispatched.fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the fence in run(): either the worker sees the event before going to sleep, or we see it asleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker.sleeping.load(std::memory_order_relaxed)) {
+        {
+            std::lock_guard lock(worker.mutex);
+        }
+        worker.wakeUp.notify_one();
+    }
+    return true;
+}
+
+void ActivationDispatcher::run(Worker &worker) {
+    Event event;
+
+    for (;;) {
+        if (worker.queue.pop(event)) {
+            handle(event);
+            continue;
+        }
+
+        std::unique_lock lock(worker.mutex);
+        worker.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        worker.wakeUp.wait(lock, [&] {
+            return !worker.queue.empty() || _stopping.load();
+        });
+        worker.sleeping.store(false, std::memory_order_relaxed);
+
+        if (worker.queue.empty() && _stopping.load()) {
+            return;
+        }
+    }
+}
+
+void ActivationDispatcher::handle(Event &event) {
+    const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - event.queuedAt).count();
+    const auto latencyNs = static_cast<std::uint64_t>(latency);
+    _totalLatencyNs.fetch_add(latencyNs, std::memory_order_relaxed);
+    std::uint64_t maxLatencyNs = _maxLatencyNs.load(std::memory_order_relaxed);
+    while (latencyNs > maxLatencyNs &&
+           !_maxLatencyNs.compare_exchange_weak(maxLatencyNs, latencyNs, std::memory_order_relaxed)) {
+    }
+
+    // The views handed to the handler point into the copies held by the event.
+    std::vector<WinToastUserInput> userInput;
+    userInput.reserve(event.userInput.size());
+    for (const auto &[key, value]: event.userInput) {
+        userInput.push_back({key.c_str(), value.c_str()});
+    }
+
+    _handler(WinToastActivation(event.arguments, userInput.data(), userInput.size()));
+    _handled.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ActivationDispatcher::retire(std::shared_ptr<ActivationDispatcher> dispatcher) {
+    if (dispatcher) {
+        Retirement::instance().add(std::move(dispatcher));
+    }
+}
+
+WinToast::ActivationDispatchStats ActivationDispatcher::stats() const noexcept {
+    return {
+            _dispatched.load(std::memory_order_relaxed),
+            _handled.load(std::memory_order_relaxed),
+            _overflows.load(std::memory_order_relaxed),
+            _totalLatencyNs.load(std::memory_order_relaxed),
+            _maxLatencyNs.load(std::memory_order_relaxed),
+    };
+}
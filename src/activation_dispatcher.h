@@ -0,0 +1,110 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_ACTIVATION_DISPATCHER_H
+#define WINTOAST_ACTIVATION_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "wintoastlib.h"
+#include "bounded_queue.h"
+
+namespace WinToastLib {
+
+    // Runs activation handlers on a pool of worker threads. Each worker consumes its own bounded lock free queue
+    // and activations are routed to a worker by a hash of their arguments, so activations carrying the same
+    // arguments are handled in order. The handler runs on the worker threads and must not throw.
+    class ActivationDispatcher {
+    public:
+        using Handler = std::function<void(const WinToastActivation &)>;
+
+        ActivationDispatcher(std::size_t workers, std::size_t queueCapacity, Handler handler);
+
+        ~ActivationDispatcher();
+
+        ActivationDispatcher(const ActivationDispatcher &) = delete;
+
+        ActivationDispatcher &operator=(const ActivationDispatcher &) = delete;
+
+        // Copies the activation into the queue of its worker. Returns false if that queue is full or the
+        // dispatcher was shut down.
+        bool dispatch(std::wstring_view arguments, const WinToastUserInput *userInput, std::size_t userInputCount);
+
+        // Refuses new activations, waits for the dispatch calls in flight to return, then lets the workers drain
+        // their queues and joins them. Must not be called from a worker. The destructor calls it.
+        void shutdown();
+
+        [[nodiscard]] WinToast::ActivationDispatchStats stats() const noexcept;
+
+        // Shuts down a dispatcher that was swapped out on the retirement thread, which is joined at exit. Shutting
+        // it down in place would block the caller while the queues drain, and throws when the caller is one of its
+        // own workers, for instance a handler replacing the dispatcher.
+        static void retire(std::shared_ptr<ActivationDispatcher> dispatcher);
+
+    private:
+        struct Event {
+            std::wstring arguments;
+            std::vector<std::pair<std::wstring, std::wstring>> userInput;
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+
+        struct Worker {
+            explicit Worker(std::size_t queueCapacity) : queue(queueCapacity) {}
+
+            BoundedQueue<Event> queue;
+            std::mutex mutex;
+            std::condition_variable wakeUp;
+            std::atomic<bool> sleeping{false};
+            std::thread thread;
+        };
+
+        bool enqueue(std::wstring_view arguments, const WinToastUserInput *userInput, std::size_t userInputCount);
+
+        void run(Worker &worker);
+
+        void handle(Event &event);
+
+        Handler _handler;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::atomic<bool> _stopping{false};
+
+        std::mutex _inFlightMutex;
+        std::condition_variable _idle;
+        std::size_t _inFlight = 0;
+        bool _closed = false;
+
+        std::atomic<std::uint64_t> _dispatched{0};
+        std::atomic<std::uint64_t> _handled{0};
+        std::atomic<std::uint64_t> _overflows{0};
+        std::atomic<std::uint64_t> _totalLatencyNs{0};
+        std::atomic<std::uint64_t> _maxLatencyNs{0};
+    };
+}
+
+#endif //WINTOAST_ACTIVATION_DISPATCHER_H
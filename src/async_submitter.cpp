@@ -0,0 +1,161 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "async_submitter.h"
+#include "win_toast_async.h"
+
+#include <algorithm>
+#include <exception>
+
+using namespace WinToastLib;
+
+AsyncSubmitter::AsyncSubmitter(Target target) : _target(std::move(target)) {
+}
+
+AsyncSubmitter::~AsyncSubmitter() {
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _wakeUp.notify_one();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void AsyncSubmitter::setPrioritized(bool prioritized) noexcept {
+    _prioritized.store(prioritized, std::memory_order_relaxed);
+}
+
+WinToastAsync<WinToast::ShowResult> AsyncSubmitter::show(WinToastTemplate toast,
+                                                         std::optional<Clock::time_point> deadline) {
+    auto state = std::make_shared<WinToastAsync<WinToast::ShowResult>::State>();
+    const int priority = priorityOf(toast);
+    post(priority, deadline, [this, state, toast = std::move(toast)] {
+        WinToast::ShowResult result{-1, WinToast::WinToastError::NoError};
+        try {
+            result.id = _target.show(toast, &result.error);
+        } catch (const std::exception &) {
+            result = {-1, WinToast::WinToastError::UnknownError};
+        }
+        state->complete(result);
+    }, [state] {
+        state->complete({-1, WinToast::WinToastError::DeadlineExpired});
+    });
+    return WinToastAsync<WinToast::ShowResult>(std::move(state));
+}
+
+WinToastAsync<bool> AsyncSubmitter::hide(INT64 id) {
+    auto state = std::make_shared<WinToastAsync<bool>::State>();
+    post(HidePriority, std::nullopt, [this, state, id] {
+        bool hidden = false;
+        try {
+            hidden = _target.hide(id);
+        } catch (const std::exception &) {
+        }
+        state->complete(hidden);
+    }, nullptr);
+    return WinToastAsync<bool>(std::move(state));
+}
+
+WinToast::SubmissionStats AsyncSubmitter::stats() const {
+    std::lock_guard lock(_mutex);
+    return {_requests.size(), _maxQueueDepth, _submitted, _dropped, _totalWaitNs, _maxWaitNs};
+}
+
+int AsyncSubmitter::priorityOf(const WinToastTemplate &toast) noexcept {
+    switch (toast.scenarioKind()) {
+        case WinToastTemplate::Scenario::IncomingCall:
+            return 3;
+        case WinToastTemplate::Scenario::Alarm:
+            return 2;
+        case WinToastTemplate::Scenario::Reminder:
+            return 1;
+        case WinToastTemplate::Scenario::Default:
+            break;
+    }
+    return 0;
+}
+
+bool AsyncSubmitter::runsAfter(const Request &a, const Request &b) noexcept {
+    if (a.priority != b.priority) {
+        return a.priority < b.priority;
+    }
+    if (a.due != b.due) {
+        return a.due > b.due;
+    }
+    return a.sequence > b.sequence;
+}
+
+void AsyncSubmitter::post(int priority, std::optional<Clock::time_point> deadline, std::function<void()> run,
+                          std::function<void()> drop) {
+    const bool prioritized = _prioritized.load(std::memory_order_relaxed);
+    {
+        std::lock_guard lock(_mutex);
+        _requests.push_back(Request{
+                prioritized ? priority : 0,
+                prioritized && deadline ? *deadline : Clock::time_point::max(),
+                _sequence++,
+                deadline,
+                Clock::now(),
+                std::move(run),
+                std::move(drop)
+        });
+        std::push_heap(_requests.begin(), _requests.end(), runsAfter);
+        _submitted++;
+        _maxQueueDepth = std::max(_maxQueueDepth, _requests.size());
+        if (!_thread.joinable()) {
+            _thread = std::thread(&AsyncSubmitter::run, this);
+        }
+    }
+    _wakeUp.notify_one();
+}
+
+void AsyncSubmitter::run() {
+    std::unique_lock lock(_mutex);
+    for (;;) {
+        _wakeUp.wait(lock, [this] { return _stopping || !_requests.empty(); });
+        if (_requests.empty()) {
+            return;
+        }
+
+        std::pop_heap(_requests.begin(), _requests.end(), runsAfter);
+        Request request = std::move(_requests.back());
+        _requests.pop_back();
+
+        const Clock::time_point now = Clock::now();
+        const auto waitNs = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - request.queuedAt).count());
+        _totalWaitNs += waitNs;
+        _maxWaitNs = std::max(_maxWaitNs, waitNs);
+        const bool expired = request.deadline && *request.deadline < now;
+        if (expired) {
+            _dropped++;
+        }
+
+        lock.unlock();
+        if (expired) {
+            request.drop();
+        } else {
+            request.run();
+        }
+        lock.lock();
+    }
+}
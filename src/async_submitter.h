@@ -0,0 +1,114 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_ASYNC_SUBMITTER_H
+#define WINTOAST_ASYNC_SUBMITTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // Runs show and hide requests on a dedicated thread. The thread starts with the first request. What a request
+    // actually does is up to the target, WinToastImpl plugs in its synchronous showToast() and hideToast().
+    //
+    // Requests run in the order they were submitted unless priorities are enabled: then hides go first, shows are
+    // ordered by the priority class of their scenario (IncomingCall, Alarm, Reminder, everything else) and within
+    // a class by deadline. A show whose deadline passed while it was queued is dropped either way.
+    //
+    // Results are completed on the submitter thread, which is where the continuations waiting for them run.
+    class AsyncSubmitter {
+    public:
+        struct Target {
+            std::function<INT64(const WinToastTemplate &toast, WinToast::WinToastError *error)> show;
+            std::function<bool(INT64 id)> hide;
+        };
+
+        using Clock = std::chrono::steady_clock;
+
+        explicit AsyncSubmitter(Target target);
+
+        // Runs the requests still queued, then stops the thread.
+        ~AsyncSubmitter();
+
+        AsyncSubmitter(const AsyncSubmitter &) = delete;
+
+        AsyncSubmitter &operator=(const AsyncSubmitter &) = delete;
+
+        void setPrioritized(bool prioritized) noexcept;
+
+        WinToastAsync<WinToast::ShowResult> show(WinToastTemplate toast, std::optional<Clock::time_point> deadline = {});
+
+        WinToastAsync<bool> hide(INT64 id);
+
+        [[nodiscard]] WinToast::SubmissionStats stats() const;
+
+        // Higher runs first.
+        static int priorityOf(const WinToastTemplate &toast) noexcept;
+
+    private:
+        static constexpr int HidePriority = 4;
+
+        struct Request {
+            int priority;
+            // The deadline when priorities are enabled, the ordering falls back to the sequence otherwise.
+            Clock::time_point due;
+            std::uint64_t sequence;
+            std::optional<Clock::time_point> deadline;
+            Clock::time_point queuedAt;
+            std::function<void()> run;
+            std::function<void()> drop;
+        };
+
+        // Heap order, true when a runs after b.
+        static bool runsAfter(const Request &a, const Request &b) noexcept;
+
+        void post(int priority, std::optional<Clock::time_point> deadline, std::function<void()> run,
+                  std::function<void()> drop);
+
+        void run();
+
+        Target _target;
+        std::atomic<bool> _prioritized{false};
+        mutable std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::vector<Request> _requests;
+        std::uint64_t _sequence = 0;
+        bool _stopping = false;
+        std::thread _thread;
+
+        std::size_t _maxQueueDepth = 0;
+        std::uint64_t _submitted = 0;
+        std::uint64_t _dropped = 0;
+        std::uint64_t _totalWaitNs = 0;
+        std::uint64_t _maxWaitNs = 0;
+    };
+}
+
+#endif //WINTOAST_ASYNC_SUBMITTER_H
@@ -0,0 +1,122 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_BOUNDED_QUEUE_H
+#define WINTOAST_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace WinToastLib {
+
+    // A bounded lock free queue for many producers and a single consumer, after Dmitry Vyukov's bounded MPMC
+    // queue: every cell carries a sequence number telling producers and the consumer whose turn it is.
+    // The capacity is rounded up to a power of two.
+    template<typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(std::size_t capacity) {
+            std::size_t size = 2;
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            _cells = std::make_unique<Cell[]>(size);
+            _mask = size - 1;
+            for (std::size_t i = 0; i < size; i++) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // Returns false, leaving value untouched, when the queue is full.
+        bool push(T &&value) {
+            std::size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+            Cell *cell;
+
+            for (;;) {
+                cell = &_cells[position & _mask];
+                const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0) {
+                    if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = _enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+
+            cell->value = std::move(value);
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Must only be called from the consumer thread.
+        bool pop(T &value) {
+            const std::size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+            Cell &cell = _cells[position & _mask];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+            if (static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1) < 0) {
+                return false;
+            }
+
+            value = std::move(cell.value);
+            cell.value = T();
+            cell.sequence.store(position + _mask + 1, std::memory_order_release);
+            _dequeuePosition.store(position + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Must only be called from the consumer thread.
+        [[nodiscard]] bool empty() const {
+            const std::size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+            const std::size_t sequence = _cells[position & _mask].sequence.load(std::memory_order_acquire);
+            return static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1) < 0;
+        }
+
+        [[nodiscard]] std::size_t capacity() const noexcept {
+            return _mask + 1;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> _cells;
+        std::size_t _mask{0};
+        alignas(64) std::atomic<std::size_t> _enqueuePosition{0};
+        alignas(64) std::atomic<std::size_t> _dequeuePosition{0};
+    };
+}
+
+#endif //WINTOAST_BOUNDED_QUEUE_H
@@ -0,0 +1,89 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "expiry_scheduler.h"
+
+using namespace WinToastLib;
+
+ExpiryScheduler::ExpiryScheduler(Callback onExpired, Clock::duration tick)
+        : _onExpired(std::move(onExpired)), _tick(tick), _origin(Clock::now()) {
+}
+
+ExpiryScheduler::~ExpiryScheduler() {
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _wakeUp.notify_one();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+TimingWheel::Handle ExpiryScheduler::schedule(Clock::time_point deadline, std::uint64_t key) {
+    // Rounded up so a deadline never fires early.
+    const std::uint64_t tick = elapsedTicks(deadline + _tick - Clock::duration(1));
+
+    std::lock_guard lock(_mutex);
+    const TimingWheel::Handle handle = _wheel.schedule(tick, key);
+    if (!_thread.joinable()) {
+        _thread = std::thread(&ExpiryScheduler::run, this);
+    } else if (tick < _wakeTick) {
+        _wakeUp.notify_one();
+    }
+    return handle;
+}
+
+bool ExpiryScheduler::cancel(TimingWheel::Handle handle) {
+    std::lock_guard lock(_mutex);
+    return _wheel.cancel(handle);
+}
+
+std::size_t ExpiryScheduler::pending() const {
+    std::lock_guard lock(_mutex);
+    return _wheel.size();
+}
+
+void ExpiryScheduler::run() {
+    std::vector<std::uint64_t> expired;
+    std::unique_lock lock(_mutex);
+    while (!_stopping) {
+        _wheel.advance(elapsedTicks(Clock::now()), expired);
+        if (!expired.empty()) {
+            lock.unlock();
+            _onExpired(expired);
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+
+        if (const std::optional<std::uint64_t> next = _wheel.nextTick()) {
+            _wakeTick = *next;
+            _wakeUp.wait_until(lock, _origin + _tick * static_cast<Clock::rep>(*next));
+        } else {
+            _wakeTick = UINT64_MAX;
+            _wakeUp.wait(lock);
+        }
+    }
+}
+
+std::uint64_t ExpiryScheduler::elapsedTicks(Clock::time_point time) const {
+    return time <= _origin ? 0 : static_cast<std::uint64_t>((time - _origin) / _tick);
+}
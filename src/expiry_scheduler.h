@@ -0,0 +1,76 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_EXPIRY_SCHEDULER_H
+#define WINTOAST_EXPIRY_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "timing_wheel.h"
+
+namespace WinToastLib {
+
+    // Drives a TimingWheel from a background thread, reporting the keys of expired deadlines in batches.
+    // The thread starts with the first deadline and sleeps until the next tick the wheel has work at.
+    class ExpiryScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Callback = std::function<void(const std::vector<std::uint64_t> &keys)>;
+
+        // onExpired runs on the scheduler thread without any scheduler lock held, it may schedule and cancel.
+        explicit ExpiryScheduler(Callback onExpired, Clock::duration tick = std::chrono::milliseconds(10));
+
+        ~ExpiryScheduler();
+
+        ExpiryScheduler(const ExpiryScheduler &) = delete;
+
+        ExpiryScheduler &operator=(const ExpiryScheduler &) = delete;
+
+        TimingWheel::Handle schedule(Clock::time_point deadline, std::uint64_t key);
+
+        bool cancel(TimingWheel::Handle handle);
+
+        [[nodiscard]] std::size_t pending() const;
+
+    private:
+        void run();
+
+        [[nodiscard]] std::uint64_t elapsedTicks(Clock::time_point time) const;
+
+        Callback _onExpired;
+        const Clock::duration _tick;
+        const Clock::time_point _origin;
+        mutable std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        TimingWheel _wheel;
+        // The tick the scheduler thread sleeps until, earlier deadlines have to wake it up.
+        std::uint64_t _wakeTick = UINT64_MAX;
+        bool _stopping = false;
+        std::thread _thread;
+    };
+}
+
+#endif //WINTOAST_EXPIRY_SCHEDULER_H
@@ -0,0 +1,45 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_FILE_TIME_H
+#define WINTOAST_FILE_TIME_H
+
+#include <chrono>
+#include <ratio>
+
+#include "wintoastlib.h"
+
+// FILETIME values, 100ns ticks since 1601-01-01, computed from std::chrono so they are available everywhere.
+namespace WinToastLib::FileTime {
+
+    using Ticks = std::chrono::duration<INT64, std::ratio<1, 10000000>>;
+
+    inline constexpr INT64 UnixEpoch = 116444736000000000LL;
+
+    inline INT64 from(std::chrono::system_clock::time_point time) noexcept {
+        return UnixEpoch + std::chrono::duration_cast<Ticks>(time.time_since_epoch()).count();
+    }
+
+    inline INT64 now() noexcept {
+        return from(std::chrono::system_clock::now());
+    }
+}
+
+#endif //WINTOAST_FILE_TIME_H
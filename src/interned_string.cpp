@@ -0,0 +1,151 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "interned_string.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+using namespace WinToastLib;
+
+struct WinToastLib::InternedEntry {
+    explicit InternedEntry(std::wstring_view text) : text(text) {}
+
+    std::wstring text;
+    // Only drops to zero with the lock of the shard held, so a lookup never hands out an entry being deleted.
+    std::atomic<std::uint32_t> references{1};
+};
+
+namespace {
+    // The table is sharded by hash so templates built on different threads rarely wait on each other.
+    constexpr std::size_t ShardCount = 16;
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        // Keys view the text of their entry.
+        std::unordered_map<std::wstring_view, InternedString::Entry *> entries;
+    };
+
+    // The table and the empty string are never destroyed: templates held by other statics release their strings
+    // during static destruction, possibly after these would have been torn down.
+    Shard &shardOf(std::wstring_view text) {
+        static Shard *shards = new Shard[ShardCount];
+        return shards[std::hash<std::wstring_view>()(text) % ShardCount];
+    }
+
+    const std::wstring &emptyString() noexcept {
+        static const std::wstring *empty = new std::wstring();
+        return *empty;
+    }
+}
+
+InternedString::InternedString(std::wstring_view text) {
+    if (text.empty()) {
+        return;
+    }
+
+    Shard &shard = shardOf(text);
+    std::lock_guard lock(shard.mutex);
+    const auto it = shard.entries.find(text);
+    if (it != shard.entries.end()) {
+        _entry = it->second;
+        _entry->references.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto entry = std::make_unique<Entry>(text);
+    shard.entries.emplace(entry->text, entry.get());
+    _entry = entry.release();
+}
+
+InternedString::InternedString(const InternedString &other) noexcept: _entry(other._entry) {
+    retain(_entry);
+}
+
+InternedString::InternedString(InternedString &&other) noexcept: _entry(other._entry) {
+    other._entry = nullptr;
+}
+
+InternedString &InternedString::operator=(const InternedString &other) noexcept {
+    if (_entry != other._entry) {
+        InternedString copy(other);
+        std::swap(_entry, copy._entry);
+    }
+    return *this;
+}
+
+InternedString &InternedString::operator=(InternedString &&other) noexcept {
+    if (this != &other) {
+        release(_entry);
+        _entry = other._entry;
+        other._entry = nullptr;
+    }
+    return *this;
+}
+
+InternedString::~InternedString() {
+    release(_entry);
+}
+
+const std::wstring &InternedString::str() const noexcept {
+    return str(_entry);
+}
+
+bool InternedString::empty() const noexcept {
+    return _entry == nullptr;
+}
+
+InternedString::Entry *InternedString::detach() noexcept {
+    return std::exchange(_entry, nullptr);
+}
+
+void InternedString::retain(Entry *entry) noexcept {
+    if (entry != nullptr) {
+        entry->references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+const std::wstring &InternedString::str(const Entry *entry) noexcept {
+    return entry != nullptr ? entry->text : emptyString();
+}
+
+void InternedString::release(Entry *entry) noexcept {
+    if (entry == nullptr) {
+        return;
+    }
+
+    // Dropping a reference that isn't the last one needs no lock.
+    std::uint32_t references = entry->references.load(std::memory_order_relaxed);
+    while (references > 1) {
+        if (entry->references.compare_exchange_weak(references, references - 1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    Shard &shard = shardOf(entry->text);
+    std::lock_guard lock(shard.mutex);
+    if (entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        shard.entries.erase(entry->text);
+        delete entry;
+    }
+}
@@ -0,0 +1,81 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_INTERNED_STRING_H
+#define WINTOAST_INTERNED_STRING_H
+
+#include <string>
+#include <string_view>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // An immutable string shared by every holder of the same content. Paths, audio URIs and action labels repeat
+    // across toasts, so templates keep them interned: copying a template only bumps reference counts, and setting
+    // a string that is already interned doesn't allocate.
+    class InternedString {
+    public:
+        using Entry = InternedEntry;
+
+        InternedString() noexcept = default;
+
+        explicit InternedString(std::wstring_view text);
+
+        InternedString(const InternedString &other) noexcept;
+
+        InternedString(InternedString &&other) noexcept;
+
+        InternedString &operator=(const InternedString &other) noexcept;
+
+        InternedString &operator=(InternedString &&other) noexcept;
+
+        ~InternedString();
+
+        [[nodiscard]] const std::wstring &str() const noexcept;
+
+        [[nodiscard]] bool empty() const noexcept;
+
+        // Interned strings are equal exactly when they are the same entry.
+        friend bool operator==(const InternedString &lhs, const InternedString &rhs) noexcept {
+            return lhs._entry == rhs._entry;
+        }
+
+        friend bool operator!=(const InternedString &lhs, const InternedString &rhs) noexcept {
+            return lhs._entry != rhs._entry;
+        }
+
+        // WinToastTemplate can't see this class from the public header, so it holds bare entries instead, each
+        // owning one reference. detach() hands the reference of this string over to such a holder, the static
+        // functions manage the references it holds. A null entry is the empty string.
+        [[nodiscard]] Entry *detach() noexcept;
+
+        static void retain(Entry *entry) noexcept;
+
+        static void release(Entry *entry) noexcept;
+
+        [[nodiscard]] static const std::wstring &str(const Entry *entry) noexcept;
+
+    private:
+        Entry *_entry{nullptr};
+    };
+}
+
+#endif //WINTOAST_INTERNED_STRING_H
@@ -0,0 +1,113 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "loopback_backend.h"
+#include "pipeline_stats.h"
+
+using namespace WinToastLib;
+
+void LoopbackBackend::setAppUserModelId(const std::wstring &aumi) {
+    std::lock_guard lock(_mutex);
+    _aumi = aumi;
+}
+
+INT64 LoopbackBackend::show(const std::wstring &xml, INT64 expiration, WinToast::WinToastError &error) {
+    const std::size_t bytes = sizeof(Record) + xml.size() * sizeof(wchar_t);
+    INT64 id;
+    {
+        WINTOAST_TIME_STAGE(WinToast::Stage::Register);
+        id = _live.insert(Record{xml, expiration}, expiration, bytes);
+    }
+    if (id < 0) {
+        error = WinToast::WinToastError::UnknownError;
+        return -1;
+    }
+    _shown.fetch_add(1, std::memory_order_relaxed);
+    error = WinToast::WinToastError::NoError;
+    return id;
+}
+
+bool LoopbackBackend::hide(INT64 id) {
+    if (!_live.erase(id)) {
+        return false;
+    }
+    _hidden.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool LoopbackBackend::isLive(INT64 id) const {
+    return _live.contains(id);
+}
+
+INT64 LoopbackBackend::schedule(const std::wstring &xml, INT64 deliveryTime, INT64 expiration,
+                                WinToast::WinToastError &error) {
+    error = WinToast::WinToastError::NoError;
+    return _scheduled.insert(deliveryTime, Record{xml, expiration}, FileTime::now());
+}
+
+bool LoopbackBackend::cancelScheduled(INT64 id) {
+    return _scheduled.take(id, FileTime::now()).has_value();
+}
+
+std::size_t LoopbackBackend::cancelScheduled(INT64 from, INT64 to) {
+    return _scheduled.takeRange(from, to, FileTime::now()).size();
+}
+
+void LoopbackBackend::clear() {
+    _hidden.fetch_add(_live.drain().size(), std::memory_order_relaxed);
+}
+
+void LoopbackBackend::uninstall() {
+    _scheduled.drain();
+    clear();
+}
+
+void LoopbackBackend::setLiveToastLimit(std::size_t limit) {
+    _live.setLimit(limit);
+}
+
+WinToast::LiveToastStats LoopbackBackend::liveToastStats() const {
+    return _live.stats();
+}
+
+std::wstring LoopbackBackend::appUserModelId() const {
+    std::lock_guard lock(_mutex);
+    return _aumi;
+}
+
+std::optional<LoopbackBackend::Record> LoopbackBackend::find(INT64 id) const {
+    return _live.find(id);
+}
+
+std::size_t LoopbackBackend::liveCount() const {
+    return _live.size();
+}
+
+std::size_t LoopbackBackend::scheduledCount() const {
+    return _scheduled.size();
+}
+
+std::uint64_t LoopbackBackend::shownCount() const noexcept {
+    return _shown.load(std::memory_order_relaxed);
+}
+
+std::uint64_t LoopbackBackend::hiddenCount() const noexcept {
+    return _hidden.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_LOOPBACK_BACKEND_H
+#define WINTOAST_LOOPBACK_BACKEND_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "toast_backend.h"
+#include "toast_registry.h"
+#include "schedule_index.h"
+
+namespace WinToastLib {
+
+    // A backend that never leaves the process: every toast is acknowledged and kept in memory until it is
+    // hidden or cleared. Scheduled toasts are kept until cancelled or due, they are never shown. Used to run
+    // the ToastPipeline where the Windows notification platform isn't available, like in the tests and the
+    // benchmarks.
+    class LoopbackBackend : public ToastBackend {
+    public:
+        struct Record {
+            std::wstring xml;
+            INT64 expiration;
+        };
+
+        void setAppUserModelId(const std::wstring &aumi) override;
+
+        INT64 show(const std::wstring &xml, INT64 expiration, WinToast::WinToastError &error) override;
+
+        bool hide(INT64 id) override;
+
+        [[nodiscard]] bool isLive(INT64 id) const override;
+
+        INT64 schedule(const std::wstring &xml, INT64 deliveryTime, INT64 expiration,
+                       WinToast::WinToastError &error) override;
+
+        bool cancelScheduled(INT64 id) override;
+
+        std::size_t cancelScheduled(INT64 from, INT64 to) override;
+
+        void clear() override;
+
+        void uninstall() override;
+
+        void setLiveToastLimit(std::size_t limit) override;
+
+        [[nodiscard]] WinToast::LiveToastStats liveToastStats() const override;
+
+        [[nodiscard]] std::wstring appUserModelId() const;
+
+        [[nodiscard]] std::optional<Record> find(INT64 id) const;
+
+        [[nodiscard]] std::size_t liveCount() const;
+
+        [[nodiscard]] std::size_t scheduledCount() const;
+
+        [[nodiscard]] std::uint64_t shownCount() const noexcept;
+
+        [[nodiscard]] std::uint64_t hiddenCount() const noexcept;
+
+    private:
+        mutable std::mutex _mutex;
+        std::wstring _aumi;
+        ToastRegistry<Record> _live;
+        ScheduleIndex<Record> _scheduled;
+        std::atomic<std::uint64_t> _shown{0};
+        std::atomic<std::uint64_t> _hidden{0};
+    };
+}
+
+#endif //WINTOAST_LOOPBACK_BACKEND_H
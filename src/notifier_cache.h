@@ -0,0 +1,81 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_NOTIFIER_CACHE_H
+#define WINTOAST_NOTIFIER_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace WinToastLib {
+
+    // Keeps the notifier of the current AUMI around so it is created once instead of on every call.
+    // Asking for a different AUMI, or calling invalidate(), drops the cached notifier.
+    template<typename Notifier>
+    class NotifierCache {
+    public:
+        using Factory = std::function<Notifier(const std::wstring &aumi)>;
+
+        explicit NotifierCache(Factory factory) : _factory(std::move(factory)) {}
+
+        Notifier get(const std::wstring &aumi) {
+            std::lock_guard lock(_mutex);
+            if (_notifier && _aumi == aumi) {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                return *_notifier;
+            }
+
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            _notifier.reset();
+            _notifier.emplace(_factory(aumi));
+            _aumi = aumi;
+            return *_notifier;
+        }
+
+        void invalidate() {
+            std::lock_guard lock(_mutex);
+            _notifier.reset();
+            _aumi.clear();
+        }
+
+        [[nodiscard]] std::uint64_t hits() const noexcept {
+            return _hits.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::uint64_t misses() const noexcept {
+            return _misses.load(std::memory_order_relaxed);
+        }
+
+    private:
+        Factory _factory;
+        std::mutex _mutex;
+        std::wstring _aumi;
+        std::optional<Notifier> _notifier;
+        std::atomic<std::uint64_t> _hits{0};
+        std::atomic<std::uint64_t> _misses{0};
+    };
+}
+
+#endif //WINTOAST_NOTIFIER_CACHE_H
@@ -0,0 +1,292 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "percent_codec.h"
+#include "simd_support.h"
+
+using namespace WinToastLib;
+
+namespace {
+    constexpr std::size_t EscapeLength = 3;
+
+    inline bool isReserved(wchar_t c) noexcept {
+        switch (c) {
+            case L'%':
+            case L';':
+            case L'=':
+            case L'"':
+            case L'\'':
+            case L'<':
+            case L'>':
+            case L'&':
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline const wchar_t *escapeOf(wchar_t c) noexcept {
+        switch (c) {
+            case L'%':
+                return L"%25";
+            case L';':
+                return L"%3B";
+            case L'=':
+                return L"%3D";
+            case L'"':
+                return L"%22";
+            case L'\'':
+                return L"%27";
+            case L'<':
+                return L"%3C";
+            case L'>':
+                return L"%3E";
+            default:
+                return L"%26";
+        }
+    }
+
+    // Returns the character encoded by the escape sequence starting at it, or 0 if it isn't one of ours.
+    inline wchar_t unescape(const wchar_t *it, const wchar_t *last) noexcept {
+        if (last - it < static_cast<std::ptrdiff_t>(EscapeLength)) {
+            return 0;
+        }
+
+        if (it[1] == L'2') {
+            switch (it[2]) {
+                case L'5':
+                    return L'%';
+                case L'2':
+                    return L'"';
+                case L'7':
+                    return L'\'';
+                case L'6':
+                    return L'&';
+                default:
+                    return 0;
+            }
+        }
+
+        if (it[1] == L'3') {
+            switch (it[2]) {
+                case L'B':
+                    return L';';
+                case L'D':
+                    return L'=';
+                case L'C':
+                    return L'<';
+                case L'E':
+                    return L'>';
+                default:
+                    return 0;
+            }
+        }
+
+        return 0;
+    }
+
+    // Returns the position of the first reserved character in [first, last), or last.
+    const wchar_t *findReserved(const wchar_t *first, const wchar_t *last) noexcept {
+        const wchar_t *it = first;
+
+#if defined(WINTOAST_AVX2) || defined(WINTOAST_SSE2)
+        constexpr wchar_t Reserved[] = {L'%', L';', L'=', L'"', L'\'', L'<', L'>', L'&'};
+
+#if defined(WINTOAST_AVX2)
+        constexpr std::ptrdiff_t Lanes = 32 / sizeof(wchar_t);
+        const auto splat = [](wchar_t c) {
+            if constexpr (sizeof(wchar_t) == 2) {
+                return _mm256_set1_epi16(static_cast<short>(c));
+            } else {
+                return _mm256_set1_epi32(static_cast<int>(c));
+            }
+        };
+        const auto equal = [](__m256i a, __m256i b) {
+            if constexpr (sizeof(wchar_t) == 2) {
+                return _mm256_cmpeq_epi16(a, b);
+            } else {
+                return _mm256_cmpeq_epi32(a, b);
+            }
+        };
+
+        __m256i sets[std::size(Reserved)];
+        for (std::size_t i = 0; i < std::size(Reserved); i++) {
+            sets[i] = splat(Reserved[i]);
+        }
+
+        for (; last - it >= Lanes; it += Lanes) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(it));
+            __m256i found = equal(v, sets[0]);
+            for (std::size_t i = 1; i < std::size(Reserved); i++) {
+                found = _mm256_or_si256(found, equal(v, sets[i]));
+            }
+
+            const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(found));
+            if (mask) {
+                return it + Simd::firstSetBit(mask) / sizeof(wchar_t);
+            }
+        }
+#else
+        constexpr std::ptrdiff_t Lanes = 16 / sizeof(wchar_t);
+        const auto splat = [](wchar_t c) {
+            if constexpr (sizeof(wchar_t) == 2) {
+                return _mm_set1_epi16(static_cast<short>(c));
+            } else {
+                return _mm_set1_epi32(static_cast<int>(c));
+            }
+        };
+        const auto equal = [](__m128i a, __m128i b) {
+            if constexpr (sizeof(wchar_t) == 2) {
+                return _mm_cmpeq_epi16(a, b);
+            } else {
+                return _mm_cmpeq_epi32(a, b);
+            }
+        };
+
+        __m128i sets[std::size(Reserved)];
+        for (std::size_t i = 0; i < std::size(Reserved); i++) {
+            sets[i] = splat(Reserved[i]);
+        }
+
+        for (; last - it >= Lanes; it += Lanes) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+            __m128i found = equal(v, sets[0]);
+            for (std::size_t i = 1; i < std::size(Reserved); i++) {
+                found = _mm_or_si128(found, equal(v, sets[i]));
+            }
+
+            const auto mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+            if (mask) {
+                return it + Simd::firstSetBit(mask) / sizeof(wchar_t);
+            }
+        }
+#endif
+#endif
+
+        while (it != last && !isReserved(*it)) {
+            ++it;
+        }
+        return it;
+    }
+}
+
+std::size_t PercentCodec::encodedSize(std::wstring_view value) noexcept {
+    const wchar_t *it = value.data();
+    const wchar_t *last = it + value.size();
+    std::size_t size = value.size();
+
+    while ((it = findReserved(it, last)) != last) {
+        size += EscapeLength - 1;
+        ++it;
+    }
+    return size;
+}
+
+void PercentCodec::appendEncoded(std::wstring &buffer, std::wstring_view value) {
+    const wchar_t *it = value.data();
+    const wchar_t *last = it + value.size();
+
+    while (it != last) {
+        const wchar_t *reserved = findReserved(it, last);
+        buffer.append(it, reserved);
+        if (reserved == last) {
+            break;
+        }
+        buffer.append(escapeOf(*reserved), EscapeLength);
+        it = reserved + 1;
+    }
+}
+
+std::wstring PercentCodec::encode(std::wstring_view value) {
+    std::wstring encoded;
+    encoded.reserve(encodedSize(value));
+    appendEncoded(encoded, value);
+    return encoded;
+}
+
+std::size_t PercentCodec::decodedSize(std::wstring_view value) noexcept {
+    const wchar_t *first = value.data();
+    const wchar_t *last = first + value.size();
+    std::size_t size = value.size();
+
+    for (std::size_t pos = value.find(L'%'); pos != std::wstring_view::npos; pos = value.find(L'%', pos + 1)) {
+        if (unescape(first + pos, last)) {
+            size -= EscapeLength - 1;
+            pos += EscapeLength - 1;
+        }
+    }
+    return size;
+}
+
+void PercentCodec::appendDecoded(std::wstring &buffer, std::wstring_view value) {
+    const wchar_t *first = value.data();
+    const wchar_t *last = first + value.size();
+    std::size_t copied = 0;
+
+    for (std::size_t pos = value.find(L'%'); pos != std::wstring_view::npos; pos = value.find(L'%', pos + 1)) {
+        const wchar_t decoded = unescape(first + pos, last);
+        if (decoded) {
+            buffer.append(first + copied, pos - copied);
+            buffer += decoded;
+            pos += EscapeLength - 1;
+            copied = pos + 1;
+        }
+    }
+    buffer.append(first + copied, value.size() - copied);
+}
+
+std::wstring PercentCodec::decode(std::wstring_view value) {
+    std::wstring decoded;
+    decoded.reserve(decodedSize(value));
+    appendDecoded(decoded, value);
+    return decoded;
+}
+
+bool PercentCodec::needsDecoding(std::wstring_view value) noexcept {
+    return value.find(L'%') != std::wstring_view::npos;
+}
+
+bool PercentCodec::equalsDecoded(std::wstring_view encoded, std::wstring_view decoded) noexcept {
+    if (!needsDecoding(encoded)) {
+        return encoded == decoded;
+    }
+
+    const wchar_t *it = encoded.data();
+    const wchar_t *last = it + encoded.size();
+    std::size_t matched = 0;
+
+    while (it != last) {
+        wchar_t c = *it;
+        if (c == L'%') {
+            const wchar_t unescaped = unescape(it, last);
+            if (unescaped) {
+                c = unescaped;
+                it += EscapeLength - 1;
+            }
+        }
+
+        if (matched == decoded.size() || decoded[matched] != c) {
+            return false;
+        }
+        ++matched;
+        ++it;
+    }
+    return matched == decoded.size();
+}
@@ -0,0 +1,51 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_PERCENT_CODEC_H
+#define WINTOAST_PERCENT_CODEC_H
+
+#include <string>
+#include <string_view>
+
+namespace WinToastLib::PercentCodec {
+
+    // The encoding used for the keys and values of toast arguments: '%', ';', '=', '"', '\'', '<', '>' and '&'
+    // are written as %XX with uppercase hex digits, and only those eight sequences are decoded back.
+
+    [[nodiscard]] std::size_t encodedSize(std::wstring_view value) noexcept;
+
+    void appendEncoded(std::wstring &buffer, std::wstring_view value);
+
+    [[nodiscard]] std::wstring encode(std::wstring_view value);
+
+    [[nodiscard]] std::size_t decodedSize(std::wstring_view value) noexcept;
+
+    void appendDecoded(std::wstring &buffer, std::wstring_view value);
+
+    [[nodiscard]] std::wstring decode(std::wstring_view value);
+
+    // Whether decoding value could change it at all.
+    [[nodiscard]] bool needsDecoding(std::wstring_view value) noexcept;
+
+    // Compares the decoded form of encoded with decoded, without decoding into a new string.
+    [[nodiscard]] bool equalsDecoded(std::wstring_view encoded, std::wstring_view decoded) noexcept;
+}
+
+#endif //WINTOAST_PERCENT_CODEC_H
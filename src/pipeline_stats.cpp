@@ -0,0 +1,125 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pipeline_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace WinToastLib;
+
+namespace {
+    constexpr std::size_t BucketCount = 64;
+
+    struct ThreadCounters {
+        // Only the owning thread writes, other threads only read them for snapshots.
+        std::atomic<std::uint64_t> buckets[WinToast::StageCount][BucketCount]{};
+        std::atomic<std::uint64_t> totalNs[WinToast::StageCount]{};
+    };
+
+    // Counters of the running threads, plus what the finished ones recorded.
+    struct Registry {
+        std::mutex mutex;
+        std::vector<const ThreadCounters *> threads;
+        WinToast::Stats finished{};
+    };
+
+    Registry &registry() {
+        static Registry registry;
+        return registry;
+    }
+
+    void addTo(WinToast::Stats &stats, const ThreadCounters &counters) {
+        for (std::size_t stage = 0; stage < WinToast::StageCount; stage++) {
+            WinToast::LatencyHistogram &histogram = stats.stages[stage];
+            for (std::size_t bucket = 0; bucket < BucketCount; bucket++) {
+                const std::uint64_t count = counters.buckets[stage][bucket].load(std::memory_order_relaxed);
+                histogram.buckets[bucket] += count;
+                histogram.count += count;
+            }
+            histogram.totalNs += counters.totalNs[stage].load(std::memory_order_relaxed);
+        }
+    }
+
+    class ThreadSlot {
+    public:
+        ThreadSlot() {
+            Registry &shared = registry();
+            std::lock_guard lock(shared.mutex);
+            shared.threads.push_back(&counters);
+        }
+
+        ~ThreadSlot() {
+            Registry &shared = registry();
+            std::lock_guard lock(shared.mutex);
+            addTo(shared.finished, counters);
+            shared.threads.erase(std::find(shared.threads.begin(), shared.threads.end(), &counters));
+        }
+
+        ThreadCounters counters;
+    };
+
+    // The counters of the calling thread, registered on first use. Null if registering failed, for instance
+    // because the registry couldn't grow: a later call tries again.
+    ThreadCounters *threadCounters() noexcept {
+        try {
+            thread_local ThreadSlot slot;
+            return &slot.counters;
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    inline void bump(std::atomic<std::uint64_t> &counter, std::uint64_t value) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    inline std::size_t bucketOf(std::uint64_t ns) noexcept {
+        std::size_t width = 0;
+        while (ns != 0 && width < BucketCount - 1) {
+            ns >>= 1;
+            width++;
+        }
+        return width;
+    }
+}
+
+void PipelineStats::record(WinToast::Stage stage, std::uint64_t ns) noexcept {
+    // Stats must never fail a toast, without counters the sample is dropped.
+    ThreadCounters *counters = threadCounters();
+    if (counters == nullptr) {
+        return;
+    }
+    const auto index = static_cast<std::size_t>(stage);
+    bump(counters->buckets[index][bucketOf(ns)], 1);
+    bump(counters->totalNs[index], ns);
+}
+
+WinToast::Stats PipelineStats::snapshot() {
+    Registry &shared = registry();
+    std::lock_guard lock(shared.mutex);
+    WinToast::Stats stats = shared.finished;
+    for (const ThreadCounters *counters: shared.threads) {
+        addTo(stats, *counters);
+    }
+    return stats;
+}
@@ -0,0 +1,72 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_PIPELINE_STATS_H
+#define WINTOAST_PIPELINE_STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+#include "wintoastlib.h"
+
+// Latency histograms of the showToast() stages. Every thread records into its own counters, so recording is a
+// couple of relaxed loads and stores; snapshot() sums the counters of all threads. Timing is compiled out unless
+// WINTOAST_ENABLE_STATS is defined.
+namespace WinToastLib::PipelineStats {
+
+    // Drops the sample if the counters of the calling thread can't be set up.
+    void record(WinToast::Stage stage, std::uint64_t ns) noexcept;
+
+    [[nodiscard]] WinToast::Stats snapshot();
+
+    // Records the time from construction to destruction.
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(WinToast::Stage stage) noexcept
+                : _stage(stage), _start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedTimer() {
+            const auto elapsed = std::chrono::steady_clock::now() - _start;
+            record(_stage, static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        WinToast::Stage _stage;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define WINTOAST_STATS_CONCAT_(a, b) a##b
+#define WINTOAST_STATS_CONCAT(a, b) WINTOAST_STATS_CONCAT_(a, b)
+
+#ifdef WINTOAST_ENABLE_STATS
+// Times the rest of the enclosing scope as the given stage.
+#define WINTOAST_TIME_STAGE(stage) \
+    const ::WinToastLib::PipelineStats::ScopedTimer WINTOAST_STATS_CONCAT(_stageTimer, __LINE__)(stage)
+#else
+#define WINTOAST_TIME_STAGE(stage) ((void) 0)
+#endif
+
+#endif //WINTOAST_PIPELINE_STATS_H
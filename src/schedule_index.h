@@ -0,0 +1,134 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_SCHEDULE_INDEX_H
+#define WINTOAST_SCHEDULE_INDEX_H
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // The toasts a backend handed to the OS schedule, indexed by id and by due time so a single toast or a whole
+    // time range can be cancelled without enumerating the OS schedule. Due times are FILETIME values. Entries
+    // whose due time passed are forgotten on the next change, the OS has shown them by then.
+    template<typename Value>
+    class ScheduleIndex {
+    public:
+        struct Entry {
+            INT64 id;
+            INT64 due;
+            Value value;
+        };
+
+        // Returns the id the toast can be cancelled with, ids start at 1.
+        INT64 insert(INT64 due, Value value, INT64 now) {
+            std::lock_guard lock(_mutex);
+            forgetDue(now);
+            const INT64 id = _nextId++;
+            _byId.emplace(id, Entry{id, due, std::move(value)});
+            _byDue.emplace(due, id);
+            return id;
+        }
+
+        // Removes the entry and hands it to the caller, so whoever takes it is the only one cancelling it.
+        std::optional<Entry> take(INT64 id, INT64 now) {
+            std::lock_guard lock(_mutex);
+            forgetDue(now);
+            const auto iter = _byId.find(id);
+            if (iter == _byId.end()) {
+                return std::nullopt;
+            }
+            std::optional<Entry> entry(std::move(iter->second));
+            _byDue.erase({entry->due, id});
+            _byId.erase(iter);
+            return entry;
+        }
+
+        // Removes every entry due in [from, to). An empty or reversed range takes nothing.
+        std::vector<Entry> takeRange(INT64 from, INT64 to, INT64 now) {
+            std::lock_guard lock(_mutex);
+            forgetDue(now);
+            std::vector<Entry> entries;
+            if (from >= to) {
+                return entries;
+            }
+            const auto first = _byDue.lower_bound({from, 0});
+            const auto last = _byDue.lower_bound({to, 0});
+            for (auto iter = first; iter != last; ++iter) {
+                const auto entry = _byId.find(iter->second);
+                entries.push_back(std::move(entry->second));
+                _byId.erase(entry);
+            }
+            _byDue.erase(first, last);
+            return entries;
+        }
+
+        // Puts a taken entry back under its id, for when cancelling it with the OS failed.
+        void restore(Entry entry) {
+            std::lock_guard lock(_mutex);
+            const INT64 id = entry.id;
+            const INT64 due = entry.due;
+            if (_byId.emplace(id, std::move(entry)).second) {
+                _byDue.emplace(due, id);
+            }
+        }
+
+        std::vector<Value> drain() {
+            std::lock_guard lock(_mutex);
+            std::vector<Value> values;
+            values.reserve(_byId.size());
+            for (auto &entry: _byId) {
+                values.push_back(std::move(entry.second.value));
+            }
+            _byId.clear();
+            _byDue.clear();
+            return values;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            std::lock_guard lock(_mutex);
+            return _byId.size();
+        }
+
+    private:
+        void forgetDue(INT64 now) {
+            auto iter = _byDue.begin();
+            for (; iter != _byDue.end() && iter->first <= now; ++iter) {
+                _byId.erase(iter->second);
+            }
+            _byDue.erase(_byDue.begin(), iter);
+        }
+
+        mutable std::mutex _mutex;
+        INT64 _nextId = 1;
+        std::unordered_map<INT64, Entry> _byId;
+        std::set<std::pair<INT64, INT64>> _byDue;
+    };
+}
+
+#endif //WINTOAST_SCHEDULE_INDEX_H
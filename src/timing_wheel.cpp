@@ -0,0 +1,241 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "timing_wheel.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace WinToastLib;
+
+namespace {
+    // Index of the lowest set bit of a non zero mask.
+    inline unsigned lowestSetBit(std::uint64_t mask) noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(mask))) {
+            return static_cast<unsigned>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+        return static_cast<unsigned>(index) + 32;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+    }
+}
+
+TimingWheel::TimingWheel(std::uint64_t now) : _current(now + 1) {
+    _buckets.fill(NoNode);
+}
+
+TimingWheel::Handle TimingWheel::schedule(std::uint64_t deadline, std::uint64_t key) {
+    std::uint32_t index;
+    if (_freeNodes != NoNode) {
+        index = _freeNodes;
+        _freeNodes = _nodes[index].next;
+    } else {
+        index = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.push_back(Node{0, 0, NoNode, NoNode, 1, NoBucket});
+    }
+
+    Node &node = _nodes[index];
+    node.deadline = std::max(deadline, _current);
+    node.key = key;
+    place(index);
+    _size++;
+    return (static_cast<Handle>(node.generation) << 32) | index;
+}
+
+bool TimingWheel::cancel(Handle handle) {
+    const auto index = static_cast<std::uint32_t>(handle);
+    if (index >= _nodes.size()) {
+        return false;
+    }
+    const Node &node = _nodes[index];
+    if (node.bucket == NoBucket || node.generation != static_cast<std::uint32_t>(handle >> 32)) {
+        return false;
+    }
+
+    unlink(index);
+    release(index);
+    _size--;
+    return true;
+}
+
+void TimingWheel::advance(std::uint64_t now, std::vector<std::uint64_t> &expired) {
+    while (_current <= now) {
+        // Jump straight to the next occupied bucket of this rotation, or to the next tick with buckets to cascade.
+        const auto slot = static_cast<unsigned>(_current & Mask);
+        const std::uint64_t pending = _occupied[0] >> slot;
+        if (pending == 0) {
+            const std::optional<std::uint64_t> next = nextTick();
+            moveTo(next ? std::min(*next, now + 1) : now + 1);
+            continue;
+        }
+
+        const std::uint64_t tick = _current + lowestSetBit(pending);
+        if (tick > now) {
+            moveTo(now + 1);
+            break;
+        }
+
+        std::uint32_t index = detach(static_cast<std::uint16_t>(tick & Mask));
+        while (index != NoNode) {
+            const std::uint32_t next = _nodes[index].next;
+            expired.push_back(_nodes[index].key);
+            release(index);
+            _size--;
+            index = next;
+        }
+        moveTo(tick + 1);
+    }
+}
+
+std::optional<std::uint64_t> TimingWheel::nextTick() const noexcept {
+    if (_size == 0) {
+        return std::nullopt;
+    }
+
+    const auto slot = static_cast<unsigned>(_current & Mask);
+    if (const std::uint64_t pending = _occupied[0] >> slot) {
+        return _current + lowestSetBit(pending);
+    }
+
+    // Upper level buckets past the current one hold timers that cascade once the wheel reaches their first tick.
+    for (unsigned level = 1; level < Levels; level++) {
+        const unsigned shift = Bits * level;
+        const auto current = static_cast<unsigned>((_current >> shift) & Mask);
+        if (current == Mask) {
+            continue;
+        }
+        if (const std::uint64_t pending = _occupied[level] >> (current + 1)) {
+            const std::uint64_t slotStart = current + 1 + lowestSetBit(pending);
+            return ((_current >> (shift + Bits)) << (shift + Bits)) | (slotStart << shift);
+        }
+    }
+
+    // Only timers beyond the range of the wheel are left, they are placed again once the top level wraps.
+    constexpr unsigned rangeBits = Bits * Levels;
+    return ((_current >> rangeBits) + 1) << rangeBits;
+}
+
+std::size_t TimingWheel::size() const noexcept {
+    return _size;
+}
+
+void TimingWheel::place(std::uint32_t index) {
+    const std::uint64_t deadline = _nodes[index].deadline;
+    for (unsigned level = 0; level < Levels; level++) {
+        const unsigned shift = Bits * level;
+        if ((deadline >> (shift + Bits)) == (_current >> (shift + Bits))) {
+            link(index, static_cast<std::uint16_t>(level * Slots + ((deadline >> shift) & Mask)));
+            return;
+        }
+    }
+
+    link(index, OverflowBucket);
+}
+
+void TimingWheel::link(std::uint32_t index, std::uint16_t bucket) {
+    Node &node = _nodes[index];
+    node.bucket = bucket;
+    node.prev = NoNode;
+    node.next = _buckets[bucket];
+    if (node.next != NoNode) {
+        _nodes[node.next].prev = index;
+    }
+    _buckets[bucket] = index;
+    _occupied[bucket / Slots] |= std::uint64_t{1} << (bucket % Slots);
+}
+
+void TimingWheel::unlink(std::uint32_t index) {
+    const Node &node = _nodes[index];
+    if (node.prev != NoNode) {
+        _nodes[node.prev].next = node.next;
+    } else {
+        _buckets[node.bucket] = node.next;
+        if (node.next == NoNode) {
+            _occupied[node.bucket / Slots] &= ~(std::uint64_t{1} << (node.bucket % Slots));
+        }
+    }
+    if (node.next != NoNode) {
+        _nodes[node.next].prev = node.prev;
+    }
+}
+
+void TimingWheel::release(std::uint32_t index) {
+    Node &node = _nodes[index];
+    node.bucket = NoBucket;
+    node.generation = node.generation == 0xffffffffu ? 1 : node.generation + 1;
+    node.next = _freeNodes;
+    _freeNodes = index;
+}
+
+std::uint32_t TimingWheel::detach(std::uint16_t bucket) {
+    const std::uint32_t head = _buckets[bucket];
+    _buckets[bucket] = NoNode;
+    _occupied[bucket / Slots] &= ~(std::uint64_t{1} << (bucket % Slots));
+    return head;
+}
+
+void TimingWheel::moveTo(std::uint64_t tick) {
+    // Cascading as soon as a rotation starts keeps every timer at or after _current in a bucket ahead of it.
+    if (tick != _current && (tick & Mask) == 0) {
+        _current = tick;
+        cascade(tick);
+    }
+    _current = tick;
+}
+
+void TimingWheel::cascade(std::uint64_t tick) {
+    // tick starts a rotation of level 0, see how many upper levels it starts a rotation of as well.
+    unsigned top = 1;
+    while (top < Levels && (tick & ((std::uint64_t{1} << (Bits * (top + 1))) - 1)) == 0) {
+        top++;
+    }
+
+    if (top == Levels) {
+        std::uint32_t index = detach(OverflowBucket);
+        while (index != NoNode) {
+            const std::uint32_t next = _nodes[index].next;
+            place(index);
+            index = next;
+        }
+        top = Levels - 1;
+    }
+
+    // Higher levels first, their timers may land in the lower level buckets cascaded right after.
+    for (unsigned level = top; level >= 1; level--) {
+        const unsigned shift = Bits * level;
+        std::uint32_t index = detach(static_cast<std::uint16_t>(level * Slots + ((tick >> shift) & Mask)));
+        while (index != NoNode) {
+            const std::uint32_t next = _nodes[index].next;
+            place(index);
+            index = next;
+        }
+    }
+}
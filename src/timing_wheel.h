@@ -0,0 +1,104 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TIMING_WHEEL_H
+#define WINTOAST_TIMING_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace WinToastLib {
+
+    // A hierarchical timing wheel over abstract ticks. Scheduling and cancelling a timer are O(1); a timer
+    // sits in a coarse bucket of an upper level until its deadline is close, then cascades down to the bucket of
+    // its exact tick. All timers sharing a tick expire together by detaching their bucket.
+    //
+    // Six levels of 64 buckets cover a range of 2^36 ticks, later deadlines are parked in an overflow bucket
+    // until the wheel gets there. The wheel isn't thread safe.
+    class TimingWheel {
+    public:
+        using Handle = std::uint64_t;
+
+        static constexpr Handle InvalidHandle = 0;
+
+        // now is the last tick that counts as already processed.
+        explicit TimingWheel(std::uint64_t now = 0);
+
+        // Schedules key to expire at tick deadline. Deadlines that already passed expire on the next advance().
+        Handle schedule(std::uint64_t deadline, std::uint64_t key);
+
+        // Returns false if the timer already expired or was cancelled.
+        bool cancel(Handle handle);
+
+        // Processes every tick up to and including now, appending the keys of the expired timers to expired.
+        void advance(std::uint64_t now, std::vector<std::uint64_t> &expired);
+
+        // The earliest tick advance() may have work at, nullopt when nothing is scheduled.
+        [[nodiscard]] std::optional<std::uint64_t> nextTick() const noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+
+    private:
+        static constexpr unsigned Bits = 6;
+        static constexpr std::uint32_t Slots = 1u << Bits;
+        static constexpr std::uint64_t Mask = Slots - 1;
+        static constexpr unsigned Levels = 6;
+        static constexpr std::uint32_t NoNode = 0xffffffffu;
+        static constexpr std::uint16_t OverflowBucket = Levels * Slots;
+        static constexpr std::uint16_t NoBucket = 0xffffu;
+
+        struct Node {
+            std::uint64_t deadline;
+            std::uint64_t key;
+            std::uint32_t prev;
+            std::uint32_t next;
+            std::uint32_t generation;
+            std::uint16_t bucket;
+        };
+
+        void place(std::uint32_t index);
+
+        void link(std::uint32_t index, std::uint16_t bucket);
+
+        void unlink(std::uint32_t index);
+
+        void release(std::uint32_t index);
+
+        std::uint32_t detach(std::uint16_t bucket);
+
+        void moveTo(std::uint64_t tick);
+
+        void cascade(std::uint64_t tick);
+
+        // The next tick to process.
+        std::uint64_t _current;
+        std::size_t _size = 0;
+        std::vector<Node> _nodes;
+        std::uint32_t _freeNodes = NoNode;
+        std::array<std::uint32_t, Levels * Slots + 1> _buckets;
+        // One bit per bucket of each level, the overflow bucket is tracked by its own bit.
+        std::array<std::uint64_t, Levels + 1> _occupied{};
+    };
+}
+
+#endif //WINTOAST_TIMING_WHEEL_H
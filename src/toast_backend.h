@@ -0,0 +1,69 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_BACKEND_H
+#define WINTOAST_TOAST_BACKEND_H
+
+#include <cstddef>
+#include <string>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // The layer under ToastPipeline that actually delivers toasts. The pipeline builds the toast XML payload
+    // and hands it to the backend, which owns every live toast until it is hidden or cleared.
+    class ToastBackend {
+    public:
+        virtual ~ToastBackend() = default;
+
+        virtual void setAppUserModelId(const std::wstring &aumi) = 0;
+
+        // Shows the toast and returns the id it can be hidden with, or -1 on failure with error set.
+        // expiration is an absolute FILETIME value, 0 means the toast doesn't expire.
+        virtual INT64 show(const std::wstring &xml, INT64 expiration, WinToast::WinToastError &error) = 0;
+
+        virtual bool hide(INT64 id) = 0;
+
+        // Whether the toast is still known: not hidden, dismissed, failed, expired or evicted yet.
+        [[nodiscard]] virtual bool isLive(INT64 id) const = 0;
+
+        // Hands the toast to the OS to be shown at deliveryTime, a FILETIME value. Returns the id it can be
+        // cancelled with, or -1 on failure with error set. expiration is absolute like deliveryTime, 0 for none.
+        virtual INT64 schedule(const std::wstring &xml, INT64 deliveryTime, INT64 expiration,
+                               WinToast::WinToastError &error) = 0;
+
+        virtual bool cancelScheduled(INT64 id) = 0;
+
+        // Cancels every scheduled toast due in [from, to) and returns how many were cancelled.
+        virtual std::size_t cancelScheduled(INT64 from, INT64 to) = 0;
+
+        virtual void clear() = 0;
+
+        virtual void uninstall() = 0;
+
+        // How many live toasts the backend remembers at most, see WinToast::setLiveToastLimit().
+        virtual void setLiveToastLimit(std::size_t limit) = 0;
+
+        [[nodiscard]] virtual WinToast::LiveToastStats liveToastStats() const = 0;
+    };
+}
+
+#endif //WINTOAST_TOAST_BACKEND_H
@@ -0,0 +1,157 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "toast_deduplicator.h"
+
+using namespace WinToastLib;
+
+namespace {
+    // Feeds every value to two unrelated hash functions: FNV-1a, one round per code unit rather than per byte,
+    // and a multiply-rotate mix with constants of its own.
+    class Hasher {
+    public:
+        void add(std::uint64_t value) noexcept {
+            _fnv = (_fnv ^ value) * 0x100000001b3ULL;
+            _mix = rotateLeft(_mix ^ (value * 0x9e3779b97f4a7c15ULL), 29) * 0xbf58476d1ce4e5b9ULL;
+        }
+
+        // Length first, so consecutive fields can't shift characters between each other.
+        void add(std::wstring_view text) noexcept {
+            add(static_cast<std::uint64_t>(text.size()));
+            for (const wchar_t c: text) {
+                add(static_cast<std::uint64_t>(c));
+            }
+        }
+
+        [[nodiscard]] ToastDeduplicator::Hash value() const noexcept {
+            // A final avalanche, so the last characters reach every bit of the check.
+            std::uint64_t check = _mix ^ (_mix >> 31);
+            check *= 0x94d049bb133111ebULL;
+            check ^= check >> 29;
+            return {_fnv, check};
+        }
+
+    private:
+        static std::uint64_t rotateLeft(std::uint64_t value, unsigned bits) noexcept {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        std::uint64_t _fnv = 0xcbf29ce484222325ULL;
+        std::uint64_t _mix = 0x2545f4914f6cdd1dULL;
+    };
+}
+
+ToastDeduplicator::Hash ToastDeduplicator::hash(const WinToastTemplate &toast) noexcept {
+    Hasher hasher;
+    hasher.add(static_cast<std::uint64_t>(toast.type()));
+    hasher.add(static_cast<std::uint64_t>(toast.duration()));
+    hasher.add(static_cast<std::uint64_t>(toast.audioOption()));
+    hasher.add(static_cast<std::uint64_t>(toast.textFieldsCount()));
+    for (const std::wstring &text: toast.textFieldsView()) {
+        hasher.add(text);
+    }
+    hasher.add(static_cast<std::uint64_t>(toast.actionsCount()));
+    for (std::size_t i = 0; i < toast.actionsCount(); i++) {
+        hasher.add(toast.actionLabel(i));
+    }
+    hasher.add(toast.imagePath());
+    hasher.add(toast.audioPath());
+    hasher.add(toast.attributionText());
+    hasher.add(toast.scenario());
+    return hasher.value();
+}
+
+void ToastDeduplicator::setWindow(std::chrono::milliseconds window) {
+    _window.store(std::chrono::duration_cast<Clock::duration>(window).count(), std::memory_order_relaxed);
+    if (window.count() <= 0) {
+        forgetAll();
+    }
+}
+
+bool ToastDeduplicator::enabled() const noexcept {
+    return _window.load(std::memory_order_relaxed) > 0;
+}
+
+std::optional<INT64> ToastDeduplicator::find(const Hash &hash, const std::function<bool(INT64)> &isLive,
+                                             Clock::time_point now) {
+    std::lock_guard lock(_mutex);
+    forgetExpired(now);
+    const auto iter = _entries.find(hash.value);
+    if (iter == _entries.end() || iter->second.check != hash.check) {
+        return std::nullopt;
+    }
+    const INT64 id = iter->second.id;
+    if (!isLive(id)) {
+        _hashes.erase(id);
+        _entries.erase(iter);
+        return std::nullopt;
+    }
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void ToastDeduplicator::remember(const Hash &hash, INT64 id, Clock::time_point now) {
+    std::lock_guard lock(_mutex);
+    // A toast whose value collides with a remembered one replaces it, the older one just isn't deduplicated
+    // anymore.
+    const auto [iter, inserted] = _entries.try_emplace(hash.value, Entry{id, hash.check, now});
+    if (!inserted) {
+        _hashes.erase(iter->second.id);
+        iter->second = Entry{id, hash.check, now};
+    }
+    _hashes.insert_or_assign(id, hash.value);
+    _order.emplace_back(now, hash.value);
+    forgetExpired(now);
+}
+
+void ToastDeduplicator::forget(INT64 id) {
+    std::lock_guard lock(_mutex);
+    const auto iter = _hashes.find(id);
+    if (iter == _hashes.end()) {
+        return;
+    }
+    // The queue entry stays behind, forgetExpired() skips it.
+    _entries.erase(iter->second);
+    _hashes.erase(iter);
+}
+
+void ToastDeduplicator::forgetAll() {
+    std::lock_guard lock(_mutex);
+    _entries.clear();
+    _hashes.clear();
+    _order.clear();
+}
+
+std::uint64_t ToastDeduplicator::suppressed() const noexcept {
+    return _suppressed.load(std::memory_order_relaxed);
+}
+
+void ToastDeduplicator::forgetExpired(Clock::time_point now) {
+    const Clock::duration window(_window.load(std::memory_order_relaxed));
+    while (!_order.empty() && now - _order.front().first >= window) {
+        const auto iter = _entries.find(_order.front().second);
+        // A later show of the same toast refreshed the entry, that one is still in the queue.
+        if (iter != _entries.end() && iter->second.shownAt == _order.front().first) {
+            _hashes.erase(iter->second.id);
+            _entries.erase(iter);
+        }
+        _order.pop_front();
+    }
+}
@@ -0,0 +1,93 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_DEDUPLICATOR_H
+#define WINTOAST_TOAST_DEDUPLICATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // Remembers which toasts were shown recently, by a hash of everything that ends up in their payload, so
+    // identical toasts shown again within the window can be answered with the id of the first one.
+    // A window of zero turns deduplication off.
+    class ToastDeduplicator {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Two independent 64 bit hashes of a toast. value picks the entry, check has to match too, so a
+        // collision of one of them alone never suppresses a different toast.
+        struct Hash {
+            std::uint64_t value;
+            std::uint64_t check;
+        };
+
+        static Hash hash(const WinToastTemplate &toast) noexcept;
+
+        void setWindow(std::chrono::milliseconds window);
+
+        [[nodiscard]] bool enabled() const noexcept;
+
+        // The id of the toast with this hash shown within the window, counted as a suppressed duplicate. A toast
+        // isLive says is gone (hidden, dismissed, failed, expired or evicted by the backend) is forgotten
+        // instead. isLive is called with the deduplicator locked.
+        std::optional<INT64> find(const Hash &hash, const std::function<bool(INT64)> &isLive,
+                                  Clock::time_point now = Clock::now());
+
+        void remember(const Hash &hash, INT64 id, Clock::time_point now = Clock::now());
+
+        // Forgets the toast, later duplicates of it are shown again.
+        void forget(INT64 id);
+
+        void forgetAll();
+
+        [[nodiscard]] std::uint64_t suppressed() const noexcept;
+
+    private:
+        struct Entry {
+            INT64 id;
+            std::uint64_t check;
+            Clock::time_point shownAt;
+        };
+
+        void forgetExpired(Clock::time_point now);
+
+        std::atomic<Clock::rep> _window{0};
+        std::mutex _mutex;
+        std::unordered_map<std::uint64_t, Entry> _entries;
+        // The hash each remembered toast is stored under, so forgetting a toast doesn't scan the entries.
+        std::unordered_map<INT64, std::uint64_t> _hashes;
+        // Hashes in the order they were remembered, so old entries are dropped without scanning the map.
+        std::deque<std::pair<Clock::time_point, std::uint64_t>> _order;
+        std::atomic<std::uint64_t> _suppressed{0};
+    };
+}
+
+#endif //WINTOAST_TOAST_DEDUPLICATOR_H
@@ -0,0 +1,213 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "toast_pipeline.h"
+#include "toast_registry.h"
+#include "toast_xml_serializer.h"
+#include "worker_pool.h"
+#include "file_time.h"
+#include "pipeline_stats.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+using namespace WinToastLib;
+
+ToastPipeline::ToastPipeline(std::unique_ptr<ToastBackend> backend)
+        : _backend(std::move(backend)), _liveToastLimit(DefaultLiveToastLimit) {}
+
+void ToastPipeline::setBackend(std::unique_ptr<ToastBackend> backend) {
+    _deduplicator.forgetAll();
+    _backend = std::move(backend);
+    _backend->setAppUserModelId(_aumi);
+    _backend->setLiveToastLimit(_liveToastLimit);
+}
+
+ToastBackend &ToastPipeline::backend() const noexcept {
+    return *_backend;
+}
+
+void ToastPipeline::setAppUserModelId(const std::wstring &aumi) {
+    _aumi = aumi;
+    _backend->setAppUserModelId(aumi);
+}
+
+void ToastPipeline::setLiveToastLimit(std::size_t limit) {
+    _liveToastLimit = limit;
+    _backend->setLiveToastLimit(limit);
+}
+
+WinToast::LiveToastStats ToastPipeline::liveToastStats() const {
+    return _backend->liveToastStats();
+}
+
+void ToastPipeline::setDeduplicationWindow(std::chrono::milliseconds window) {
+    _deduplicator.setWindow(window);
+}
+
+std::uint64_t ToastPipeline::suppressedDuplicates() const noexcept {
+    return _deduplicator.suppressed();
+}
+
+INT64 ToastPipeline::show(const WinToastTemplate &toast, bool modernFeatures, WinToast::WinToastError &error) {
+    error = WinToast::WinToastError::NoError;
+    WINTOAST_TIME_STAGE(WinToast::Stage::Total);
+    const bool deduplicate = _deduplicator.enabled();
+    ToastDeduplicator::Hash hash{};
+    std::optional<INT64> shown;
+    if (deduplicate) {
+        WINTOAST_TIME_STAGE(WinToast::Stage::Deduplicate);
+        hash = ToastDeduplicator::hash(toast);
+        shown = _deduplicator.find(hash, isLive());
+    }
+    if (shown) {
+        TRACE_DEBUG(Toast, "Suppressed a duplicate of toast " << *shown);
+        return *shown;
+    }
+
+    thread_local std::wstring payload;
+    bool built;
+    {
+        WINTOAST_TIME_STAGE(WinToast::Stage::Serialize);
+        built = ToastXmlSerializer::serialize(toast, modernFeatures, payload);
+    }
+    if (!built) {
+        error = WinToast::WinToastError::UnknownError;
+        TRACE_ERROR(Toast, "Error in showToast while building the toast payload");
+        return -1;
+    }
+
+    INT64 expiration = 0;
+    if (toast.expiration() > 0) {
+        expiration = FileTime::now() + toast.expiration() * 10000;
+    }
+
+    TRACE_DEBUG(Toast, "xml: " << payload);
+    const INT64 id = _backend->show(payload, expiration, error);
+    if (deduplicate && id >= 0) {
+        _deduplicator.remember(hash, id);
+    }
+    return id;
+}
+
+std::vector<WinToast::ShowResult> ToastPipeline::show(const WinToastTemplate *toasts, std::size_t count,
+                                                      bool modernFeatures) {
+    std::vector<WinToast::ShowResult> results(count, WinToast::ShowResult{-1, WinToast::WinToastError::NoError});
+
+    // Building the payloads is the part that doesn't depend on the notification platform, so it is done in
+    // parallel. The calling thread takes part, hence one thread less than the hardware has.
+    static WorkerPool pool((std::max)(std::thread::hardware_concurrency(), 1u) - 1);
+    const bool deduplicate = _deduplicator.enabled();
+    std::vector<std::wstring> payloads(count);
+    std::vector<ToastDeduplicator::Hash> hashes(deduplicate ? count : 0);
+    pool.parallelFor(count, [&](std::size_t i) {
+        WINTOAST_TIME_STAGE(WinToast::Stage::Serialize);
+        try {
+            if (!ToastXmlSerializer::serialize(toasts[i], modernFeatures, payloads[i])) {
+                results[i].error = WinToast::WinToastError::UnknownError;
+            }
+            if (deduplicate) {
+                hashes[i] = ToastDeduplicator::hash(toasts[i]);
+            }
+        } catch (const std::exception &e) {
+            // A toast that can't be built fails on its own, the rest of the batch is still shown.
+            TRACE_ERROR(Toast, "Error building the payload of toast " << i << ": " << e.what());
+            results[i].error = WinToast::WinToastError::UnknownError;
+        }
+    });
+
+    const INT64 now = FileTime::now();
+    const std::function<bool(INT64)> live = isLive();
+    for (std::size_t i = 0; i < count; i++) {
+        if (results[i].error != WinToast::WinToastError::NoError) {
+            TRACE_ERROR(Toast, "Error in showToasts while building the payload of toast " << i);
+            continue;
+        }
+
+        std::optional<INT64> shown;
+        if (deduplicate) {
+            WINTOAST_TIME_STAGE(WinToast::Stage::Deduplicate);
+            shown = _deduplicator.find(hashes[i], live);
+        }
+        if (shown) {
+            TRACE_DEBUG(Toast, "Suppressed a duplicate of toast " << *shown);
+            results[i].id = *shown;
+            continue;
+        }
+
+        const INT64 expiration = toasts[i].expiration() > 0 ? now + toasts[i].expiration() * 10000 : 0;
+        TRACE_DEBUG(Toast, "xml: " << payloads[i]);
+        results[i].id = _backend->show(payloads[i], expiration, results[i].error);
+        if (deduplicate && results[i].id >= 0) {
+            _deduplicator.remember(hashes[i], results[i].id);
+        }
+    }
+    return results;
+}
+
+INT64 ToastPipeline::schedule(const WinToastTemplate &toast, std::chrono::system_clock::time_point deliveryTime,
+                              bool modernFeatures, WinToast::WinToastError &error) {
+    error = WinToast::WinToastError::NoError;
+    thread_local std::wstring payload;
+    if (!ToastXmlSerializer::serialize(toast, modernFeatures, payload)) {
+        error = WinToast::WinToastError::UnknownError;
+        TRACE_ERROR(Schedule, "Error in scheduleToast while building the toast payload");
+        return -1;
+    }
+
+    const INT64 delivery = FileTime::from(deliveryTime);
+    const INT64 expiration = toast.expiration() > 0 ? delivery + toast.expiration() * 10000 : 0;
+    TRACE_DEBUG(Schedule, "xml: " << payload);
+    return _backend->schedule(payload, delivery, expiration, error);
+}
+
+bool ToastPipeline::cancelScheduled(INT64 id) {
+    return _backend->cancelScheduled(id);
+}
+
+std::size_t ToastPipeline::cancelScheduled(std::chrono::system_clock::time_point from,
+                                           std::chrono::system_clock::time_point to) {
+    return _backend->cancelScheduled(FileTime::from(from), FileTime::from(to));
+}
+
+bool ToastPipeline::hide(INT64 id) {
+    // A toast that couldn't be hidden is still on screen, so it keeps suppressing its duplicates.
+    if (!_backend->hide(id)) {
+        return false;
+    }
+    _deduplicator.forget(id);
+    return true;
+}
+
+void ToastPipeline::clear() {
+    _deduplicator.forgetAll();
+    _backend->clear();
+}
+
+void ToastPipeline::uninstall() {
+    _deduplicator.forgetAll();
+    _backend->uninstall();
+}
+
+std::function<bool(INT64)> ToastPipeline::isLive() const {
+    return [backend = _backend.get()](INT64 id) { return backend->isLive(id); };
+}
@@ -0,0 +1,92 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_PIPELINE_H
+#define WINTOAST_TOAST_PIPELINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "wintoastlib.h"
+#include "toast_backend.h"
+#include "toast_deduplicator.h"
+
+namespace WinToastLib {
+
+    // The platform independent part of WinToast: it suppresses duplicates, builds the payload of a template and
+    // hands it to a ToastBackend. WinToastImpl checks that WinToast is initialized and forwards to a pipeline
+    // over the WinRT backend, tests and benchmarks drive one over a LoopbackBackend.
+    class ToastPipeline {
+    public:
+        explicit ToastPipeline(std::unique_ptr<ToastBackend> backend);
+
+        // Replaces the backend and hands it the current AUMI and live toast limit. Toasts shown through the
+        // previous backend are forgotten. Must not be called while other threads use the pipeline.
+        void setBackend(std::unique_ptr<ToastBackend> backend);
+
+        [[nodiscard]] ToastBackend &backend() const noexcept;
+
+        void setAppUserModelId(const std::wstring &aumi);
+
+        void setLiveToastLimit(std::size_t limit);
+
+        [[nodiscard]] WinToast::LiveToastStats liveToastStats() const;
+
+        void setDeduplicationWindow(std::chrono::milliseconds window);
+
+        [[nodiscard]] std::uint64_t suppressedDuplicates() const noexcept;
+
+        // modernFeatures is passed on to ToastXmlSerializer::serialize(). Returns the id of the toast, or -1 with
+        // error set.
+        INT64 show(const WinToastTemplate &toast, bool modernFeatures, WinToast::WinToastError &error);
+
+        // Builds the payloads in parallel, then shows the toasts in order.
+        std::vector<WinToast::ShowResult> show(const WinToastTemplate *toasts, std::size_t count, bool modernFeatures);
+
+        INT64 schedule(const WinToastTemplate &toast, std::chrono::system_clock::time_point deliveryTime,
+                       bool modernFeatures, WinToast::WinToastError &error);
+
+        bool cancelScheduled(INT64 id);
+
+        std::size_t cancelScheduled(std::chrono::system_clock::time_point from,
+                                    std::chrono::system_clock::time_point to);
+
+        bool hide(INT64 id);
+
+        void clear();
+
+        void uninstall();
+
+    private:
+        // Lets the deduplicator check that the toast it would answer with is still live.
+        [[nodiscard]] std::function<bool(INT64)> isLive() const;
+
+        std::unique_ptr<ToastBackend> _backend;
+        std::wstring _aumi;
+        std::size_t _liveToastLimit;
+        ToastDeduplicator _deduplicator;
+    };
+}
+
+#endif //WINTOAST_TOAST_PIPELINE_H
@@ -0,0 +1,376 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_REGISTRY_H
+#define WINTOAST_TOAST_REGISTRY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "wintoastlib.h"
+#include "expiry_scheduler.h"
+#include "file_time.h"
+#include "timing_wheel.h"
+
+namespace WinToastLib {
+
+    inline constexpr std::size_t DefaultLiveToastLimit = 1024;
+
+    // The toasts a backend currently has on screen. The registry hands out the toast ids: each id names a slot
+    // together with the generation of that slot, so finding a toast is an array access and an id that outlived
+    // its toast never matches the toast reusing the slot. Slots are spread over independently locked shards so
+    // producers showing and hiding toasts on different threads rarely contend on the same lock. There is one
+    // shard per hardware thread, up to MaxShardCount: with a single core there is nothing to contend for, and
+    // there the registry measured as fast as one map behind one mutex.
+    //
+    // Id layout: bits 0-3 hold the shard, bits 4-31 the slot within the shard and bits 32-62 the generation.
+    // Generations start at 1, so ids are always positive and never collide with the -1 error value.
+    //
+    // The registry never grows past its limit: entries leave as soon as their expiration passes, tracked by a
+    // timing wheel, and inserting into a full shard forgets the oldest entry of that shard.
+    template<typename Value>
+    class ToastRegistry {
+    public:
+        static constexpr std::size_t MaxShardCount = 16;
+
+        explicit ToastRegistry(std::size_t limit = DefaultLiveToastLimit)
+                : _shardCount(defaultShardCount()),
+                  _expiry([this](const std::vector<std::uint64_t> &ids) { expire(ids); }) {
+            setLimit(limit);
+        }
+
+        // The limit is spread evenly over the shards, so it is rounded up to a multiple of shardCount().
+        void setLimit(std::size_t limit) noexcept {
+            const std::size_t perShard = limit == 0 ? 1 : (limit + _shardCount - 1) / _shardCount;
+            _shardLimit.store(perShard, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::size_t shardCount() const noexcept {
+            return _shardCount;
+        }
+
+        // Stores the value in a free slot and returns its id, or -1 if the shard ran out of slots. expiration is
+        // an absolute FILETIME value, 0 means the entry doesn't expire. bytes is what the entry roughly costs.
+        INT64 insert(Value value, INT64 expiration = 0, std::size_t bytes = sizeof(Value)) {
+            const std::size_t shardIndex = _nextShard.fetch_add(1, std::memory_order_relaxed) & (_shardCount - 1);
+            Shard &shard = _shards[shardIndex];
+            std::unique_lock lock(shard.mutex);
+
+            const std::size_t limit = _shardLimit.load(std::memory_order_relaxed);
+            while (shard.live >= limit) {
+                release(shard, shard.oldest);
+                _evicted.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            std::uint32_t slotIndex;
+            if (!shard.freeSlots.empty()) {
+                slotIndex = shard.freeSlots.back();
+                shard.freeSlots.pop_back();
+            } else if (shard.slots.size() <= MaxSlotIndex) {
+                slotIndex = static_cast<std::uint32_t>(shard.slots.size());
+                shard.slots.emplace_back();
+            } else {
+                return -1;
+            }
+
+            Slot &slot = shard.slots[slotIndex];
+            slot.value.emplace(std::move(value));
+            slot.bytes = bytes;
+            shard.occupy(slotIndex);
+
+            const INT64 id = makeId(shardIndex, slotIndex, slot.generation);
+            slot.deadline = std::nullopt;
+            if (expiration > 0) {
+                slot.deadline = ExpiryScheduler::Clock::now() + std::chrono::duration_cast<
+                        ExpiryScheduler::Clock::duration>(FileTime::Ticks(expiration - FileTime::now()));
+                slot.expiry = _expiry.schedule(*slot.deadline, static_cast<std::uint64_t>(id));
+            }
+            return id;
+        }
+
+        [[nodiscard]] std::optional<Value> find(INT64 id) const {
+            const Shard &shard = _shards[shardOf(id)];
+            std::lock_guard lock(shard.mutex);
+            const Slot *slot = shard.lookup(id);
+            if (slot == nullptr) {
+                return std::nullopt;
+            }
+            return slot->value;
+        }
+
+        [[nodiscard]] bool contains(INT64 id) const {
+            const Shard &shard = _shards[shardOf(id)];
+            std::lock_guard lock(shard.mutex);
+            return shard.lookup(id) != nullptr;
+        }
+
+        bool erase(INT64 id) {
+            return take(id).has_value();
+        }
+
+        // Removes the entry and hands it to the caller, so whoever takes it is the only one acting on it.
+        std::optional<Value> take(INT64 id) {
+            Shard &shard = _shards[shardOf(id)];
+            std::unique_lock lock(shard.mutex);
+            Slot *slot = shard.lookup(id);
+            if (slot == nullptr) {
+                return std::nullopt;
+            }
+            std::optional<Value> value(std::move(slot->value));
+            release(shard, slotOf(id));
+            return value;
+        }
+
+        // Puts a value taken with take() back under the same id, for when acting on it failed. It keeps its
+        // expiration and counts as the newest entry of its shard. Returns false if the slot was reused in the
+        // meantime, the id then names another toast.
+        bool restore(INT64 id, Value value) {
+            const std::size_t shardIndex = shardOf(id);
+            if (shardIndex >= _shardCount) {
+                return false;
+            }
+            Shard &shard = _shards[shardIndex];
+            std::unique_lock lock(shard.mutex);
+            const std::uint32_t slotIndex = slotOf(id);
+            if (slotIndex >= shard.slots.size() || shard.slots[slotIndex].value ||
+                shard.slots[slotIndex].generation != nextGeneration(generationOf(id))) {
+                return false;
+            }
+
+            const std::size_t limit = _shardLimit.load(std::memory_order_relaxed);
+            while (shard.live >= limit) {
+                release(shard, shard.oldest);
+                _evicted.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Freed last, so the slot is normally at the back.
+            const auto free = std::find(shard.freeSlots.rbegin(), shard.freeSlots.rend(), slotIndex);
+            shard.freeSlots.erase(std::next(free).base());
+            Slot &slot = shard.slots[slotIndex];
+            slot.generation = generationOf(id);
+            slot.value.emplace(std::move(value));
+            shard.occupy(slotIndex);
+            if (slot.deadline) {
+                slot.expiry = _expiry.schedule(*slot.deadline, static_cast<std::uint64_t>(id));
+            }
+            return true;
+        }
+
+        // Empties the registry, returning everything that was in it. Entries inserted while draining may be
+        // left behind.
+        std::vector<Value> drain() {
+            std::vector<Value> values;
+            for (std::size_t i = 0; i < _shardCount; i++) {
+                Shard &shard = _shards[i];
+                std::unique_lock lock(shard.mutex);
+                values.reserve(values.size() + shard.live);
+                while (shard.live > 0) {
+                    values.push_back(std::move(*shard.slots[shard.oldest].value));
+                    release(shard, shard.oldest);
+                }
+            }
+            return values;
+        }
+
+        [[nodiscard]] std::size_t size() const {
+            std::size_t size = 0;
+            for (std::size_t i = 0; i < _shardCount; i++) {
+                const Shard &shard = _shards[i];
+                std::lock_guard lock(shard.mutex);
+                size += shard.live;
+            }
+            return size;
+        }
+
+        [[nodiscard]] WinToast::LiveToastStats stats() const {
+            WinToast::LiveToastStats stats{};
+            for (std::size_t i = 0; i < _shardCount; i++) {
+                const Shard &shard = _shards[i];
+                std::lock_guard lock(shard.mutex);
+                stats.resident += shard.live;
+                stats.approximateBytes += shard.bytes;
+            }
+            stats.expired = _expired.load(std::memory_order_relaxed);
+            stats.evicted = _evicted.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        static constexpr unsigned ShardBits = 4;
+        static constexpr unsigned SlotBits = 28;
+        static constexpr std::uint32_t MaxSlotIndex = (1u << SlotBits) - 1;
+        static constexpr std::uint32_t MaxGeneration = 0x7fffffffu;
+        static constexpr std::uint32_t NoSlot = 0xffffffffu;
+
+        static_assert(MaxShardCount == 1u << ShardBits);
+
+        struct Slot {
+            std::uint32_t generation = 1;
+            // Occupied slots are linked from oldest to newest.
+            std::uint32_t older = NoSlot;
+            std::uint32_t newer = NoSlot;
+            TimingWheel::Handle expiry = TimingWheel::InvalidHandle;
+            // When the entry expires, kept so a restored entry expires on time too.
+            std::optional<ExpiryScheduler::Clock::time_point> deadline;
+            std::size_t bytes = 0;
+            std::optional<Value> value;
+        };
+
+        struct alignas(64) Shard {
+            // Lookups are rare next to inserts and erases, and a plain mutex measured about twice as fast as a
+            // shared one for them.
+            mutable std::mutex mutex;
+            std::vector<Slot> slots;
+            std::vector<std::uint32_t> freeSlots;
+            std::uint32_t oldest = NoSlot;
+            std::uint32_t newest = NoSlot;
+            std::size_t live = 0;
+            std::size_t bytes = 0;
+
+            Slot *lookup(INT64 id) {
+                return const_cast<Slot *>(static_cast<const Shard *>(this)->lookup(id));
+            }
+
+            const Slot *lookup(INT64 id) const {
+                const std::uint32_t slotIndex = slotOf(id);
+                if (slotIndex >= slots.size()) {
+                    return nullptr;
+                }
+                const Slot &slot = slots[slotIndex];
+                if (!slot.value || slot.generation != generationOf(id)) {
+                    return nullptr;
+                }
+                return &slot;
+            }
+
+            void occupy(std::uint32_t slotIndex) {
+                Slot &slot = slots[slotIndex];
+                slot.older = newest;
+                slot.newer = NoSlot;
+                if (newest != NoSlot) {
+                    slots[newest].newer = slotIndex;
+                } else {
+                    oldest = slotIndex;
+                }
+                newest = slotIndex;
+                live++;
+                bytes += slot.bytes;
+            }
+
+            // Frees an occupied slot. Bumping the generation is what invalidates the ids handed out for it.
+            void release(std::uint32_t slotIndex) {
+                Slot &slot = slots[slotIndex];
+                if (slot.older != NoSlot) {
+                    slots[slot.older].newer = slot.newer;
+                } else {
+                    oldest = slot.newer;
+                }
+                if (slot.newer != NoSlot) {
+                    slots[slot.newer].older = slot.older;
+                } else {
+                    newest = slot.older;
+                }
+
+                slot.value.reset();
+                slot.generation = nextGeneration(slot.generation);
+                freeSlots.push_back(slotIndex);
+                live--;
+                bytes -= slot.bytes;
+            }
+        };
+
+        void release(Shard &shard, std::uint32_t slotIndex) {
+            Slot &slot = shard.slots[slotIndex];
+            if (slot.expiry != TimingWheel::InvalidHandle) {
+                _expiry.cancel(slot.expiry);
+                slot.expiry = TimingWheel::InvalidHandle;
+            }
+            shard.release(slotIndex);
+        }
+
+        void expire(const std::vector<std::uint64_t> &ids) {
+            for (const std::uint64_t id: ids) {
+                Shard &shard = _shards[shardOf(static_cast<INT64>(id))];
+                std::unique_lock lock(shard.mutex);
+                Slot *slot = shard.lookup(static_cast<INT64>(id));
+                if (slot == nullptr) {
+                    continue;
+                }
+                // The timer already fired, there is nothing left to cancel.
+                slot->expiry = TimingWheel::InvalidHandle;
+                shard.release(slotOf(static_cast<INT64>(id)));
+                _expired.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        static INT64 makeId(std::size_t shard, std::uint32_t slot, std::uint32_t generation) noexcept {
+            return static_cast<INT64>((static_cast<std::uint64_t>(generation) << 32) |
+                                      (static_cast<std::uint64_t>(slot) << ShardBits) |
+                                      static_cast<std::uint64_t>(shard));
+        }
+
+        // An id naming a shard this registry doesn't use is simply not found there.
+        static std::size_t shardOf(INT64 id) noexcept {
+            return static_cast<std::size_t>(static_cast<std::uint64_t>(id) & (MaxShardCount - 1));
+        }
+
+        static std::size_t defaultShardCount() noexcept {
+            const std::size_t threads = std::thread::hardware_concurrency();
+            std::size_t count = 1;
+            while (count < threads && count < MaxShardCount) {
+                count *= 2;
+            }
+            return count;
+        }
+
+        static std::uint32_t nextGeneration(std::uint32_t generation) noexcept {
+            return generation == MaxGeneration ? 1 : generation + 1;
+        }
+
+        static std::uint32_t slotOf(INT64 id) noexcept {
+            return static_cast<std::uint32_t>((static_cast<std::uint64_t>(id) >> ShardBits) & MaxSlotIndex);
+        }
+
+        static std::uint32_t generationOf(INT64 id) noexcept {
+            return static_cast<std::uint32_t>(static_cast<std::uint64_t>(id) >> 32);
+        }
+
+        const std::size_t _shardCount;
+        std::array<Shard, MaxShardCount> _shards;
+        std::atomic<std::size_t> _nextShard{0};
+        std::atomic<std::size_t> _shardLimit{0};
+        std::atomic<std::uint64_t> _expired{0};
+        std::atomic<std::uint64_t> _evicted{0};
+        // Last, so its thread is gone before the shards it expires entries from.
+        ExpiryScheduler _expiry;
+    };
+}
+
+#endif //WINTOAST_TOAST_REGISTRY_H
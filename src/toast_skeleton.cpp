@@ -0,0 +1,151 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "toast_skeleton.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+using namespace WinToastLib;
+
+namespace {
+    constexpr std::size_t TemplateTypesCount = 8;
+    constexpr std::size_t DurationsCount = 3;
+    // Without modern features only the template type matters, with them every combination of attribution,
+    // actions, audio and duration gets its own skeleton.
+    constexpr std::size_t LayoutsPerType = 1 + 2 * 2 * 2 * DurationsCount;
+    constexpr std::size_t LayoutsCount = TemplateTypesCount * LayoutsPerType;
+
+    constexpr std::wstring_view TemplateNames[TemplateTypesCount] = {
+            L"ToastImageAndText01",
+            L"ToastImageAndText02",
+            L"ToastImageAndText03",
+            L"ToastImageAndText04",
+            L"ToastText01",
+            L"ToastText02",
+            L"ToastText03",
+            L"ToastText04",
+    };
+
+    inline std::wstring_view durationName(WinToastTemplate::Duration duration) {
+        return duration == WinToastTemplate::Duration::Short ? L"short" : L"long";
+    }
+}
+
+const ToastSkeleton &ToastSkeleton::get(const WinToastTemplate &toast, bool modernFeatures) {
+    static std::array<std::once_flag, LayoutsCount> compiled;
+    static std::array<std::unique_ptr<const ToastSkeleton>, LayoutsCount> skeletons;
+
+    Layout layout{toast.type(), modernFeatures, false, false, false, WinToastTemplate::Duration::System};
+    std::size_t index = static_cast<std::size_t>(toast.type()) * LayoutsPerType;
+    if (modernFeatures) {
+        layout.hasAttribution = !toast.attributionText().empty();
+        layout.hasActions = toast.actionsCount() > 0;
+        layout.hasAudio = toast.audioPath().empty() && toast.audioOption() == WinToastTemplate::AudioOption::Default;
+        layout.duration = toast.duration();
+
+        index += 1 + ((layout.hasAttribution * 2 + layout.hasActions) * 2 + layout.hasAudio) * DurationsCount +
+                 static_cast<std::size_t>(layout.duration);
+    }
+
+    std::call_once(compiled[index], [&] {
+        skeletons[index].reset(new ToastSkeleton(layout));
+    });
+    return *skeletons[index];
+}
+
+//
+// See ToastXmlSerializer for the shape of the document. The toast attributes follow the order they used to be
+// set on the DOM: template and duration when there are actions, then the duration override, then the scenario.
+// Text elements are left open after their attributes, whether they end in /> or hold a value depends on the
+// value spliced in.
+//
+ToastSkeleton::ToastSkeleton(const Layout &layout) {
+    _literal += L"<toast";
+    if (layout.modernFeatures) {
+        if (layout.hasActions) {
+            _literal += L" template=\"ToastGeneric\" duration=\"";
+            _literal += durationName(layout.duration);
+            _literal += L'"';
+        } else if (layout.duration != WinToastTemplate::Duration::System) {
+            _literal += L" duration=\"";
+            _literal += durationName(layout.duration);
+            _literal += L'"';
+        }
+
+        _literal += L" scenario=\"";
+        appendSlot(Slot::Scenario);
+        _literal += L'"';
+    }
+
+    const auto type = static_cast<std::size_t>(layout.type);
+    _literal += L"><visual><binding template=\"";
+    _literal += TemplateNames[type];
+    _literal += L"\">";
+
+    if (WinToastTemplate::hasImageOf(layout.type)) {
+        _literal += L"<image id=\"1\" src=\"file:///";
+        appendSlot(Slot::ImageSource);
+        _literal += L"\"/>";
+    }
+
+    for (std::size_t i = 0; i < WinToastTemplate::textFieldsCountOf(layout.type); i++) {
+        _literal += L"<text id=\"";
+        _literal += std::to_wstring(i + 1);
+        _literal += L'"';
+        appendSlot(Slot::TextField, static_cast<std::uint8_t>(i));
+    }
+
+    if (layout.hasAttribution) {
+        _literal += L"<text placement=\"attribution\"";
+        appendSlot(Slot::Attribution);
+    }
+
+    _literal += L"</binding></visual>";
+
+    if (layout.hasActions) {
+        _literal += L"<actions>";
+        appendSlot(Slot::Actions);
+        _literal += L"</actions>";
+    }
+
+    // An empty audio element is only added when neither a sound nor an audio option was chosen.
+    if (layout.hasAudio) {
+        _literal += L"<audio/>";
+    }
+
+    _literal += L"</toast>";
+    _literal.shrink_to_fit();
+    _slots.shrink_to_fit();
+}
+
+void ToastSkeleton::appendSlot(Slot slot, std::uint8_t index) {
+    _slots.push_back({_literal.size(), slot, index});
+}
+
+const std::wstring &ToastSkeleton::literal() const noexcept {
+    return _literal;
+}
+
+const std::vector<ToastSkeleton::SlotRef> &ToastSkeleton::slots() const noexcept {
+    return _slots;
+}
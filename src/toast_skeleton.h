@@ -0,0 +1,74 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_SKELETON_H
+#define WINTOAST_TOAST_SKELETON_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // The immutable part of a toast payload. Everything that depends only on the layout of a toast (its
+    // template type, which optional elements are present and the duration) is compiled once into a literal,
+    // and the slots record where the per-toast values get spliced in. The TextField and Attribution slots sit
+    // right after the attributes of their text element, the serializer closes the element.
+    class ToastSkeleton {
+    public:
+        enum class Slot : std::uint8_t {
+            Scenario, ImageSource, TextField, Attribution, Actions
+        };
+
+        struct SlotRef {
+            std::size_t offset;
+            Slot slot;
+            std::uint8_t index;
+        };
+
+        // Returns the skeleton matching the layout of toast, compiling it on first use.
+        [[nodiscard]] static const ToastSkeleton &get(const WinToastTemplate &toast, bool modernFeatures);
+
+        [[nodiscard]] const std::wstring &literal() const noexcept;
+
+        [[nodiscard]] const std::vector<SlotRef> &slots() const noexcept;
+
+    private:
+        struct Layout {
+            WinToastTemplate::WinToastTemplateType type;
+            bool modernFeatures;
+            bool hasAttribution;
+            bool hasActions;
+            bool hasAudio;
+            WinToastTemplate::Duration duration;
+        };
+
+        explicit ToastSkeleton(const Layout &layout);
+
+        void appendSlot(Slot slot, std::uint8_t index = 0);
+
+        std::wstring _literal;
+        std::vector<SlotRef> _slots;
+    };
+}
+
+#endif //WINTOAST_TOAST_SKELETON_H
@@ -0,0 +1,112 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "toast_xml_serializer.h"
+#include "toast_skeleton.h"
+#include "xml_escape.h"
+
+using namespace WinToastLib;
+
+namespace {
+    // The image src is built in a MAX_PATH buffer already holding the "file:///" prefix.
+    constexpr std::size_t MaxImagePathLength = 260 - 8 - 1;
+
+    // Closes the start tag of a text element the skeleton left open. Like XmlDocument::GetXml(), an element left
+    // without content, including one whose every character was dropped, is written as <text .../>.
+    void appendTextContent(std::wstring &buffer, const std::wstring &text) {
+        const std::size_t start = buffer.size();
+        buffer += L'>';
+        XmlEscape::append(buffer, text, XmlEscape::Context::Text);
+        if (buffer.size() == start + 1) {
+            buffer.resize(start);
+            buffer += L"/>";
+        } else {
+            buffer += L"</text>";
+        }
+    }
+}
+
+//
+// The produced document has the shape:
+//
+// <toast template="ToastGeneric" duration="long" scenario="Default">
+//     <visual>
+//         <binding template="ToastImageAndText02">
+//             <image id="1" src="file:///..."/>
+//             <text id="1">...</text>
+//             <text id="2"/>
+//             <text placement="attribution">...</text>
+//         </binding>
+//     </visual>
+//     <actions>
+//         <action content="..." arguments="actionId=0"/>
+//     </actions>
+//     <audio/>
+// </toast>
+//
+// written without any whitespace between the elements and with every empty element in the <name/> form, as
+// XmlDocument::GetXml() would. The layout is taken from a precompiled ToastSkeleton, so building a payload only
+// copies its literal segments and splices the escaped values in between.
+//
+bool ToastXmlSerializer::serialize(const WinToastTemplate &toast, bool modernFeatures, std::wstring &buffer) {
+    buffer.clear();
+
+    if (toast.hasImage() && toast.imagePath().size() > MaxImagePathLength) {
+        return false;
+    }
+
+    const ToastSkeleton &skeleton = ToastSkeleton::get(toast, modernFeatures);
+    const std::wstring &literal = skeleton.literal();
+    buffer.reserve(literal.size() + 256);
+
+    std::size_t copied = 0;
+    for (const ToastSkeleton::SlotRef &slot: skeleton.slots()) {
+        buffer.append(literal, copied, slot.offset - copied);
+        copied = slot.offset;
+
+        switch (slot.slot) {
+            case ToastSkeleton::Slot::Scenario:
+                XmlEscape::append(buffer, toast.scenario(), XmlEscape::Context::Attribute);
+                break;
+            case ToastSkeleton::Slot::ImageSource:
+                XmlEscape::append(buffer, toast.imagePath(), XmlEscape::Context::Attribute);
+                break;
+            case ToastSkeleton::Slot::TextField:
+                appendTextContent(buffer, toast.textField(WinToastTemplate::TextField(slot.index)));
+                break;
+            case ToastSkeleton::Slot::Attribution:
+                appendTextContent(buffer, toast.attributionText());
+                break;
+            case ToastSkeleton::Slot::Actions:
+                for (std::size_t i = 0, actionsCount = toast.actionsCount(); i < actionsCount; i++) {
+                    buffer += L"<action content=\"";
+                    XmlEscape::append(buffer, toast.actionLabel(i), XmlEscape::Context::Attribute);
+                    // Same as WinToastArguments{{L"actionId", i}}.toString(), nothing in it needs encoding.
+                    buffer += L"\" arguments=\"actionId=";
+                    buffer += std::to_wstring(i);
+                    buffer += L"\"/>";
+                }
+                break;
+        }
+    }
+    buffer.append(literal, copied, std::wstring::npos);
+
+    return true;
+}
@@ -0,0 +1,42 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TOAST_XML_SERIALIZER_H
+#define WINTOAST_TOAST_XML_SERIALIZER_H
+
+#include <string>
+
+#include "wintoastlib.h"
+
+namespace WinToastLib {
+
+    // Writes the toast XML payload of a WinToastTemplate in a single pass, producing the same document the
+    // legacy template returned by ToastNotificationManager::GetTemplateContent would serialize to after being
+    // filled in, without going through the XML DOM.
+    class ToastXmlSerializer {
+    public:
+        // Replaces the content of buffer with the payload of toast. When modernFeatures is false only the text
+        // fields and the image are written, like on systems older than Windows 10.
+        // Returns false if the toast can't be represented, the content of buffer is unspecified then.
+        static bool serialize(const WinToastTemplate &toast, bool modernFeatures, std::wstring &buffer);
+    };
+}
+
+#endif //WINTOAST_TOAST_XML_SERIALIZER_H
@@ -0,0 +1,236 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "trace.h"
+#include "bounded_queue.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+
+std::atomic<std::uint32_t> Trace::enabledCategories[4]{};
+
+namespace {
+    constexpr std::size_t QueueCapacity = 1024;
+    constexpr std::chrono::milliseconds DrainInterval{20};
+
+    struct ThreadQueue {
+        BoundedQueue<WinToast::TraceRecord> records{QueueCapacity};
+        // Set once the thread is gone, the drain forgets the queue after emptying it.
+        std::atomic<bool> orphaned{false};
+    };
+
+    void writeToConsole(const WinToast::TraceRecord &record) {
+        if (record.level >= WinToast::TraceLevel::Warning) {
+            std::wcerr << record.message << std::endl;
+        } else {
+            std::wcout << record.message << std::endl;
+        }
+    }
+
+    class Hub {
+    public:
+        Hub() {
+#ifdef NDEBUG
+            _level = WinToast::TraceLevel::Warning;
+#else
+            _level = WinToast::TraceLevel::Debug;
+            _sink = writeToConsole;
+#endif
+            updateFilter();
+        }
+
+        ~Hub() {
+            {
+                std::lock_guard lock(_mutex);
+                _stopping = true;
+            }
+            _wake.notify_one();
+            _flushed.notify_all();
+            if (_drainer.joinable()) {
+                _drainer.join();
+            }
+            drain();
+        }
+
+        void attach(const std::shared_ptr<ThreadQueue> &queue) {
+            std::lock_guard lock(_mutex);
+            _queues.push_back(queue);
+            if (!_drainer.joinable()) {
+                _drainer = std::thread([this] { run(); });
+            }
+        }
+
+        void setSink(std::function<void(const WinToast::TraceRecord &)> sink) {
+            std::lock_guard lock(_sinkMutex);
+            _sink = std::move(sink);
+            updateFilter();
+        }
+
+        void setFilter(WinToast::TraceLevel level, std::uint32_t categories) {
+            std::lock_guard lock(_sinkMutex);
+            _level = level;
+            _categories = categories;
+            updateFilter();
+        }
+
+        // Has the drain thread hand everything queued so far to the sink and waits for it. Called from the sink, which
+        // already runs on the drain thread, it returns right away instead of waiting for itself.
+        void flush() {
+            std::unique_lock lock(_mutex);
+            if (!_drainer.joinable() || _stopping || std::this_thread::get_id() == _drainer.get_id()) {
+                return;
+            }
+            const std::uint64_t request = ++_flushRequests;
+            _wake.notify_one();
+            _flushed.wait(lock, [this, request] { return _flushesDone >= request || _stopping; });
+        }
+
+        std::atomic<std::uint64_t> dropped{0};
+
+    private:
+        // Must be called with the sink lock held.
+        void updateFilter() {
+            for (std::size_t level = 0; level < std::size(Trace::enabledCategories); level++) {
+                const bool on = _sink && level >= static_cast<std::size_t>(_level);
+                Trace::enabledCategories[level].store(on ? _categories : 0, std::memory_order_relaxed);
+            }
+        }
+
+        // Hands everything queued so far to the sink. Queues are single consumer: only the drain thread calls this,
+        // and the destructor once that thread is gone. The sink is called without any lock held, so it may change
+        // the sink or the filter, or flush.
+        void drain() {
+            std::vector<std::shared_ptr<ThreadQueue>> queues;
+            {
+                std::lock_guard lock(_mutex);
+                queues = _queues;
+            }
+
+            std::function<void(const WinToast::TraceRecord &)> sink;
+            {
+                std::lock_guard sinkLock(_sinkMutex);
+                sink = _sink;
+            }
+            WinToast::TraceRecord record;
+            for (const auto &queue: queues) {
+                while (queue->records.pop(record)) {
+                    if (sink) {
+                        try {
+                            sink(record);
+                        } catch (...) {
+                            // A failing sink loses its record, never the toast.
+                        }
+                    }
+                }
+            }
+
+            std::lock_guard lock(_mutex);
+            _queues.erase(std::remove_if(_queues.begin(), _queues.end(), [](const auto &queue) {
+                return queue->orphaned.load(std::memory_order_acquire) && queue->records.empty();
+            }), _queues.end());
+        }
+
+        void run() {
+            std::unique_lock lock(_mutex);
+            while (!_stopping) {
+                _wake.wait_for(lock, DrainInterval, [this] { return _stopping || _flushesDone < _flushRequests; });
+                const std::uint64_t requests = _flushRequests;
+                lock.unlock();
+                drain();
+                lock.lock();
+                _flushesDone = requests;
+                _flushed.notify_all();
+            }
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::condition_variable _flushed;
+        std::vector<std::shared_ptr<ThreadQueue>> _queues;
+        std::thread _drainer;
+        bool _stopping{false};
+        std::uint64_t _flushRequests{0};
+        std::uint64_t _flushesDone{0};
+
+        std::mutex _sinkMutex;
+        std::function<void(const WinToast::TraceRecord &)> _sink;
+        WinToast::TraceLevel _level{WinToast::TraceLevel::Debug};
+        std::uint32_t _categories{WinToast::AllTraceCategories};
+    };
+
+    Hub &hub() {
+        static Hub hub;
+        return hub;
+    }
+
+    // Runs the filter set up by the hub before the first record can be checked against it.
+    [[maybe_unused]] const Hub &initialized = hub();
+
+    class ThreadSlot {
+    public:
+        ThreadSlot() : queue(std::make_shared<ThreadQueue>()),
+                       thread(std::hash<std::thread::id>()(std::this_thread::get_id())) {
+            hub().attach(queue);
+        }
+
+        ~ThreadSlot() {
+            queue->orphaned.store(true, std::memory_order_release);
+        }
+
+        std::shared_ptr<ThreadQueue> queue;
+        const std::uint64_t thread;
+    };
+}
+
+void Trace::submit(WinToast::TraceLevel level, WinToast::TraceCategory category, std::wstring message) noexcept {
+    try {
+        thread_local ThreadSlot slot;
+        WinToast::TraceRecord record{level, category, std::chrono::system_clock::now(), slot.thread,
+                                     std::move(message)};
+        if (!slot.queue->records.push(std::move(record))) {
+            hub().dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    } catch (...) {
+        hub().dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Trace::setSink(std::function<void(const WinToast::TraceRecord &)> sink) {
+    hub().setSink(std::move(sink));
+}
+
+void Trace::setFilter(WinToast::TraceLevel level, std::uint32_t categories) {
+    hub().setFilter(level, categories);
+}
+
+void Trace::flush() {
+    hub().flush();
+}
+
+std::uint64_t Trace::dropped() noexcept {
+    return hub().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TRACE_H
+#define WINTOAST_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+
+#include "wintoastlib.h"
+
+// The trace sink behind the TRACE_* macros. Every thread traces into its own bounded lock free queue and a
+// background thread drains the queues into the sink, so tracing never waits for the sink. The sink runs on that
+// thread with no lock held. A record filtered out
+// costs a relaxed load: the message expression isn't evaluated.
+namespace WinToastLib::Trace {
+
+    // For each level below Off, the categories that currently reach a sink.
+    extern std::atomic<std::uint32_t> enabledCategories[4];
+
+    [[nodiscard]] inline bool enabled(WinToast::TraceLevel level, WinToast::TraceCategory category) noexcept {
+        return (enabledCategories[static_cast<std::size_t>(level)].load(std::memory_order_relaxed) &
+                static_cast<std::uint32_t>(category)) != 0;
+    }
+
+    void submit(WinToast::TraceLevel level, WinToast::TraceCategory category, std::wstring message) noexcept;
+
+    void setSink(std::function<void(const WinToast::TraceRecord &)> sink);
+
+    void setFilter(WinToast::TraceLevel level, std::uint32_t categories);
+
+    // Waits until the drain thread handed everything queued so far to the sink. Returns right away when called
+    // from the sink.
+    void flush();
+
+    [[nodiscard]] std::uint64_t dropped() noexcept;
+}
+
+#define WINTOAST_TRACE(level, category, message)                                                        \
+    do {                                                                                                \
+        if (::WinToastLib::Trace::enabled(level, category)) {                                           \
+            std::wostringstream _traceStream;                                                           \
+            _traceStream << message;                                                                    \
+            ::WinToastLib::Trace::submit(level, category, std::move(_traceStream).str());              \
+        }                                                                                               \
+    } while (false)
+
+#define TRACE_DEBUG(category, message) \
+    WINTOAST_TRACE(::WinToastLib::WinToast::TraceLevel::Debug, ::WinToastLib::WinToast::TraceCategory::category, message)
+#define TRACE_INFO(category, message) \
+    WINTOAST_TRACE(::WinToastLib::WinToast::TraceLevel::Info, ::WinToastLib::WinToast::TraceCategory::category, message)
+#define TRACE_WARNING(category, message) \
+    WINTOAST_TRACE(::WinToastLib::WinToast::TraceLevel::Warning, ::WinToastLib::WinToast::TraceCategory::category, message)
+#define TRACE_ERROR(category, message) \
+    WINTOAST_TRACE(::WinToastLib::WinToast::TraceLevel::Error, ::WinToastLib::WinToast::TraceCategory::category, message)
+
+#endif //WINTOAST_TRACE_H
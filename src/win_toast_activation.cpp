@@ -0,0 +1,60 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "wintoastlib.h"
+
+using namespace WinToastLib;
+
+WinToastActivation::WinToastActivation(std::wstring_view arguments, const WinToastUserInput *userInput,
+                                       std::size_t userInputCount) noexcept
+        : _arguments(arguments), _userInput(userInput), _userInputCount(userInput ? userInputCount : 0) {
+}
+
+const WinToastArgumentsView &WinToastActivation::arguments() const noexcept {
+    return _arguments;
+}
+
+std::size_t WinToastActivation::userInputCount() const noexcept {
+    return _userInputCount;
+}
+
+std::pair<std::wstring_view, std::wstring_view> WinToastActivation::userInputAt(std::size_t index) const noexcept {
+    const WinToastUserInput &input = _userInput[index];
+    return {input.key ? input.key : L"", input.value ? input.value : L""};
+}
+
+std::optional<std::wstring_view> WinToastActivation::userInput(std::wstring_view key) const noexcept {
+    for (std::size_t i = _userInputCount; i > 0; i--) {
+        const auto [inputKey, inputValue] = userInputAt(i - 1);
+        if (inputKey == key) {
+            return inputValue;
+        }
+    }
+    return std::nullopt;
+}
+
+WinToastActivation::Data WinToastActivation::materialize() const {
+    Data data{_arguments.materialize(), {}};
+    for (std::size_t i = 0; i < _userInputCount; i++) {
+        const auto [key, value] = userInputAt(i);
+        data.userInput.insert_or_assign(std::wstring(key), std::wstring(value));
+    }
+    return data;
+}
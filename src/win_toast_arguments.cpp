@@ -19,148 +19,280 @@
  */
 
 #include "wintoastlib.h"
+#include "percent_codec.h"
 
-#include <vector>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace WinToastLib;
 
-inline void replaceAll(std::wstring &str, const std::wstring &from, const std::wstring &to) {
-    std::size_t startPos = 0;
+namespace {
+    inline std::size_t encodedPairSize(const std::wstring &key, const std::wstring &value) noexcept {
+        std::size_t size = PercentCodec::encodedSize(key);
+        if (!value.empty())
+            size += 1 + PercentCodec::encodedSize(value);
+        return size;
+    }
 
-    while ((startPos = str.find(from, startPos)) != std::wstring::npos) {
-        str.replace(startPos, from.length(), to);
-        startPos += to.length(); // Handles case where 'from' is a substring of 'to'
+    inline void appendEncodedPair(std::wstring &buffer, const std::wstring &key, const std::wstring &value) {
+        PercentCodec::appendEncoded(buffer, key);
+        if (!value.empty()) {
+            buffer += L'=';
+            PercentCodec::appendEncoded(buffer, value);
+        }
     }
 }
 
-inline std::vector<std::wstring> splitString(std::wstring str, wchar_t delim) {
-    std::vector<std::wstring> res;
-    std::size_t pos;
+WinToastArguments::WinToastArguments(const std::wstring &arguments) {
+    parse(arguments);
+}
 
-    while ((pos = str.find(delim)) != std::wstring::npos) {
-        res.push_back(str.substr(0, pos));
-        str.erase(0, pos + 1);
+void WinToastArguments::parse(const std::wstring &arguments) {
+    mPairs.clear();
+
+    for (const auto &[key, value]: WinToastArgumentsView(arguments)) {
+        add(PercentCodec::decode(key), PercentCodec::decode(value));
     }
-    res.push_back(str);
+}
 
-    return res;
+std::wstring WinToastArguments::toString() const {
+    std::wstring serializedString;
+    toString(serializedString);
+    return serializedString;
 }
 
-std::wstring encode(const std::wstring &str) {
-    std::wstring encodedString{str};
+void WinToastArguments::toString(std::wstring &buffer) const {
+    if (mPairs.empty()) return;
 
-    replaceAll(encodedString, L"%", L"%25");
-    replaceAll(encodedString, L";", L"%3B");
-    replaceAll(encodedString, L"=", L"%3D");
-    replaceAll(encodedString, L"\"", L"%22");
-    replaceAll(encodedString, L"'", L"%27");
-    replaceAll(encodedString, L"<", L"%3C");
-    replaceAll(encodedString, L">", L"%3E");
-    replaceAll(encodedString, L"&", L"%26");
+    std::size_t size = mPairs.size() - 1;
+    for (const auto &[key, value]: mPairs) {
+        size += encodedPairSize(key, value);
+    }
+    buffer.reserve(buffer.size() + size);
 
-    return encodedString;
+    auto it = mPairs.cbegin();
+    appendEncodedPair(buffer, it->first, it->second);
+    for (++it; it != mPairs.cend(); ++it) {
+        buffer += L';';
+        appendEncodedPair(buffer, it->first, it->second);
+    }
 }
 
-std::wstring decode(const std::wstring &str) {
-    std::wstring decodedString{str};
+WinToastArguments::iterator WinToastArguments::lowerBound(std::wstring_view key) noexcept {
+    return std::lower_bound(mPairs.begin(), mPairs.end(), key, [](const value_type &pair, std::wstring_view k) {
+        return std::wstring_view(pair.first) < k;
+    });
+}
 
-    replaceAll(decodedString, L"%3B", L";");
-    replaceAll(decodedString, L"%3D", L"=");
-    replaceAll(decodedString, L"%22", L"\"");
-    replaceAll(decodedString, L"%27", L"'");
-    replaceAll(decodedString, L"%3C", L"<");
-    replaceAll(decodedString, L"%3E", L">");
-    replaceAll(decodedString, L"%26", L"&");
-    replaceAll(decodedString, L"%25", L"%");
+WinToastArguments::const_iterator WinToastArguments::find(std::wstring_view key) const noexcept {
+    const auto iter = std::lower_bound(mPairs.cbegin(), mPairs.cend(), key,
+                                       [](const value_type &pair, std::wstring_view k) {
+                                           return std::wstring_view(pair.first) < k;
+                                       });
+    return iter != mPairs.cend() && iter->first == key ? iter : mPairs.cend();
+}
 
-    return decodedString;
+void WinToastArguments::add(std::wstring key, std::wstring value) {
+    const auto iter = lowerBound(key);
+    if (iter != mPairs.end() && iter->first == key) {
+        iter->second = std::move(value);
+    } else {
+        mPairs.emplace(iter, std::move(key), std::move(value));
+    }
 }
 
-inline std::wstring encodePair(const std::wstring &key, const std::wstring &value) {
-    if (value.empty())
-        return encode(key);
-    else
-        return encode(key) + L'=' + encode(value);
+bool WinToastArguments::remove(std::wstring_view key) noexcept {
+    const auto iter = lowerBound(key);
+    if (iter == mPairs.end() || iter->first != key) {
+        return false;
+    }
+    mPairs.erase(iter);
+    return true;
 }
 
-WinToastArguments::WinToastArguments(const std::wstring &arguments) {
-    parse(arguments);
+std::wstring WinToastArguments::get(std::wstring_view key) const {
+    const auto iter = find(key);
+    if (iter == mPairs.cend()) {
+        throw std::out_of_range("WinToastArguments::get: key not found");
+    }
+    return iter->second;
 }
 
-void WinToastArguments::parse(const std::wstring &arguments) {
-    mPairs.clear();
+bool WinToastArguments::empty() const noexcept {
+    return mPairs.empty();
+}
 
-    if (arguments.find_first_not_of(' ') != std::wstring::npos) {
-        for (const std::wstring &pair: splitString(arguments, ';')) {
-            std::wstring key, value;
-            std::size_t indexOfEquals = pair.find('=');
+bool WinToastArguments::contains(std::wstring_view key) const noexcept {
+    return find(key) != mPairs.cend();
+}
 
-            if (indexOfEquals == std::wstring::npos) {
-                key = decode(pair);
-            } else {
-                key = decode(pair.substr(0, indexOfEquals));
-                value = decode(pair.substr(indexOfEquals + 1));
-            }
+WinToastArguments::size_type WinToastArguments::size() const noexcept {
+    return mPairs.size();
+}
 
-            mPairs[key] = value;
-        }
-    }
+WinToastArguments::iterator WinToastArguments::begin() noexcept {
+    return mPairs.begin();
 }
 
-std::wstring WinToastArguments::toString() const {
-    if (mPairs.empty()) return {};
+WinToastArguments::const_iterator WinToastArguments::begin() const noexcept {
+    return mPairs.cbegin();
+}
 
-    std::wstring serializedString;
-    auto it = mPairs.cbegin();
+WinToastArguments::const_iterator WinToastArguments::cbegin() const noexcept {
+    return mPairs.cbegin();
+}
 
-    for (; it != --mPairs.cend(); ++it) {
-        serializedString += encodePair(it->first, it->second) + L';';
+WinToastArguments::iterator WinToastArguments::end() noexcept {
+    return mPairs.end();
+}
+
+WinToastArguments::const_iterator WinToastArguments::end() const noexcept {
+    return mPairs.cend();
+}
+
+WinToastArguments::const_iterator WinToastArguments::cend() const noexcept {
+    return mPairs.cend();
+}
+
+std::wstring &WinToastArguments::operator[](std::wstring_view key) {
+    auto iter = lowerBound(key);
+    if (iter == mPairs.end() || iter->first != key) {
+        iter = mPairs.emplace(iter, std::wstring(key), std::wstring());
     }
-    serializedString += encodePair(it->first, it->second);
+    return iter->second;
+}
 
-    return serializedString;
+WinToastArgumentsView::iterator::iterator(std::wstring_view arguments, std::size_t position) noexcept
+        : _arguments(arguments), _position(position) {
+    const std::size_t separator = _arguments.find(L';', _position);
+    const std::wstring_view pair = _arguments.substr(_position, separator - _position);
+    _next = separator == std::wstring_view::npos ? std::wstring_view::npos : separator + 1;
+
+    const std::size_t indexOfEquals = pair.find(L'=');
+    if (indexOfEquals == std::wstring_view::npos) {
+        _pair = {pair, {}};
+    } else {
+        _pair = {pair.substr(0, indexOfEquals), pair.substr(indexOfEquals + 1)};
+    }
 }
 
-void WinToastArguments::add(const std::wstring &key, const std::wstring &value) {
-    mPairs[key] = value;
+WinToastArgumentsView::iterator &WinToastArgumentsView::iterator::operator++() noexcept {
+    if (_next == std::wstring_view::npos) {
+        _position = std::wstring_view::npos;
+        _pair = {};
+    } else {
+        *this = iterator(_arguments, _next);
+    }
+    return *this;
 }
 
-bool WinToastArguments::remove(const std::wstring &key) noexcept {
-    return mPairs.erase(key);
+WinToastArgumentsView::WinToastArgumentsView(std::wstring_view arguments) noexcept: _arguments(arguments) {
 }
 
-std::wstring WinToastArguments::get(const std::wstring &key) const {
-    return mPairs.at(key);
+bool WinToastArgumentsView::empty() const noexcept {
+    return begin() == end();
 }
 
-bool WinToastArguments::empty() const noexcept {
-    return mPairs.empty();
+bool WinToastArgumentsView::contains(std::wstring_view key) const noexcept {
+    return find(key).has_value();
 }
 
-bool WinToastArguments::contains(const std::wstring &key) const {
-    return mPairs.count(key) > 0;
+std::optional<std::wstring_view> WinToastArgumentsView::find(std::wstring_view key) const noexcept {
+    std::optional<std::wstring_view> value;
+    for (const auto &pair: *this) {
+        if (PercentCodec::equalsDecoded(pair.first, key)) {
+            value = pair.second;
+        }
+    }
+    return value;
 }
 
-std::map<std::wstring, std::wstring>::size_type WinToastArguments::size() const noexcept {
-    return mPairs.size();
+std::optional<std::wstring_view> WinToastArgumentsView::get(std::wstring_view key, std::wstring &buffer) const {
+    const std::optional<std::wstring_view> value = find(key);
+    if (!value || !PercentCodec::needsDecoding(*value)) {
+        return value;
+    }
+
+    buffer.clear();
+    PercentCodec::appendDecoded(buffer, *value);
+    return std::wstring_view(buffer);
 }
 
-std::map<std::wstring, std::wstring>::iterator WinToastArguments::begin() noexcept {
-    return mPairs.begin();
+std::wstring WinToastArgumentsView::get(std::wstring_view key) const {
+    const std::optional<std::wstring_view> value = find(key);
+    if (!value) {
+        throw std::out_of_range("WinToastArgumentsView::get: key not found");
+    }
+    return PercentCodec::decode(*value);
 }
 
-std::map<std::wstring, std::wstring>::const_iterator WinToastArguments::cbegin() const noexcept {
-    return mPairs.cbegin();
+WinToastArguments WinToastArgumentsView::materialize() const {
+    WinToastArguments arguments;
+    for (const auto &[key, value]: *this) {
+        arguments.add(PercentCodec::decode(key), PercentCodec::decode(value));
+    }
+    return arguments;
 }
 
-std::map<std::wstring, std::wstring>::iterator WinToastArguments::end() noexcept {
-    return mPairs.end();
+WinToastArgumentsView::iterator WinToastArgumentsView::begin() const noexcept {
+    if (_arguments.find_first_not_of(L' ') == std::wstring_view::npos) {
+        return end();
+    }
+    return {_arguments, 0};
 }
 
-std::map<std::wstring, std::wstring>::const_iterator WinToastArguments::cend() const noexcept {
-    return mPairs.cend();
+WinToastArgumentsView::iterator WinToastArgumentsView::end() const noexcept {
+    return {};
+}
+
+bool WinToastArgumentsView::parseUnsigned(std::wstring_view text, unsigned long long &value) noexcept {
+    if (text.empty()) {
+        return false;
+    }
+
+    constexpr unsigned long long Max = std::numeric_limits<unsigned long long>::max();
+    value = 0;
+    for (wchar_t c: text) {
+        if (c < L'0' || c > L'9') {
+            return false;
+        }
+        const auto digit = static_cast<unsigned long long>(c - L'0');
+        if (value > (Max - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+bool WinToastArgumentsView::parseSigned(std::wstring_view text, long long &value) noexcept {
+    const bool negative = !text.empty() && text.front() == L'-';
+    unsigned long long magnitude;
+    if (!parseUnsigned(negative ? text.substr(1) : text, magnitude)) {
+        return false;
+    }
+
+    constexpr auto Max = static_cast<unsigned long long>(std::numeric_limits<long long>::max());
+    if (negative) {
+        if (magnitude > Max + 1) {
+            return false;
+        }
+        value = magnitude == Max + 1 ? std::numeric_limits<long long>::min() : -static_cast<long long>(magnitude);
+    } else {
+        if (magnitude > Max) {
+            return false;
+        }
+        value = static_cast<long long>(magnitude);
+    }
+    return true;
 }
 
-std::wstring &WinToastArguments::operator[](const std::wstring &key) {
-    return mPairs[key];
+std::optional<bool> WinToastArgumentsView::parseBool(std::wstring_view text) noexcept {
+    if (text == L"true" || text == L"1") {
+        return true;
+    }
+    if (text == L"false" || text == L"0") {
+        return false;
+    }
+    return std::nullopt;
 }
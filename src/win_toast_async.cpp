@@ -0,0 +1,52 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "win_toast_async.h"
+
+using namespace WinToastLib;
+
+template<typename T>
+WinToastAsync<T>::WinToastAsync(std::shared_ptr<State> state) noexcept : _state(std::move(state)) {}
+
+template<typename T>
+bool WinToastAsync<T>::ready() const {
+    return _state->ready();
+}
+
+template<typename T>
+T WinToastAsync<T>::get() const {
+    return _state->wait();
+}
+
+template<typename T>
+void WinToastAsync<T>::then(std::function<void(const T &)> continuation) const {
+    if (!_state->subscribe(continuation)) {
+        continuation(_state->wait());
+    }
+}
+
+template<typename T>
+bool WinToastAsync<T>::subscribe(std::function<void(const T &)> continuation) const {
+    return _state->subscribe(std::move(continuation));
+}
+
+template class WinToastLib::WinToastAsync<WinToast::ShowResult>;
+
+template class WinToastLib::WinToastAsync<bool>;
@@ -0,0 +1,90 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_WIN_TOAST_ASYNC_H
+#define WINTOAST_WIN_TOAST_ASYNC_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "wintoastlib.h"
+#include "trace.h"
+
+namespace WinToastLib {
+
+    // The result behind every copy of a WinToastAsync, completed once by whoever ran the request.
+    template<typename T>
+    class WinToastAsync<T>::State {
+    public:
+        // Runs the continuations subscribed so far on the calling thread. One that throws is traced and skipped,
+        // the exception must not take down the submitter thread or keep the others from running.
+        void complete(T value) {
+            std::vector<std::function<void(const T &)>> continuations;
+            {
+                std::lock_guard lock(_mutex);
+                _value.emplace(std::move(value));
+                continuations.swap(_continuations);
+            }
+            _completed.notify_all();
+            for (const auto &continuation: continuations) {
+                try {
+                    continuation(*_value);
+                } catch (const std::exception &ex) {
+                    TRACE_ERROR(Toast, "Error in async continuation: " << ex.what());
+                } catch (...) {
+                    TRACE_ERROR(Toast, "Error in async continuation");
+                }
+            }
+        }
+
+        // Returns false, without keeping the continuation, if the result is already there.
+        bool subscribe(std::function<void(const T &)> continuation) {
+            std::lock_guard lock(_mutex);
+            if (_value) {
+                return false;
+            }
+            _continuations.push_back(std::move(continuation));
+            return true;
+        }
+
+        [[nodiscard]] bool ready() const {
+            std::lock_guard lock(_mutex);
+            return _value.has_value();
+        }
+
+        [[nodiscard]] const T &wait() const {
+            std::unique_lock lock(_mutex);
+            _completed.wait(lock, [this] { return _value.has_value(); });
+            return *_value;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        mutable std::condition_variable _completed;
+        std::optional<T> _value;
+        std::vector<std::function<void(const T &)>> _continuations;
+    };
+}
+
+#endif //WINTOAST_WIN_TOAST_ASYNC_H
@@ -19,82 +19,169 @@
  */
 
 #include "wintoastlib.h"
+#include "interned_string.h"
 
+#include <array>
 #include <cassert>
+#include <utility>
 
 using namespace WinToastLib;
 
-WinToastTemplate::WinToastTemplate(WinToastTemplateType type) : _type(type) {
-    static constexpr std::size_t TextFieldsCount[] = {1, 2, 2, 3, 1, 2, 2, 3};
-    _textFields = std::vector<std::wstring>(TextFieldsCount[(int) type], L"");
+namespace {
+    // Indexed by WinToastTemplate::Scenario.
+    constexpr std::wstring_view ScenarioNames[] = {L"Default", L"Alarm", L"IncomingCall", L"Reminder"};
+
+    // Indexed by WinToastTemplate::AudioSystemFile.
+    constexpr std::wstring_view AudioSystemFiles[] = {
+            L"ms-winsoundevent:Notification.Default",
+            L"ms-winsoundevent:Notification.IM",
+            L"ms-winsoundevent:Notification.Mail",
+            L"ms-winsoundevent:Notification.Reminder",
+            L"ms-winsoundevent:Notification.SMS",
+            L"ms-winsoundevent:Notification.Looping.Alarm",
+            L"ms-winsoundevent:Notification.Looping.Alarm2",
+            L"ms-winsoundevent:Notification.Looping.Alarm3",
+            L"ms-winsoundevent:Notification.Looping.Alarm4",
+            L"ms-winsoundevent:Notification.Looping.Alarm5",
+            L"ms-winsoundevent:Notification.Looping.Alarm6",
+            L"ms-winsoundevent:Notification.Looping.Alarm7",
+            L"ms-winsoundevent:Notification.Looping.Alarm8",
+            L"ms-winsoundevent:Notification.Looping.Alarm9",
+            L"ms-winsoundevent:Notification.Looping.Alarm10",
+            L"ms-winsoundevent:Notification.Looping.Call",
+            L"ms-winsoundevent:Notification.Looping.Call1",
+            L"ms-winsoundevent:Notification.Looping.Call2",
+            L"ms-winsoundevent:Notification.Looping.Call3",
+            L"ms-winsoundevent:Notification.Looping.Call4",
+            L"ms-winsoundevent:Notification.Looping.Call5",
+            L"ms-winsoundevent:Notification.Looping.Call6",
+            L"ms-winsoundevent:Notification.Looping.Call7",
+            L"ms-winsoundevent:Notification.Looping.Call8",
+            L"ms-winsoundevent:Notification.Looping.Call9",
+            L"ms-winsoundevent:Notification.Looping.Call10",
+    };
+
+    static_assert(std::size(AudioSystemFiles) ==
+                  static_cast<std::size_t>(WinToastTemplate::AudioSystemFile::Call10) + 1);
+
+    // Leaves the text fields of a moved from template empty rather than in whatever state the move left them.
+    void clear(std::array<std::wstring, WinToastTemplate::MaxTextFields> &textFields) noexcept {
+        for (std::wstring &text: textFields) {
+            text.clear();
+        }
+    }
+
+    // Replaces the entry held by a template member, taking over the reference of text.
+    void assign(InternedEntry *&member, InternedString text) noexcept {
+        InternedString::release(std::exchange(member, text.detach()));
+    }
+}
+
+WinToastTemplate::WinToastTemplate(WinToastTemplateType type)
+        : _type(type) {}
+
+WinToastTemplate::WinToastTemplate(const WinToastTemplate &other)
+        : _textFields(other._textFields), _actions(other._actions), _imagePath(other._imagePath),
+          _audioPath(other._audioPath), _attributionText(other._attributionText), _expiration(other._expiration),
+          _audioOption(other._audioOption), _type(other._type), _duration(other._duration),
+          _scenario(other._scenario) {
+    for (InternedEntry *action: _actions) {
+        InternedString::retain(action);
+    }
+    InternedString::retain(_imagePath);
+    InternedString::retain(_audioPath);
+    InternedString::retain(_attributionText);
+}
+
+WinToastTemplate::WinToastTemplate(WinToastTemplate &&other) noexcept
+        : _textFields(std::move(other._textFields)), _actions(std::move(other._actions)),
+          _imagePath(std::exchange(other._imagePath, nullptr)), _audioPath(std::exchange(other._audioPath, nullptr)),
+          _attributionText(std::exchange(other._attributionText, nullptr)), _expiration(other._expiration),
+          _audioOption(other._audioOption), _type(other._type), _duration(other._duration),
+          _scenario(other._scenario) {
+    clear(other._textFields);
+    other._actions.clear();
+}
+
+WinToastTemplate &WinToastTemplate::operator=(const WinToastTemplate &other) {
+    if (this != &other) {
+        *this = WinToastTemplate(other);
+    }
+    return *this;
+}
+
+WinToastTemplate &WinToastTemplate::operator=(WinToastTemplate &&other) noexcept {
+    if (this != &other) {
+        for (InternedEntry *action: _actions) {
+            InternedString::release(action);
+        }
+        _textFields = std::move(other._textFields);
+        clear(other._textFields);
+        _actions = std::move(other._actions);
+        other._actions.clear();
+        InternedString::release(std::exchange(_imagePath, std::exchange(other._imagePath, nullptr)));
+        InternedString::release(std::exchange(_audioPath, std::exchange(other._audioPath, nullptr)));
+        InternedString::release(std::exchange(_attributionText, std::exchange(other._attributionText, nullptr)));
+        _expiration = other._expiration;
+        _audioOption = other._audioOption;
+        _type = other._type;
+        _duration = other._duration;
+        _scenario = other._scenario;
+    }
+    return *this;
 }
 
 WinToastTemplate::~WinToastTemplate() {
-    _textFields.clear();
+    for (InternedEntry *action: _actions) {
+        InternedString::release(action);
+    }
+    InternedString::release(_imagePath);
+    InternedString::release(_audioPath);
+    InternedString::release(_attributionText);
 }
 
-void WinToastTemplate::setTextField(const std::wstring &txt, WinToastTemplate::TextField pos) {
+void WinToastTemplate::setTextField(std::wstring txt, WinToastTemplate::TextField pos) {
     const auto position = static_cast<std::size_t>(pos);
-    assert(position < _textFields.size());
-    _textFields[position] = txt;
+    assert(position < textFieldsCountOf(_type));
+    _textFields[position] = std::move(txt);
 }
 
-void WinToastTemplate::setImagePath(const std::wstring &imgPath) {
-    _imagePath = imgPath;
+void WinToastTemplate::setImagePath(std::wstring_view imgPath) {
+    assign(_imagePath, InternedString(imgPath));
 }
 
-void WinToastTemplate::setAudioPath(const std::wstring &audioPath) {
-    _audioPath = audioPath;
+void WinToastTemplate::setAudioPath(std::wstring_view audioPath) {
+    assign(_audioPath, InternedString(audioPath));
 }
 
 void WinToastTemplate::setAudioPath(AudioSystemFile file) {
-    static const std::unordered_map<AudioSystemFile, std::wstring> Files = {
-            {AudioSystemFile::DefaultSound, L"ms-winsoundevent:Notification.Default"},
-            {AudioSystemFile::IM,           L"ms-winsoundevent:Notification.IM"},
-            {AudioSystemFile::Mail,         L"ms-winsoundevent:Notification.Mail"},
-            {AudioSystemFile::Reminder,     L"ms-winsoundevent:Notification.Reminder"},
-            {AudioSystemFile::SMS,          L"ms-winsoundevent:Notification.SMS"},
-            {AudioSystemFile::Alarm,        L"ms-winsoundevent:Notification.Looping.Alarm"},
-            {AudioSystemFile::Alarm2,       L"ms-winsoundevent:Notification.Looping.Alarm2"},
-            {AudioSystemFile::Alarm3,       L"ms-winsoundevent:Notification.Looping.Alarm3"},
-            {AudioSystemFile::Alarm4,       L"ms-winsoundevent:Notification.Looping.Alarm4"},
-            {AudioSystemFile::Alarm5,       L"ms-winsoundevent:Notification.Looping.Alarm5"},
-            {AudioSystemFile::Alarm6,       L"ms-winsoundevent:Notification.Looping.Alarm6"},
-            {AudioSystemFile::Alarm7,       L"ms-winsoundevent:Notification.Looping.Alarm7"},
-            {AudioSystemFile::Alarm8,       L"ms-winsoundevent:Notification.Looping.Alarm8"},
-            {AudioSystemFile::Alarm9,       L"ms-winsoundevent:Notification.Looping.Alarm9"},
-            {AudioSystemFile::Alarm10,      L"ms-winsoundevent:Notification.Looping.Alarm10"},
-            {AudioSystemFile::Call,         L"ms-winsoundevent:Notification.Looping.Call"},
-            {AudioSystemFile::Call1,        L"ms-winsoundevent:Notification.Looping.Call1"},
-            {AudioSystemFile::Call2,        L"ms-winsoundevent:Notification.Looping.Call2"},
-            {AudioSystemFile::Call3,        L"ms-winsoundevent:Notification.Looping.Call3"},
-            {AudioSystemFile::Call4,        L"ms-winsoundevent:Notification.Looping.Call4"},
-            {AudioSystemFile::Call5,        L"ms-winsoundevent:Notification.Looping.Call5"},
-            {AudioSystemFile::Call6,        L"ms-winsoundevent:Notification.Looping.Call6"},
-            {AudioSystemFile::Call7,        L"ms-winsoundevent:Notification.Looping.Call7"},
-            {AudioSystemFile::Call8,        L"ms-winsoundevent:Notification.Looping.Call8"},
-            {AudioSystemFile::Call9,        L"ms-winsoundevent:Notification.Looping.Call9"},
-            {AudioSystemFile::Call10,       L"ms-winsoundevent:Notification.Looping.Call10"},
-    };
-    const auto iter = Files.find(file);
-    assert(iter != Files.end());
-    _audioPath = iter->second;
+    // Interned once, so picking a system sound never allocates.
+    static const auto Files = [] {
+        std::array<InternedString, std::size(AudioSystemFiles)> files;
+        for (std::size_t i = 0; i < files.size(); i++) {
+            files[i] = InternedString(AudioSystemFiles[i]);
+        }
+        return files;
+    }();
+    const auto index = static_cast<std::size_t>(file);
+    assert(index < Files.size());
+    assign(_audioPath, Files[index]);
 }
 
 void WinToastTemplate::setAudioOption(WinToastTemplate::AudioOption audioOption) {
     _audioOption = audioOption;
 }
 
-void WinToastTemplate::setFirstLine(const std::wstring &text) {
-    setTextField(text, WinToastTemplate::TextField::FirstLine);
+void WinToastTemplate::setFirstLine(std::wstring text) {
+    setTextField(std::move(text), WinToastTemplate::TextField::FirstLine);
 }
 
-void WinToastTemplate::setSecondLine(const std::wstring &text) {
-    setTextField(text, WinToastTemplate::TextField::SecondLine);
+void WinToastTemplate::setSecondLine(std::wstring text) {
+    setTextField(std::move(text), WinToastTemplate::TextField::SecondLine);
 }
 
-void WinToastTemplate::setThirdLine(const std::wstring &text) {
-    setTextField(text, WinToastTemplate::TextField::ThirdLine);
+void WinToastTemplate::setThirdLine(std::wstring text) {
+    setTextField(std::move(text), WinToastTemplate::TextField::ThirdLine);
 }
 
 void WinToastTemplate::setDuration(Duration duration) {
@@ -105,33 +192,22 @@ void WinToastTemplate::setExpiration(INT64 millisecondsFromNow) {
     _expiration = millisecondsFromNow;
 }
 
-void WinToastLib::WinToastTemplate::setScenario(Scenario scenario) {
-    switch (scenario) {
-        case Scenario::Default:
-            _scenario = L"Default";
-            break;
-        case Scenario::Alarm:
-            _scenario = L"Alarm";
-            break;
-        case Scenario::IncomingCall:
-            _scenario = L"IncomingCall";
-            break;
-        case Scenario::Reminder:
-            _scenario = L"Reminder";
-            break;
-    }
+void WinToastTemplate::setScenario(Scenario scenario) {
+    _scenario = scenario;
 }
 
-void WinToastTemplate::setAttributionText(const std::wstring &attributionText) {
-    _attributionText = attributionText;
+void WinToastTemplate::setAttributionText(std::wstring_view attributionText) {
+    assign(_attributionText, InternedString(attributionText));
 }
 
-void WinToastTemplate::addAction(const std::wstring &label) {
-    _actions.push_back(label);
+void WinToastTemplate::addAction(std::wstring_view label) {
+    InternedString action(label);
+    _actions.push_back(nullptr);
+    _actions.back() = action.detach();
 }
 
 std::size_t WinToastTemplate::textFieldsCount() const {
-    return _textFields.size();
+    return textFieldsCountOf(_type);
 }
 
 std::size_t WinToastTemplate::actionsCount() const {
@@ -139,37 +215,54 @@ std::size_t WinToastTemplate::actionsCount() const {
 }
 
 bool WinToastTemplate::hasImage() const {
-    return _type < WinToastTemplateType::Text01;
+    return hasImageOf(_type);
 }
 
-const std::vector<std::wstring> &WinToastTemplate::textFields() const {
-    return _textFields;
+WinToastTemplate::TextFieldsView WinToastTemplate::textFieldsView() const noexcept {
+    return {_textFields.data(), textFieldsCountOf(_type)};
 }
 
-const std::wstring &WinToastTemplate::textField(_In_ TextField pos) const {
+std::vector<std::wstring> WinToastTemplate::textFields() const {
+    const TextFieldsView fields = textFieldsView();
+    return {fields.begin(), fields.end()};
+}
+
+const std::wstring &WinToastTemplate::textField(TextField pos) const {
     const auto position = static_cast<std::size_t>(pos);
-    assert(position < _textFields.size());
+    assert(position < textFieldsCountOf(_type));
     return _textFields[position];
 }
 
-const std::wstring &WinToastTemplate::actionLabel(_In_ std::size_t position) const {
+const std::wstring &WinToastTemplate::actionLabel(std::size_t position) const {
     assert(position < _actions.size());
-    return _actions[position];
+    return InternedString::str(_actions[position]);
 }
 
 const std::wstring &WinToastTemplate::imagePath() const {
-    return _imagePath;
+    return InternedString::str(_imagePath);
 }
 
 const std::wstring &WinToastTemplate::audioPath() const {
-    return _audioPath;
+    return InternedString::str(_audioPath);
 }
 
 const std::wstring &WinToastTemplate::attributionText() const {
-    return _attributionText;
+    return InternedString::str(_attributionText);
 }
 
 const std::wstring &WinToastLib::WinToastTemplate::scenario() const {
+    // The names are interned once, so templates only store the enum.
+    static const auto Names = [] {
+        std::array<InternedString, std::size(ScenarioNames)> names;
+        for (std::size_t i = 0; i < names.size(); i++) {
+            names[i] = InternedString(ScenarioNames[i]);
+        }
+        return names;
+    }();
+    return Names[static_cast<std::size_t>(_scenario)].str();
+}
+
+WinToastTemplate::Scenario WinToastTemplate::scenarioKind() const noexcept {
     return _scenario;
 }
 
@@ -188,3 +281,79 @@ WinToastTemplate::AudioOption WinToastTemplate::audioOption() const {
 WinToastTemplate::Duration WinToastTemplate::duration() const {
     return _duration;
 }
+
+WinToastTemplate::Builder::Builder(WinToastTemplateType type) : _toast(type) {}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::firstLine(std::wstring text) {
+    _toast.setFirstLine(std::move(text));
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::secondLine(std::wstring text) {
+    _toast.setSecondLine(std::move(text));
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::thirdLine(std::wstring text) {
+    _toast.setThirdLine(std::move(text));
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::textField(std::wstring text, TextField pos) {
+    _toast.setTextField(std::move(text), pos);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::attributionText(std::wstring_view attributionText) {
+    _toast.setAttributionText(attributionText);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::imagePath(std::wstring_view imgPath) {
+    _toast.setImagePath(imgPath);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::audioPath(AudioSystemFile audio) {
+    _toast.setAudioPath(audio);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::audioPath(std::wstring_view audioPath) {
+    _toast.setAudioPath(audioPath);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::audioOption(AudioOption audioOption) {
+    _toast.setAudioOption(audioOption);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::duration(Duration duration) {
+    _toast.setDuration(duration);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::expiration(INT64 millisecondsFromNow) {
+    _toast.setExpiration(millisecondsFromNow);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::scenario(Scenario scenario) {
+    _toast.setScenario(scenario);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::reserveActions(std::size_t count) {
+    _toast._actions.reserve(count);
+    return *this;
+}
+
+WinToastTemplate::Builder &WinToastTemplate::Builder::action(std::wstring_view label) {
+    _toast.addAction(label);
+    return *this;
+}
+
+WinToastTemplate WinToastTemplate::Builder::build() {
+    return std::move(_toast);
+}
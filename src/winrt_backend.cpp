@@ -0,0 +1,286 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "winrt_backend.h"
+#include "wintoast_debug.h"
+#include "file_time.h"
+#include "pipeline_stats.h"
+
+#include <winrt/Windows.Foundation.Collections.h>
+
+using namespace WinToastLib;
+using namespace winrt::Windows::UI::Notifications;
+using namespace winrt::Windows::Data::Xml::Dom;
+
+WinRtBackend::WinRtBackend(NotifierFactory notifierFactory)
+        : _notifiers(std::move(notifierFactory)), _live(std::make_shared<ToastRegistry<ToastNotification>>()) {
+}
+
+ToastNotifier WinRtBackend::createNotifier(const std::wstring &aumi) {
+    return ToastNotificationManager::CreateToastNotifier(aumi);
+}
+
+void WinRtBackend::setAppUserModelId(const std::wstring &aumi) {
+    if (_aumi != aumi) {
+        _notifiers.invalidate();
+    }
+    _aumi = aumi;
+}
+
+INT64 WinRtBackend::show(const std::wstring &xml, INT64 expiration, WinToast::WinToastError &error) {
+    ToastNotifier notifier{nullptr};
+    catchAndLogHresult(
+            {
+                WINTOAST_TIME_STAGE(WinToast::Stage::Notifier);
+                notifier = _notifiers.get(_aumi);
+            },
+            "Error in showToast while trying to create a notifier: ",
+            {
+                error = WinToast::WinToastError::UnknownError;
+                return -1;
+            }
+    )
+
+    ToastNotification notification{nullptr};
+    catchAndLogHresult(
+            {
+                WINTOAST_TIME_STAGE(WinToast::Stage::Construct);
+                XmlDocument xmlDocument;
+                xmlDocument.LoadXml(xml);
+                notification = ToastNotification(xmlDocument);
+                if (expiration > 0) {
+                    notification.ExpirationTime(
+                            winrt::Windows::Foundation::DateTime{winrt::Windows::Foundation::TimeSpan(expiration)});
+                }
+            },
+            "Error in showToast while trying to construct the notification: ",
+            {
+                error = WinToast::WinToastError::UnknownError;
+                return -1;
+            }
+    )
+
+    // The slot is taken before showing so a toast that made it to the screen always has an id to hide it with.
+    const std::size_t bytes = sizeof(ToastNotification) + xml.size() * sizeof(wchar_t);
+    INT64 id;
+    {
+        WINTOAST_TIME_STAGE(WinToast::Stage::Register);
+        id = _live->insert(notification, expiration, bytes);
+    }
+    if (id < 0) {
+        TRACE_ERROR(Toast, "Error in showToast, too many live toasts");
+        error = WinToast::WinToastError::UnknownError;
+        return -1;
+    }
+
+    // Once the toast is dismissed, activated or failed there is nothing left to hide.
+    const auto forget = [live = std::weak_ptr(_live), id](auto &&...) {
+        if (const auto registry = live.lock()) {
+            registry->erase(id);
+        }
+    };
+    catchAndLogHresult(
+            {
+                notification.Dismissed(forget);
+                notification.Activated(forget);
+                notification.Failed(forget);
+            },
+            "Error in showToast while subscribing to the toast events: "
+    )
+
+    catchAndLogHresult(
+            {
+                WINTOAST_TIME_STAGE(WinToast::Stage::Show);
+                notifier.Show(notification);
+            },
+            "Error when showing notification: ",
+            {
+                _live->erase(id);
+                error = WinToast::WinToastError::NotDisplayed;
+                return -1;
+            }
+    )
+
+    error = WinToast::WinToastError::NoError;
+    return id;
+}
+
+bool WinRtBackend::hide(INT64 id) {
+    // Taken rather than looked up, so a concurrent hide, eviction or toast event can't act on it too.
+    std::optional<ToastNotification> notification = _live->take(id);
+    if (!notification) {
+        return false;
+    }
+
+    catchAndLogHresult(
+            {
+                ToastNotifier notifier = _notifiers.get(_aumi);
+                notifier.Hide(*notification);
+            },
+            "Error when hiding the toast: ",
+            {
+                // Still on screen, so it must stay hideable by its id.
+                _live->restore(id, std::move(*notification));
+                return false;
+            }
+    )
+    return true;
+}
+
+bool WinRtBackend::isLive(INT64 id) const {
+    return _live->contains(id);
+}
+
+INT64 WinRtBackend::schedule(const std::wstring &xml, INT64 deliveryTime, INT64 expiration,
+                             WinToast::WinToastError &error) {
+    ToastNotifier notifier{nullptr};
+    ScheduledToastNotification notification{nullptr};
+    catchAndLogHresult(
+            {
+                notifier = _notifiers.get(_aumi);
+                XmlDocument xmlDocument;
+                xmlDocument.LoadXml(xml);
+                notification = ScheduledToastNotification(
+                        xmlDocument,
+                        winrt::Windows::Foundation::DateTime{winrt::Windows::Foundation::TimeSpan(deliveryTime)});
+                if (expiration > 0) {
+                    notification.ExpirationTime(
+                            winrt::Windows::Foundation::DateTime{winrt::Windows::Foundation::TimeSpan(expiration)});
+                }
+            },
+            "Error in scheduleToast while trying to construct the notification: ",
+            {
+                error = WinToast::WinToastError::UnknownError;
+                return -1;
+            }
+    )
+
+    catchAndLogHresult(
+            { notifier.AddToSchedule(notification); },
+            "Error when scheduling notification: ",
+            {
+                error = WinToast::WinToastError::NotDisplayed;
+                return -1;
+            }
+    )
+
+    error = WinToast::WinToastError::NoError;
+    return _scheduled.insert(deliveryTime, notification, FileTime::now());
+}
+
+bool WinRtBackend::cancelScheduled(INT64 id) {
+    std::optional<ScheduleIndex<ScheduledToastNotification>::Entry> entry = _scheduled.take(id, FileTime::now());
+    if (!entry) {
+        return false;
+    }
+
+    // A toast the OS still has stays cancellable. One it already showed is forgotten once its due time passes.
+    catchAndLogHresult(
+            { _notifiers.get(_aumi).RemoveFromSchedule(entry->value); },
+            "Error when cancelling a scheduled toast: ",
+            {
+                _scheduled.restore(std::move(*entry));
+                return false;
+            }
+    )
+    return true;
+}
+
+std::size_t WinRtBackend::cancelScheduled(INT64 from, INT64 to) {
+    std::vector<ScheduleIndex<ScheduledToastNotification>::Entry> entries =
+            _scheduled.takeRange(from, to, FileTime::now());
+    std::size_t cancelled = 0;
+    std::size_t next = 0;
+    catchAndLogHresult(
+            {
+                ToastNotifier notifier = _notifiers.get(_aumi);
+                for (; next < entries.size(); next++) {
+                    // The OS may have shown it in the meantime, that doesn't stop the rest.
+                    try {
+                        notifier.RemoveFromSchedule(entries[next].value);
+                        cancelled++;
+                    } catch (const winrt::hresult_error &) {
+                        _scheduled.restore(std::move(entries[next]));
+                    }
+                }
+            },
+            "Error when cancelling scheduled toasts: ",
+            {
+                for (; next < entries.size(); next++) {
+                    _scheduled.restore(std::move(entries[next]));
+                }
+            }
+    )
+    return cancelled;
+}
+
+void WinRtBackend::clear() {
+    const std::vector<ToastNotification> notifications = _live->drain();
+    catchAndLogHresult(
+            {
+                ToastNotifier notifier = _notifiers.get(_aumi);
+                for (const ToastNotification &notification: notifications) {
+                    notifier.Hide(notification);
+                }
+            },
+            "Error when clearing toasts: "
+    )
+}
+
+void WinRtBackend::uninstall() {
+    // From https://github.com/WindowsNotifications/desktop-toasts/blob/master/CPP-WINRT/DesktopToastsCppWinRtApp/DesktopNotificationManagerCompat.cpp
+    // Remove all scheduled notifications (do this first before clearing current notifications)
+    ToastNotifier notifier{nullptr};
+    catchAndLogHresult(
+            { notifier = _notifiers.get(_aumi); },
+            "Error in uninstall while trying to create a notifier: ",
+            { return; }
+    )
+    auto scheduledNotifications = notifier.GetScheduledToastNotifications();
+    UINT vectorSize = scheduledNotifications.Size();
+    for (UINT i = 0; i < vectorSize; i++) {
+        try {
+            notifier.RemoveFromSchedule(scheduledNotifications.GetAt(i));
+        }
+        catch (...) {}
+    }
+
+    _scheduled.drain();
+
+    // Clear all current notifications
+    ToastNotificationManager::History().Clear(_aumi);
+    _live->drain();
+}
+
+void WinRtBackend::setLiveToastLimit(std::size_t limit) {
+    _live->setLimit(limit);
+}
+
+WinToast::LiveToastStats WinRtBackend::liveToastStats() const {
+    return _live->stats();
+}
+
+std::uint64_t WinRtBackend::notifierCacheHits() const noexcept {
+    return _notifiers.hits();
+}
+
+std::uint64_t WinRtBackend::notifierCacheMisses() const noexcept {
+    return _notifiers.misses();
+}
@@ -0,0 +1,83 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_WINRT_BACKEND_H
+#define WINTOAST_WINRT_BACKEND_H
+
+#include <Windows.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Data.Xml.Dom.h>
+#include <winrt/Windows.UI.Notifications.h>
+
+#include <memory>
+
+#include "toast_backend.h"
+#include "notifier_cache.h"
+#include "toast_registry.h"
+#include "schedule_index.h"
+
+namespace WinToastLib {
+
+    // The default backend, delivering toasts through the Windows notification platform.
+    class WinRtBackend : public ToastBackend {
+    public:
+        using NotifierFactory = NotifierCache<winrt::Windows::UI::Notifications::ToastNotifier>::Factory;
+
+        explicit WinRtBackend(NotifierFactory notifierFactory = createNotifier);
+
+        void setAppUserModelId(const std::wstring &aumi) override;
+
+        INT64 show(const std::wstring &xml, INT64 expiration, WinToast::WinToastError &error) override;
+
+        bool hide(INT64 id) override;
+
+        [[nodiscard]] bool isLive(INT64 id) const override;
+
+        INT64 schedule(const std::wstring &xml, INT64 deliveryTime, INT64 expiration,
+                       WinToast::WinToastError &error) override;
+
+        bool cancelScheduled(INT64 id) override;
+
+        std::size_t cancelScheduled(INT64 from, INT64 to) override;
+
+        void clear() override;
+
+        void uninstall() override;
+
+        void setLiveToastLimit(std::size_t limit) override;
+
+        [[nodiscard]] WinToast::LiveToastStats liveToastStats() const override;
+
+        [[nodiscard]] std::uint64_t notifierCacheHits() const noexcept;
+
+        [[nodiscard]] std::uint64_t notifierCacheMisses() const noexcept;
+
+    private:
+        static winrt::Windows::UI::Notifications::ToastNotifier createNotifier(const std::wstring &aumi);
+
+        std::wstring _aumi;
+        NotifierCache<winrt::Windows::UI::Notifications::ToastNotifier> _notifiers;
+        // Shared with the event handlers of the live toasts, which drop their entry once the toast is gone.
+        std::shared_ptr<ToastRegistry<winrt::Windows::UI::Notifications::ToastNotification>> _live;
+        ScheduleIndex<winrt::Windows::UI::Notifications::ScheduledToastNotification> _scheduled;
+    };
+}
+
+#endif //WINTOAST_WINRT_BACKEND_H
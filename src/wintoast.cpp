@@ -24,6 +24,7 @@
 #include <cassert>
 
 #include "wintoast_impl.h"
+#include "trace.h"
 
 namespace WinToastLib::WinToast {
 
@@ -37,7 +38,8 @@ namespace WinToastLib::WinToast {
                 {WinToastError::InvalidAppUserModelID, L"The AUMI is not a valid one"},
                 {WinToastError::InvalidParameters,     L"The parameters used to configure the library are not valid normally because an invalid AUMI or App Name"},
                 {WinToastError::NotDisplayed,          L"The toast was created correctly but WinToast was not able to display the toast"},
-                {WinToastError::UnknownError,          L"Unknown error"}
+                {WinToastError::UnknownError,          L"Unknown error"},
+                {WinToastError::DeadlineExpired,       L"The deadline of the toast passed before it could be shown"}
         };
 
         const auto iter = Labels.find(error);
@@ -65,12 +67,32 @@ namespace WinToastLib::WinToast {
         WinToastImpl::setShortcutPolicy(shortcutPolicy);
     }
 
+    void setOnActivated(const std::function<void(const WinToastActivation &)> &callback) {
+        WinToastImpl::setOnActivated(callback);
+    }
+
     void setOnActivated(
             const std::function<void(const WinToastArguments &,
                                      const std::map<std::wstring, std::wstring> &)> &callback) {
         WinToastImpl::setOnActivated(callback);
     }
 
+    void setActivationDispatch(std::size_t workers, std::size_t queueCapacity) {
+        WinToastImpl::setActivationDispatch(workers, queueCapacity);
+    }
+
+    ActivationDispatchStats activationDispatchStats() {
+        return WinToastImpl::activationDispatchStats();
+    }
+
+    void setLiveToastLimit(std::size_t limit) {
+        WinToastImpl::setLiveToastLimit(limit);
+    }
+
+    LiveToastStats liveToastStats() {
+        return WinToastImpl::liveToastStats();
+    }
+
     bool isCompatible() {
         return WinToastImpl::isCompatible();
     }
@@ -122,6 +144,77 @@ namespace WinToastLib::WinToast {
         return WinToastImpl::showToast(toast, error);
     }
 
+    void setDeduplicationWindow(std::chrono::milliseconds window) {
+        WinToastImpl::setDeduplicationWindow(window);
+    }
+
+    std::uint64_t suppressedDuplicates() {
+        return WinToastImpl::suppressedDuplicates();
+    }
+
+    WinToastAsync<ShowResult> showToastAsync(WinToastTemplate toast) {
+        return WinToastImpl::showToastAsync(std::move(toast));
+    }
+
+    WinToastAsync<ShowResult> showToastAsync(WinToastTemplate toast,
+                                             std::chrono::steady_clock::time_point deadline) {
+        return WinToastImpl::showToastAsync(std::move(toast), deadline);
+    }
+
+    WinToastAsync<bool> hideToastAsync(INT64 id) {
+        return WinToastImpl::hideToastAsync(id);
+    }
+
+    void setSubmissionPriorities(bool enabled) {
+        WinToastImpl::setSubmissionPriorities(enabled);
+    }
+
+    SubmissionStats submissionStats() {
+        return WinToastImpl::submissionStats();
+    }
+
+    Stats stats() {
+        return WinToastImpl::stats();
+    }
+
+    void setTraceSink(std::function<void(const TraceRecord &)> sink) {
+        Trace::setSink(std::move(sink));
+    }
+
+    void setTraceFilter(TraceLevel level, std::uint32_t categories) {
+        Trace::setFilter(level, categories);
+    }
+
+    void flushTrace() {
+        Trace::flush();
+    }
+
+    std::uint64_t droppedTraceRecords() {
+        return Trace::dropped();
+    }
+
+    INT64 scheduleToast(const WinToastTemplate &toast, std::chrono::system_clock::time_point deliveryTime,
+                        WinToastError *error) {
+        return WinToastImpl::scheduleToast(toast, deliveryTime, error);
+    }
+
+    bool cancelScheduled(INT64 id) {
+        return WinToastImpl::cancelScheduled(id);
+    }
+
+    std::size_t cancelScheduled(std::chrono::system_clock::time_point from,
+                                std::chrono::system_clock::time_point to) {
+        return WinToastImpl::cancelScheduled(from, to);
+    }
+
+    std::vector<ShowResult> showToasts(const WinToastTemplate *toasts, std::size_t count) {
+        return WinToastImpl::showToasts(toasts, count);
+    }
+
+    std::vector<ShowResult> showToasts(const std::vector<WinToastTemplate> &toasts) {
+        return WinToastImpl::showToasts(toasts.data(), toasts.size());
+    }
+
     bool hideToast(INT64 id) {
         return WinToastImpl::hideToast(id);
     }
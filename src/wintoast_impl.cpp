@@ -19,24 +19,25 @@
  */
 
 #include "wintoast_impl.h"
+#include "wintoast_debug.h"
+#include "winrt_backend.h"
+#include "pipeline_stats.h"
 
 #include <ShObjIdl.h>
-#include <strsafe.h>
 #include <Psapi.h>
 #include <propvarutil.h>
 #include <functiondiscoverykeys.h>
 #include <VersionHelpers.h>
 #include <NotificationActivationCallback.h>
 #include <winrt/Windows.Foundation.h>
-#include <winrt/Windows.Data.Xml.Dom.h>
-#include <winrt/Windows.UI.Notifications.h>
-#include <winrt/Windows.Foundation.Collections.h>
 
 #include <map>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <string_view>
 
 #pragma comment(lib, "shlwapi")
@@ -44,41 +45,11 @@
 #pragma comment(lib, "user32")
 #pragma comment(lib, "windowsapp")
 
-#ifdef NDEBUG
-#define DEBUG_MSG(str)
-#define DEBUG_ERR(str)
-#else
-#define DEBUG_MSG(str) std::wcout << str << std::endl
-#define DEBUG_ERR(str) std::wcerr << str << std::endl
-#endif
-
 #define DEFAULT_SHELL_LINKS_PATH    L"\\Microsoft\\Windows\\Start Menu\\Programs\\"
 #define DEFAULT_LINK_FORMAT            L".lnk"
 #define STATUS_SUCCESS (0x00000000)
 
-#define catchAndLogHresult_2(execute, logPrefix) \
-try {                                                     \
-    execute                                               \
-} catch (winrt::hresult_error const &ex) {                \
-    DEBUG_ERR(logPrefix << ex.message().c_str());         \
-}
-#define catchAndLogHresult_3(execute, logPrefix, onError) \
-try {                                                     \
-    execute                                               \
-} catch (winrt::hresult_error const &ex) {                \
-    DEBUG_ERR(logPrefix << ex.message().c_str());         \
-    onError                                               \
-}
-
-#define FUNC_CHOOSER(_f1, _f2, _f3, _f4, ...) _f4
-#define FUNC_RECOMPOSER(argsWithParentheses) FUNC_CHOOSER argsWithParentheses
-#define CHOOSE_FROM_ARG_COUNT(...) FUNC_RECOMPOSER((__VA_ARGS__, catchAndLogHresult_3, catchAndLogHresult_2, MISSING_PARAMETERS, MISSING_PARAMETERS))
-#define MACRO_CHOOSER(...) CHOOSE_FROM_ARG_COUNT(__VA_ARGS__)
-#define catchAndLogHresult(...) MACRO_CHOOSER(__VA_ARGS__)(__VA_ARGS__)
-
 using namespace WinToastLib;
-using namespace winrt::Windows::UI::Notifications;
-using namespace winrt::Windows::Data::Xml::Dom;
 
 bool WinToastImpl::_isInitialized{false};
 bool WinToastImpl::_hasCoInitialized{false};
@@ -88,9 +59,9 @@ std::wstring WinToastImpl::_aumi;
 std::wstring WinToastImpl::_clsid;
 std::wstring WinToastImpl::_iconPath;
 std::wstring WinToastImpl::_iconBackgroundColor;
-std::map<INT64, winrt::Windows::UI::Notifications::ToastNotification> WinToastImpl::_buffer;
-std::function<void(const WinToastArguments &,
-                   const std::map<std::wstring, std::wstring> &)> WinToastImpl::_onActivated;
+ToastPipeline WinToastImpl::_pipeline{std::make_unique<WinRtBackend>()};
+std::shared_ptr<const WinToastImpl::ActivationHandler> WinToastImpl::_onActivated;
+std::shared_ptr<ActivationDispatcher> WinToastImpl::_activationDispatcher;
 
 struct prop_variant : PROPVARIANT {
     prop_variant() noexcept: PROPVARIANT{} {
@@ -125,35 +96,6 @@ namespace Util {
         return rovi;
     }
 
-    inline INT64 fileTimeNow() {
-        FILETIME now;
-        GetSystemTimeAsFileTime(&now);
-        return ((((INT64) now.dwHighDateTime) << 32) | now.dwLowDateTime);
-    }
-
-    inline ToastTemplateType getToastTemplateType(const WinToastTemplate::WinToastTemplateType type) {
-        switch (type) {
-            case WinToastTemplate::WinToastTemplateType::ImageAndText01:
-                return ToastTemplateType::ToastImageAndText01;
-            case WinToastTemplate::WinToastTemplateType::ImageAndText02:
-                return ToastTemplateType::ToastImageAndText02;
-            case WinToastTemplate::WinToastTemplateType::ImageAndText03:
-                return ToastTemplateType::ToastImageAndText03;
-            case WinToastTemplate::WinToastTemplateType::ImageAndText04:
-                return ToastTemplateType::ToastImageAndText04;
-            case WinToastTemplate::WinToastTemplateType::Text01:
-                return ToastTemplateType::ToastText01;
-            case WinToastTemplate::WinToastTemplateType::Text02:
-                return ToastTemplateType::ToastText02;
-            case WinToastTemplate::WinToastTemplateType::Text03:
-                return ToastTemplateType::ToastText03;
-            case WinToastTemplate::WinToastTemplateType::Text04:
-                return ToastTemplateType::ToastText04;
-            default:
-                winrt::throw_hresult(E_INVALIDARG);
-        }
-    }
-
     std::wstring generateGuid(const std::wstring &name) {
         // From https://github.com/WindowsNotifications/desktop-toasts/blob/master/CPP-WINRT/DesktopToastsCppWinRtApp/DesktopNotificationManagerCompat.cpp
         wchar_t const *bytes = name.c_str();
@@ -205,7 +147,7 @@ namespace Util {
 
     inline void defaultExecutablePath(_In_ WCHAR *path, _In_ DWORD nSize = MAX_PATH) {
         DWORD written = GetModuleFileNameExW(GetCurrentProcess(), nullptr, path, nSize);
-        DEBUG_MSG("Default executable path: " << path);
+        TRACE_DEBUG(Setup, "Default executable path: " << path);
         if (!written)
             throw winrt::hresult_error(E_FAIL, L"GetModuleFileNameExW failed for getting the executable path");
     }
@@ -220,7 +162,7 @@ namespace Util {
             throw winrt::hresult_error(E_FAIL,
                                        L"wcscat_s failed for appending the default shell links path to the APPDATA path");
 
-        DEBUG_MSG("Default shell link path: " << path);
+        TRACE_DEBUG(Setup, "Default shell link path: " << path);
     }
 
     inline void defaultShellLinkPath(const std::wstring &appname, _In_ WCHAR *path, _In_ DWORD nSize = MAX_PATH) {
@@ -233,16 +175,7 @@ namespace Util {
                                        L"wcscat_s failed for appending the app link file name "
                                        L"to the default shell links path");
 
-        DEBUG_MSG("Default shell link file path: " << path);
-    }
-
-    inline XmlElement
-    createElement(_In_ XmlDocument xml, _In_ const std::wstring &root_node, _In_ const std::wstring &element_name) {
-        IXmlNode root = xml.SelectSingleNode(L"//" + root_node + L"[1]");
-        XmlElement element = xml.CreateElement(element_name);
-        root.AppendChild(element);
-
-        return element;
+        TRACE_DEBUG(Setup, "Default shell link file path: " << path);
     }
 
     inline void setRegistryKeyValue(HKEY hKey, const std::wstring &subKey, const std::wstring &valueName,
@@ -270,6 +203,11 @@ namespace Util {
     }
 }
 
+static_assert(sizeof(WinToastUserInput) == sizeof(NOTIFICATION_USER_INPUT_DATA) &&
+              offsetof(WinToastUserInput, key) == offsetof(NOTIFICATION_USER_INPUT_DATA, Key) &&
+              offsetof(WinToastUserInput, value) == offsetof(NOTIFICATION_USER_INPUT_DATA, Value),
+              "WinToastUserInput must match the layout of NOTIFICATION_USER_INPUT_DATA");
+
 // https://docs.microsoft.com/en-us/windows/uwp/cpp-and-winrt-apis/author-coclasses#implement-the-coclass-and-class-factory
 struct WinToastImpl::callback : winrt::implements<callback, INotificationActivationCallback> {
     HRESULT __stdcall Activate(
@@ -277,24 +215,25 @@ struct WinToastImpl::callback : winrt::implements<callback, INotificationActivat
             LPCWSTR invokedArgs,
             [[maybe_unused]] NOTIFICATION_USER_INPUT_DATA const *data,
             [[maybe_unused]] ULONG dataCount) noexcept {
-        if (_onActivated != nullptr) {
-            try {
-                WinToastArguments arguments(invokedArgs);
+        if (!std::atomic_load(&_onActivated)) {
+            return S_OK;
+        }
 
-                std::map<std::wstring, std::wstring> userInput;
+        const std::wstring_view arguments = invokedArgs ? invokedArgs : L"";
+        const auto userInput = reinterpret_cast<const WinToastUserInput *>(data);
 
-                for (int i = 0; i < dataCount; i++) {
-                    userInput[data[i].Key] = data[i].Value;
+        if (const auto dispatcher = std::atomic_load(&_activationDispatcher)) {
+            try {
+                if (!dispatcher->dispatch(arguments, userInput, dataCount)) {
+                    TRACE_WARNING(Activation, "Activation dropped, the dispatch queue is full");
                 }
-
-                _onActivated(arguments, userInput);
-            } catch (const winrt::hresult_error &ex) {
-                DEBUG_ERR("Error in Activate callback: " << ex.message().c_str());
             } catch (const std::exception &ex) {
-                DEBUG_ERR("Error in Activate callback: " << ex.what());
+                TRACE_ERROR(Activation, "Error dispatching activation: " << ex.what());
             }
+            return S_OK;
         }
 
+        invokeOnActivated(WinToastActivation(arguments, userInput, dataCount));
         return S_OK;
     }
 };
@@ -330,7 +269,8 @@ void WinToastImpl::setAppName(const std::wstring &appName) {
 
 void WinToastImpl::setAppUserModelId(const std::wstring &aumi) {
     _aumi = aumi;
-    DEBUG_MSG("App User Model Id: " << _aumi.c_str());
+    _pipeline.setAppUserModelId(_aumi);
+    TRACE_DEBUG(Setup, "App User Model Id: " << _aumi.c_str());
 }
 
 void WinToastImpl::WinToastImpl::setIconPath(const std::wstring &iconPath) {
@@ -345,10 +285,70 @@ void WinToastImpl::setShortcutPolicy(WinToast::ShortcutPolicy shortcutPolicy) {
     _shortcutPolicy = shortcutPolicy;
 }
 
+void WinToastImpl::setBackend(std::unique_ptr<ToastBackend> backend) {
+    _pipeline.setBackend(backend ? std::move(backend) : std::make_unique<WinRtBackend>());
+}
+
+void WinToastImpl::setOnActivated(const std::function<void(const WinToastActivation &)> &callback) {
+    std::shared_ptr<const ActivationHandler> handler;
+    if (callback) {
+        handler = std::make_shared<const ActivationHandler>(callback);
+    }
+    std::atomic_store(&_onActivated, std::move(handler));
+}
+
 void WinToastImpl::setOnActivated(
         const std::function<void(const WinToastArguments &,
                                  const std::map<std::wstring, std::wstring> &)> &callback) {
-    _onActivated = callback;
+    if (!callback) {
+        std::atomic_store(&_onActivated, std::shared_ptr<const ActivationHandler>());
+        return;
+    }
+
+    std::atomic_store(&_onActivated, std::make_shared<const ActivationHandler>(
+            [callback](const WinToastActivation &activation) {
+                const WinToastActivation::Data data = activation.materialize();
+                callback(data.arguments, data.userInput);
+            }));
+}
+
+void WinToastImpl::invokeOnActivated(const WinToastActivation &activation) noexcept {
+    try {
+        // One copy per call, a handler replaced meanwhile stays alive until this one returns.
+        if (const auto handler = std::atomic_load(&_onActivated)) {
+            (*handler)(activation);
+        }
+    } catch (const winrt::hresult_error &ex) {
+        TRACE_ERROR(Activation, "Error in Activate callback: " << ex.message().c_str());
+    } catch (const std::exception &ex) {
+        TRACE_ERROR(Activation, "Error in Activate callback: " << ex.what());
+    }
+}
+
+void WinToastImpl::setActivationDispatch(std::size_t workers, std::size_t queueCapacity) {
+    std::shared_ptr<ActivationDispatcher> dispatcher;
+    if (workers > 0) {
+        dispatcher = std::make_shared<ActivationDispatcher>(workers, queueCapacity, &WinToastImpl::invokeOnActivated);
+    }
+
+    // The previous dispatcher drains its queues and joins its workers on the retirement thread, this may well be
+    // one of its workers if an activation handler changes the dispatch.
+    ActivationDispatcher::retire(std::atomic_exchange(&_activationDispatcher, std::move(dispatcher)));
+}
+
+WinToast::ActivationDispatchStats WinToastImpl::activationDispatchStats() {
+    if (const auto dispatcher = std::atomic_load(&_activationDispatcher)) {
+        return dispatcher->stats();
+    }
+    return {};
+}
+
+void WinToastImpl::setLiveToastLimit(std::size_t limit) {
+    _pipeline.setLiveToastLimit(limit);
+}
+
+WinToast::LiveToastStats WinToastImpl::liveToastStats() {
+    return _pipeline.liveToastStats();
 }
 
 bool WinToastImpl::isCompatible() {
@@ -374,7 +374,7 @@ std::wstring WinToastImpl::configureAUMI(const std::wstring &companyName,
     }
 
     if (aumi.length() > SCHAR_MAX) {
-        DEBUG_ERR("Error: max size allowed for AUMI: 128 characters.");
+        TRACE_ERROR(Setup, "Error: max size allowed for AUMI: 128 characters.");
     }
     return aumi;
 }
@@ -461,12 +461,12 @@ void WinToastImpl::createShellLinkHelper() {
 
 WinToast::ShortcutResult WinToastImpl::createShortcut() {
     if (_aumi.empty() || _appName.empty()) {
-        DEBUG_ERR(L"Error: App User Model Id or Appname is empty!");
+        TRACE_ERROR(Setup, L"Error: App User Model Id or Appname is empty!");
         return WinToast::ShortcutResult::SHORTCUT_MISSING_PARAMETERS;
     }
 
     if (!isCompatible()) {
-        DEBUG_ERR(L"Your OS is not compatible with this library! =(");
+        TRACE_ERROR(Setup, L"Your OS is not compatible with this library! =(");
         return WinToast::ShortcutResult::SHORTCUT_INCOMPATIBLE_OS;
     }
 
@@ -525,14 +525,14 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
 
     if (!isCompatible()) {
         setError(error, WinToast::WinToastError::SystemNotSupported);
-        DEBUG_ERR(L"Error: system not supported.");
+        TRACE_ERROR(Setup, L"Error: system not supported.");
         _isInitialized = false;
         return false;
     }
 
     if (_aumi.empty() || _appName.empty()) {
         setError(error, WinToast::WinToastError::InvalidParameters);
-        DEBUG_ERR(L"Error while initializing, did you set up a valid AUMI and App name?");
+        TRACE_ERROR(Setup, L"Error while initializing, did you set up a valid AUMI and App name?");
         _isInitialized = false;
         return false;
     }
@@ -555,7 +555,7 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
     if (_shortcutPolicy != WinToast::ShortcutPolicy::SHORTCUT_POLICY_IGNORE) {
         if ((int) createShortcut() < 0) {
             setError(error, WinToast::WinToastError::ShellLinkNotCreated);
-            DEBUG_ERR(L"Error while attaching the AUMI to the current proccess =(");
+            TRACE_ERROR(Setup, L"Error while attaching the AUMI to the current proccess =(");
             _isInitialized = false;
             return false;
         }
@@ -563,7 +563,7 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
 
     if (FAILED(SetCurrentProcessExplicitAppUserModelID(_aumi.c_str()))) {
         setError(error, WinToast::WinToastError::InvalidAppUserModelID);
-        DEBUG_ERR(L"Error while attaching the AUMI to the current proccess =(");
+        TRACE_ERROR(Setup, L"Error while attaching the AUMI to the current proccess =(");
         _isInitialized = false;
         return false;
     }
@@ -591,7 +591,7 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
                     try {
                         Util::deleteRegistryKeyValue(HKEY_CURRENT_USER, subKey, L"IconUri");
                     } catch (const winrt::hresult_error &ex) {
-                        DEBUG_MSG(
+                        TRACE_DEBUG(Setup,
                                 "Failed to delete IconUri registry key. Probably iconUri wasn't set before.\n\tError message: "
                                         << ex.message().c_str());
                     }
@@ -606,7 +606,7 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
                     try {
                         Util::deleteRegistryKeyValue(HKEY_CURRENT_USER, subKey, L"IconBackgroundColor");
                     } catch (const winrt::hresult_error &ex) {
-                        DEBUG_MSG(
+                        TRACE_DEBUG(Setup,
                                 "Failed to delete IconBackgroundColor registry key. Probably iconBackgroundColor wasn't set before.\n\tError message: "
                                         << ex.message().c_str());
                     }
@@ -626,27 +626,9 @@ bool WinToastImpl::initialize(WinToast::WinToastError *error) {
 }
 
 void WinToastImpl::uninstall() {
-    // From https://github.com/WindowsNotifications/desktop-toasts/blob/master/CPP-WINRT/DesktopToastsCppWinRtApp/DesktopNotificationManagerCompat.cpp
     if (!_aumi.empty()) {
         try {
-            // Remove all scheduled notifications (do this first before clearing current notifications)
-            ToastNotifier notifier{nullptr};
-            catchAndLogHresult(
-                    { notifier = ToastNotificationManager::CreateToastNotifier(_aumi); },
-                    "Error in showToast while trying to create a notifier: ",
-                    { return; }
-            )
-            auto scheduledNotifications = notifier.GetScheduledToastNotifications();
-            UINT vectorSize = scheduledNotifications.Size();
-            for (UINT i = 0; i < vectorSize; i++) {
-                try {
-                    notifier.RemoveFromSchedule(scheduledNotifications.GetAt(i));
-                }
-                catch (...) {}
-            }
-
-            // Clear all current notifications
-            ToastNotificationManager::History().Clear(_aumi);
+            _pipeline.uninstall();
 
             std::wstring subKey = LR"(SOFTWARE\Classes\AppUserModelId\)" + _aumi;
             Util::deleteRegistryKey(HKEY_CURRENT_USER, subKey);
@@ -681,275 +663,120 @@ const std::wstring &WinToastImpl::iconBackgroundColor() {
     return _iconBackgroundColor;
 }
 
-//
-// Available as of Windows 10 Anniversary Update
-// Ref: https://docs.microsoft.com/en-us/windows/uwp/design/shell/tiles-and-notifications/adaptive-interactive-toasts
-//
-// NOTE: This will add a new text field, so be aware when iterating over
-//       the toast's text fields or getting a count of them.
-//
-void WinToastImpl::setAttributionTextFieldHelper(XmlDocument xml, const std::wstring &text) {
-    XmlElement attributionElement = Util::createElement(xml, L"binding", L"text");
-    attributionElement.SetAttribute(L"placement", L"attribution");
-    attributionElement.InnerText(text);
-}
+INT64 WinToastImpl::showToast(const WinToastTemplate &toast, WinToast::WinToastError *error) {
+    setError(error, WinToast::WinToastError::NoError);
+    if (!isInitialized()) {
+        setError(error, WinToast::WinToastError::NotInitialized);
+        TRACE_ERROR(Toast, "Error when launching the toast. WinToast is not initialized.");
+        return -1;
+    }
 
-void WinToastImpl::setImageFieldHelper(XmlDocument xml, const std::wstring &path) {
-    assert(path.size() < MAX_PATH);
+    // Modern feature are supported Windows > Windows 10
+    const bool modernFeatures = isSupportingModernFeatures();
+    if (!modernFeatures) {
+        TRACE_INFO(Toast, "Modern features (Actions/Sounds/Attributes) not supported in this os version");
+    }
 
-    wchar_t imagePath[MAX_PATH] = L"file:///";
-    winrt::check_hresult(StringCchCatW(imagePath, MAX_PATH, path.c_str()));
-    XmlElement imageElement = xml.SelectSingleNode(L"//image[1]").as<XmlElement>();
-    imageElement.SetAttribute(L"src", imagePath);
+    WinToast::WinToastError result = WinToast::WinToastError::NoError;
+    const INT64 id = _pipeline.show(toast, modernFeatures, result);
+    setError(error, result);
+    return id;
 }
 
-void
-WinToastImpl::setAudioFieldHelper(XmlDocument xml, const std::wstring &path, WinToastTemplate::AudioOption option) {
-    Util::createElement(xml, L"toast", L"audio");
+void WinToastImpl::setDeduplicationWindow(std::chrono::milliseconds window) {
+    _pipeline.setDeduplicationWindow(window);
+}
 
-    XmlElement audioElement = xml.SelectSingleNode(L"//audio[1]").as<XmlElement>();
+std::uint64_t WinToastImpl::suppressedDuplicates() {
+    return _pipeline.suppressedDuplicates();
+}
 
-    if (!path.empty()) {
-        audioElement.SetAttribute(L"src", path);
-    }
+WinToastAsync<WinToast::ShowResult> WinToastImpl::showToastAsync(WinToastTemplate toast,
+                                                                 std::optional<AsyncSubmitter::Clock::time_point>
+                                                                 deadline) {
+    return submitter().show(std::move(toast), deadline);
+}
 
-    switch (option) {
-        case WinToastTemplate::AudioOption::Loop:
-            audioElement.SetAttribute(L"loop", L"true");
-            break;
-        case WinToastTemplate::AudioOption::Silent:
-            audioElement.SetAttribute(L"silent", L"true");
-        default:
-            break;
-    }
+WinToastAsync<bool> WinToastImpl::hideToastAsync(INT64 id) {
+    return submitter().hide(id);
 }
 
-void WinToastImpl::addActionHelper(XmlDocument xml, const std::wstring &content, const std::wstring &arguments) {
-    XmlElement actionsElement = xml.SelectSingleNode(L"//actions[1]").as<XmlElement>();
+void WinToastImpl::setSubmissionPriorities(bool enabled) {
+    submitter().setPrioritized(enabled);
+}
 
-    if (!actionsElement) {
-        XmlElement toastElement = xml.SelectSingleNode(L"//toast[1]").as<XmlElement>();
-        toastElement.SetAttribute(L"template", L"ToastGeneric");
-        toastElement.SetAttribute(L"duration", L"long");
+WinToast::SubmissionStats WinToastImpl::submissionStats() {
+    return submitter().stats();
+}
 
-        actionsElement = xml.CreateElement(L"actions");
-        toastElement.AppendChild(actionsElement);
-    }
+WinToast::Stats WinToastImpl::stats() {
+    return PipelineStats::snapshot();
+}
 
-    XmlElement actionElement = xml.CreateElement(L"action");
-    actionElement.SetAttribute(L"content", content);
-    actionElement.SetAttribute(L"arguments", arguments);
-    actionsElement.AppendChild(actionElement);
+AsyncSubmitter &WinToastImpl::submitter() {
+    static AsyncSubmitter submitter({
+            [](const WinToastTemplate &toast, WinToast::WinToastError *error) { return showToast(toast, error); },
+            [](INT64 id) { return hideToast(id); }
+    });
+    return submitter;
 }
 
-INT64 WinToastImpl::showToast(const WinToastTemplate &toast, WinToast::WinToastError *error) {
+INT64 WinToastImpl::scheduleToast(const WinToastTemplate &toast, std::chrono::system_clock::time_point deliveryTime,
+                                  WinToast::WinToastError *error) {
     setError(error, WinToast::WinToastError::NoError);
-    INT64 id = 0;
     if (!isInitialized()) {
         setError(error, WinToast::WinToastError::NotInitialized);
-        DEBUG_ERR("Error when launching the toast. WinToast is not initialized.");
+        TRACE_ERROR(Schedule, "Error when scheduling the toast. WinToast is not initialized.");
         return -1;
     }
 
-    ToastNotifier notifier{nullptr};
-    catchAndLogHresult(
-            { notifier = ToastNotificationManager::CreateToastNotifier(_aumi); },
-            "Error in showToast while trying to create a notifier: ",
-            {
-                setError(error, WinToast::WinToastError::UnknownError);
-                return -1;
-            }
-    )
-    XmlDocument xmlDocument{nullptr};
-    catchAndLogHresult(
-            {
-                xmlDocument = ToastNotificationManager::GetTemplateContent(
-                        Util::getToastTemplateType(toast.type())
-                );
-            },
-            "Error in showToast while getting template content: ",
-            {
-                setError(error, WinToast::WinToastError::UnknownError);
-                return -1;
-            }
-    )
-    catchAndLogHresult(
-            {
-                XmlNodeList textFields = xmlDocument.GetElementsByTagName(L"text");
-
-                for (UINT32 i = 0, fieldsCount = static_cast<UINT32>(toast.textFieldsCount());
-                     i < fieldsCount; i++) {
-                    textFields.Item(i).InnerText(toast.textField(WinToastTemplate::TextField(i)));
-                }
-            },
-            "Error in showToast while setting text fields: ",
-            {
-                setError(error, WinToast::WinToastError::UnknownError);
-                return -1;
-            }
-    )
-
-    // Modern feature are supported Windows > Windows 10
-    if (isSupportingModernFeatures()) {
-
-        // Note that we do this *after* using toast.textFieldsCount() to
-        // iterate/fill the template's text fields, since we're adding yet another text field.
-        if (!toast.attributionText().empty()) {
-            catchAndLogHresult(
-                    { setAttributionTextFieldHelper(xmlDocument, toast.attributionText()); },
-                    "Error in setAttributionTextFieldHelper: ",
-                    {
-                        setError(error, WinToast::WinToastError::UnknownError);
-                        return -1;
-                    }
-            )
-        }
-
-        catchAndLogHresult(
-                {
-                    for (std::size_t i = 0, actionsCount = toast.actionsCount(); i < actionsCount; i++) {
-                        WinToastArguments winToastArguments;
-
-                        winToastArguments[L"actionId"] = std::to_wstring(i);
-                        addActionHelper(xmlDocument, toast.actionLabel(i), winToastArguments.toString());
-                    }
-                },
-                "Error in addActionHelper: ",
-                {
-                    setError(error, WinToast::WinToastError::UnknownError);
-                    return -1;
-                }
-        )
-
-        if (toast.audioPath().empty() && toast.audioOption() == WinToastTemplate::AudioOption::Default) {
-            catchAndLogHresult(
-                    { setAudioFieldHelper(xmlDocument, toast.audioPath(), toast.audioOption()); },
-                    "Error in setAudioFieldHelper: ",
-                    {
-                        setError(error, WinToast::WinToastError::UnknownError);
-                        return -1;
-                    }
-            )
-        }
-
-        auto toastElement = xmlDocument.SelectSingleNode(L"//toast[1]").as<XmlElement>();
-
-        if (toast.duration() != WinToastTemplate::Duration::System) {
-            catchAndLogHresult(
-                    {
-                        toastElement.SetAttribute(L"duration",
-                                                  (toast.duration() == WinToastTemplate::Duration::Short) ? L"short"
-                                                                                                          : L"long");
-                    },
-                    "Error in showToast while setting duration: ",
-                    {
-                        setError(error, WinToast::WinToastError::UnknownError);
-                        return -1;
-                    }
-            )
-        }
-
-        catchAndLogHresult(
-                { toastElement.SetAttribute(L"scenario", toast.scenario()); },
-                "Error in showToast while setting scenario: ",
-                {
-                    setError(error, WinToast::WinToastError::UnknownError);
-                    return -1;
-                }
-        )
+    WinToast::WinToastError result = WinToast::WinToastError::NoError;
+    const INT64 id = _pipeline.schedule(toast, deliveryTime, isSupportingModernFeatures(), result);
+    setError(error, result);
+    return id;
+}
 
-    } else {
-        DEBUG_MSG("Modern features (Actions/Sounds/Attributes) not supported in this os version");
+bool WinToastImpl::cancelScheduled(INT64 id) {
+    if (!_isInitialized) {
+        TRACE_ERROR(Schedule, "Error when cancelling a scheduled toast. WinToast is not initialized.");
+        return false;
     }
+    return _pipeline.cancelScheduled(id);
+}
 
-    if (toast.hasImage()) {
-        catchAndLogHresult(
-                { setImageFieldHelper(xmlDocument, toast.imagePath()); },
-                "Error in setImageFieldHelper: ",
-                {
-                    setError(error, WinToast::WinToastError::UnknownError);
-                    return -1;
-                }
-        )
+std::size_t WinToastImpl::cancelScheduled(std::chrono::system_clock::time_point from,
+                                          std::chrono::system_clock::time_point to) {
+    if (!_isInitialized) {
+        TRACE_ERROR(Schedule, "Error when cancelling scheduled toasts. WinToast is not initialized.");
+        return 0;
     }
+    return _pipeline.cancelScheduled(from, to);
+}
 
-    ToastNotification notification{nullptr};
-    catchAndLogHresult(
-            {
-                INT64 relativeExpiration = toast.expiration();
-                notification = xmlDocument;
-                if (relativeExpiration > 0) {
-                    winrt::Windows::Foundation::DateTime expirationDateTime{
-                            winrt::Windows::Foundation::TimeSpan(Util::fileTimeNow() + relativeExpiration * 10000)};
-                    notification.ExpirationTime(expirationDateTime);
-                }
-            },
-            "Error in showToast while trying to construct the notification: ",
-            {
-                setError(error, WinToast::WinToastError::UnknownError);
-                return -1;
-            }
-    )
-
-    GUID guid;
-    catchAndLogHresult(
-            {
-                winrt::check_hresult(CoCreateGuid(&guid));
-            },
-            "Error in CoCreateGuid: ",
-            {
-                setError(error, WinToast::WinToastError::UnknownError);
-                return -1;
-            }
-    )
+std::vector<WinToast::ShowResult> WinToastImpl::showToasts(const WinToastTemplate *toasts, std::size_t count) {
+    if (!isInitialized()) {
+        TRACE_ERROR(Toast, "Error when launching the toasts. WinToast is not initialized.");
+        return std::vector<WinToast::ShowResult>(count, WinToast::ShowResult{-1,
+                                                                             WinToast::WinToastError::NotInitialized});
+    }
 
-    id = guid.Data1;
-    _buffer.insert(std::pair(id, notification));
-    DEBUG_MSG("xml: " << xmlDocument.GetXml().c_str());
-    catchAndLogHresult(
-            {
-                notifier.Show(notification);
-            },
-            "Error when showing notification: ",
-            {
-                setError(error, WinToast::WinToastError::NotDisplayed);
-                return -1;
-            }
-    )
+    const bool modernFeatures = isSupportingModernFeatures();
+    if (!modernFeatures) {
+        TRACE_INFO(Toast, "Modern features (Actions/Sounds/Attributes) not supported in this os version");
+    }
 
-    return id;
+    return _pipeline.show(toasts, count, modernFeatures);
 }
 
 bool WinToastImpl::hideToast(INT64 id) {
     if (!_isInitialized) {
-        DEBUG_ERR("Error when hiding the toast. WinToast is not initialized.");
+        TRACE_ERROR(Toast, "Error when hiding the toast. WinToast is not initialized.");
         return false;
     }
 
-    if (_buffer.find(id) != _buffer.end()) {
-        catchAndLogHresult(
-                {
-                    ToastNotifier notifier = ToastNotificationManager::CreateToastNotifier(_aumi);
-                    notifier.Hide(_buffer.at(id));
-                },
-                "Error when hiding the toast: ",
-                { return false; }
-        )
-        _buffer.erase(id);
-        return true;
-    }
-    return false;
+    return _pipeline.hide(id);
 }
 
 void WinToastImpl::clear() {
-    catchAndLogHresult(
-            {
-                ToastNotifier notifier = ToastNotificationManager::CreateToastNotifier(_aumi);
-                for (auto it = _buffer.begin(); it != _buffer.end(); ++it) {
-                    notifier.Hide(it->second);
-                }
-            },
-            "Error when clearing toasts: "
-    )
-    _buffer.clear();
+    _pipeline.clear();
 }
@@ -23,13 +23,15 @@
 
 #include <Windows.h>
 #include <winrt/Windows.Foundation.h>
-#include <winrt/Windows.Data.Xml.Dom.h>
-#include <winrt/Windows.UI.Notifications.h>
 
 #include <map>
 #include <functional>
+#include <memory>
 
 #include "wintoastlib.h"
+#include "toast_pipeline.h"
+#include "activation_dispatcher.h"
+#include "async_submitter.h"
 
 namespace WinToastLib {
 
@@ -54,8 +56,36 @@ namespace WinToastLib {
 
         static INT64 showToast(_In_ const WinToastTemplate &toast, _Out_opt_ WinToast::WinToastError *error = nullptr);
 
+        static void setDeduplicationWindow(std::chrono::milliseconds window);
+
+        [[nodiscard]] static std::uint64_t suppressedDuplicates();
+
+        static WinToastAsync<WinToast::ShowResult> showToastAsync(_In_ WinToastTemplate toast,
+                                                                  std::optional<AsyncSubmitter::Clock::time_point>
+                                                                  deadline = std::nullopt);
+
+        static WinToastAsync<bool> hideToastAsync(_In_ INT64 id);
+
+        static void setSubmissionPriorities(bool enabled);
+
+        [[nodiscard]] static WinToast::SubmissionStats submissionStats();
+
+        [[nodiscard]] static WinToast::Stats stats();
+
+        static std::vector<WinToast::ShowResult> showToasts(_In_reads_(count) const WinToastTemplate *toasts,
+                                                            std::size_t count);
+
         static void clear();
 
+        static INT64 scheduleToast(_In_ const WinToastTemplate &toast,
+                                   std::chrono::system_clock::time_point deliveryTime,
+                                   _Out_opt_ WinToast::WinToastError *error = nullptr);
+
+        static bool cancelScheduled(INT64 id);
+
+        static std::size_t cancelScheduled(std::chrono::system_clock::time_point from,
+                                           std::chrono::system_clock::time_point to);
+
         static WinToast::ShortcutResult createShortcut();
 
         [[nodiscard]] static const std::wstring &appName();
@@ -76,10 +106,23 @@ namespace WinToastLib {
 
         static void setShortcutPolicy(_In_ WinToast::ShortcutPolicy policy);
 
+        // Replaces the backend toasts are delivered through. Passing nullptr restores the default WinRT backend.
+        static void setBackend(_In_opt_ std::unique_ptr<ToastBackend> backend);
+
+        static void setOnActivated(const std::function<void(const WinToastActivation &)> &callback);
+
         static void setOnActivated(
                 const std::function<void(const WinToastArguments &,
                                          const std::map<std::wstring, std::wstring> &)> &callback);
 
+        static void setActivationDispatch(std::size_t workers, std::size_t queueCapacity);
+
+        [[nodiscard]] static WinToast::ActivationDispatchStats activationDispatchStats();
+
+        static void setLiveToastLimit(std::size_t limit);
+
+        [[nodiscard]] static WinToast::LiveToastStats liveToastStats();
+
     private:
         struct callback;
         struct callback_factory;
@@ -92,30 +135,22 @@ namespace WinToastLib {
         static std::wstring _clsid;
         static std::wstring _iconPath;
         static std::wstring _iconBackgroundColor;
-        static std::map<INT64, winrt::Windows::UI::Notifications::ToastNotification> _buffer;
-        static std::function<void(const WinToastArguments &,
-                                  const std::map<std::wstring, std::wstring> &)> _onActivated;
+        static ToastPipeline _pipeline;
+        using ActivationHandler = std::function<void(const WinToastActivation &)>;
+        // Read by the COM activation thread and the dispatcher workers, only accessed through std::atomic_load
+        // and std::atomic_store.
+        static std::shared_ptr<const ActivationHandler> _onActivated;
+        static std::shared_ptr<ActivationDispatcher> _activationDispatcher;
+
+        static void invokeOnActivated(const WinToastActivation &activation) noexcept;
+
+        static AsyncSubmitter &submitter();
 
         static void createAndRegisterActivator();
 
         static void validateShellLinkHelper(_Out_ bool &wasChanged);
 
         static void createShellLinkHelper();
-
-        static void
-        setImageFieldHelper(_In_ winrt::Windows::Data::Xml::Dom::XmlDocument xml, _In_ const std::wstring &path);
-
-        static void
-        setAudioFieldHelper(_In_ winrt::Windows::Data::Xml::Dom::XmlDocument xml, _In_ const std::wstring &path,
-                            _In_opt_
-                            WinToastTemplate::AudioOption option = WinToastTemplate::AudioOption::Default);
-
-        static void setAttributionTextFieldHelper(_In_ winrt::Windows::Data::Xml::Dom::XmlDocument xml, _In_
-                                                  const std::wstring &text);
-
-        static void
-        addActionHelper(_In_ winrt::Windows::Data::Xml::Dom::XmlDocument xml, _In_ const std::wstring &action, _In_
-                        const std::wstring &arguments);
     };
 }
 
@@ -0,0 +1,119 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "worker_pool.h"
+
+using namespace WinToastLib;
+
+WorkerPool::WorkerPool(std::size_t threads) {
+    _threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        _threads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(_mutex);
+        _stopping = true;
+    }
+    _wakeUp.notify_all();
+    for (std::thread &thread: _threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &task) {
+    if (count == 0) {
+        return;
+    }
+
+    Loop loop;
+    loop.task = &task;
+    loop.count = count;
+    if (_threads.empty() || count == 1) {
+        work(loop);
+        if (loop.error) {
+            std::rethrow_exception(loop.error);
+        }
+        return;
+    }
+
+    std::lock_guard loopLock(_loopMutex);
+    {
+        std::lock_guard lock(_mutex);
+        _loop = &loop;
+        _generation++;
+    }
+    _wakeUp.notify_all();
+
+    work(loop);
+
+    // The loop lives on this stack frame, wait until no worker can touch it anymore.
+    std::unique_lock lock(_mutex);
+    _loop = nullptr;
+    _idle.wait(lock, [this] { return _busy == 0; });
+    if (loop.error) {
+        std::rethrow_exception(loop.error);
+    }
+}
+
+std::size_t WorkerPool::threadCount() const noexcept {
+    return _threads.size();
+}
+
+void WorkerPool::run() {
+    std::uint64_t seen = 0;
+    std::unique_lock lock(_mutex);
+    for (;;) {
+        _wakeUp.wait(lock, [&] { return _stopping || _generation != seen; });
+        if (_stopping) {
+            return;
+        }
+        seen = _generation;
+        Loop *loop = _loop;
+        if (loop == nullptr) {
+            continue;
+        }
+
+        _busy++;
+        lock.unlock();
+        work(*loop);
+        lock.lock();
+        if (--_busy == 0) {
+            _idle.notify_one();
+        }
+    }
+}
+
+void WorkerPool::work(Loop &loop) {
+    for (std::size_t i = loop.next.fetch_add(1); i < loop.count; i = loop.next.fetch_add(1)) {
+        try {
+            (*loop.task)(i);
+        } catch (...) {
+            // Only the first exception is kept, it is read by parallelFor after every worker left the loop.
+            if (!loop.failed.test_and_set()) {
+                loop.error = std::current_exception();
+            }
+            loop.next.store(loop.count);
+            return;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_WORKER_POOL_H
+#define WINTOAST_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WinToastLib {
+
+    // A fixed set of threads for data parallel loops. The calling thread works along with the pool, so a pool
+    // without threads simply runs the loop inline.
+    class WorkerPool {
+    public:
+        explicit WorkerPool(std::size_t threads);
+
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        // Calls task(i) for every i in [0, count) and returns once all the calls returned. If a call throws, the
+        // remaining indices are skipped and the first exception is rethrown on the calling thread once the loop
+        // is done. Loops from different threads run one after the other.
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &task);
+
+        [[nodiscard]] std::size_t threadCount() const noexcept;
+
+    private:
+        struct Loop {
+            const std::function<void(std::size_t)> *task;
+            std::size_t count;
+            std::atomic<std::size_t> next{0};
+            std::atomic_flag failed = ATOMIC_FLAG_INIT;
+            std::exception_ptr error;
+        };
+
+        void run();
+
+        static void work(Loop &loop);
+
+        std::mutex _loopMutex;
+        std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::condition_variable _idle;
+        Loop *_loop = nullptr;
+        std::uint64_t _generation = 0;
+        std::size_t _busy = 0;
+        bool _stopping = false;
+        std::vector<std::thread> _threads;
+    };
+}
+
+#endif //WINTOAST_WORKER_POOL_H
@@ -0,0 +1,277 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "xml_escape.h"
+#include "simd_support.h"
+
+#include <cstdint>
+
+using namespace WinToastLib;
+
+namespace {
+    constexpr bool Utf16 = sizeof(wchar_t) == 2;
+
+    // Everything from U+D800 up goes through the slow path: surrogates need pairing and U+FFFE, U+FFFF and,
+    // with 32 bit wchar_t, anything past U+10FFFF has to be dropped.
+    constexpr std::uint32_t FirstSlowCodeUnit = 0xD800;
+
+    inline bool needsCare(wchar_t c) noexcept {
+        const auto unit = static_cast<std::uint32_t>(c);
+        return unit < 0x20 || unit >= FirstSlowCodeUnit || c == L'&' || c == L'<' || c == L'>' || c == L'"';
+    }
+
+#if defined(WINTOAST_AVX2)
+
+    // Returns the number of leading characters of [first, last) that can be copied as they are.
+    std::size_t plainPrefix(const wchar_t *first, const wchar_t *last) noexcept {
+        constexpr std::size_t Lanes = 32 / sizeof(wchar_t);
+        const wchar_t *it = first;
+
+        if constexpr (Utf16) {
+            const __m256i ampersand = _mm256_set1_epi16(L'&');
+            const __m256i less = _mm256_set1_epi16(L'<');
+            const __m256i greater = _mm256_set1_epi16(L'>');
+            const __m256i quote = _mm256_set1_epi16(L'"');
+            const __m256i lastControl = _mm256_set1_epi16(0x1F);
+            const __m256i lastPlain = _mm256_set1_epi16(static_cast<short>(FirstSlowCodeUnit - 1));
+            const __m256i zero = _mm256_setzero_si256();
+
+            for (; last - it >= static_cast<std::ptrdiff_t>(Lanes); it += Lanes) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(it));
+                __m256i special = _mm256_cmpeq_epi16(_mm256_subs_epu16(v, lastControl), zero);
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi16(v, ampersand));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi16(v, less));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi16(v, greater));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi16(v, quote));
+                const __m256i plainRange = _mm256_cmpeq_epi16(_mm256_subs_epu16(v, lastPlain), zero);
+                special = _mm256_or_si256(special, _mm256_andnot_si256(plainRange, _mm256_set1_epi16(-1)));
+
+                const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+                if (mask) {
+                    return (it - first) + Simd::firstSetBit(mask) / sizeof(wchar_t);
+                }
+            }
+        } else {
+            const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+            const __m256i ampersand = _mm256_set1_epi32(L'&');
+            const __m256i less = _mm256_set1_epi32(L'<');
+            const __m256i greater = _mm256_set1_epi32(L'>');
+            const __m256i quote = _mm256_set1_epi32(L'"');
+            const __m256i firstPrintable = _mm256_xor_si256(_mm256_set1_epi32(0x20), bias);
+            const __m256i lastPlain = _mm256_xor_si256(_mm256_set1_epi32(FirstSlowCodeUnit - 1), bias);
+
+            for (; last - it >= static_cast<std::ptrdiff_t>(Lanes); it += Lanes) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(it));
+                const __m256i biased = _mm256_xor_si256(v, bias);
+                __m256i special = _mm256_cmpgt_epi32(firstPrintable, biased);
+                special = _mm256_or_si256(special, _mm256_cmpgt_epi32(biased, lastPlain));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi32(v, ampersand));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi32(v, less));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi32(v, greater));
+                special = _mm256_or_si256(special, _mm256_cmpeq_epi32(v, quote));
+
+                const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+                if (mask) {
+                    return (it - first) + Simd::firstSetBit(mask) / sizeof(wchar_t);
+                }
+            }
+        }
+
+        while (it != last && !needsCare(*it)) {
+            ++it;
+        }
+        return it - first;
+    }
+
+#elif defined(WINTOAST_SSE2)
+
+    // Returns the number of leading characters of [first, last) that can be copied as they are.
+    std::size_t plainPrefix(const wchar_t *first, const wchar_t *last) noexcept {
+        constexpr std::size_t Lanes = 16 / sizeof(wchar_t);
+        const wchar_t *it = first;
+
+        if constexpr (Utf16) {
+            const __m128i ampersand = _mm_set1_epi16(L'&');
+            const __m128i less = _mm_set1_epi16(L'<');
+            const __m128i greater = _mm_set1_epi16(L'>');
+            const __m128i quote = _mm_set1_epi16(L'"');
+            const __m128i lastControl = _mm_set1_epi16(0x1F);
+            const __m128i lastPlain = _mm_set1_epi16(static_cast<short>(FirstSlowCodeUnit - 1));
+            const __m128i zero = _mm_setzero_si128();
+
+            for (; last - it >= static_cast<std::ptrdiff_t>(Lanes); it += Lanes) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+                __m128i special = _mm_cmpeq_epi16(_mm_subs_epu16(v, lastControl), zero);
+                special = _mm_or_si128(special, _mm_cmpeq_epi16(v, ampersand));
+                special = _mm_or_si128(special, _mm_cmpeq_epi16(v, less));
+                special = _mm_or_si128(special, _mm_cmpeq_epi16(v, greater));
+                special = _mm_or_si128(special, _mm_cmpeq_epi16(v, quote));
+                const __m128i plainRange = _mm_cmpeq_epi16(_mm_subs_epu16(v, lastPlain), zero);
+                special = _mm_or_si128(special, _mm_andnot_si128(plainRange, _mm_set1_epi16(-1)));
+
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+                if (mask) {
+                    return (it - first) + Simd::firstSetBit(mask) / sizeof(wchar_t);
+                }
+            }
+        } else {
+            const __m128i bias = _mm_set1_epi32(INT32_MIN);
+            const __m128i ampersand = _mm_set1_epi32(L'&');
+            const __m128i less = _mm_set1_epi32(L'<');
+            const __m128i greater = _mm_set1_epi32(L'>');
+            const __m128i quote = _mm_set1_epi32(L'"');
+            const __m128i firstPrintable = _mm_xor_si128(_mm_set1_epi32(0x20), bias);
+            const __m128i lastPlain = _mm_xor_si128(_mm_set1_epi32(FirstSlowCodeUnit - 1), bias);
+
+            for (; last - it >= static_cast<std::ptrdiff_t>(Lanes); it += Lanes) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(it));
+                const __m128i biased = _mm_xor_si128(v, bias);
+                __m128i special = _mm_cmplt_epi32(biased, firstPrintable);
+                special = _mm_or_si128(special, _mm_cmpgt_epi32(biased, lastPlain));
+                special = _mm_or_si128(special, _mm_cmpeq_epi32(v, ampersand));
+                special = _mm_or_si128(special, _mm_cmpeq_epi32(v, less));
+                special = _mm_or_si128(special, _mm_cmpeq_epi32(v, greater));
+                special = _mm_or_si128(special, _mm_cmpeq_epi32(v, quote));
+
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+                if (mask) {
+                    return (it - first) + Simd::firstSetBit(mask) / sizeof(wchar_t);
+                }
+            }
+        }
+
+        while (it != last && !needsCare(*it)) {
+            ++it;
+        }
+        return it - first;
+    }
+
+#else
+
+    std::size_t plainPrefix(const wchar_t *first, const wchar_t *last) noexcept {
+        const wchar_t *it = first;
+        while (it != last && !needsCare(*it)) {
+            ++it;
+        }
+        return it - first;
+    }
+
+#endif
+
+    // Appends the character at it, escaped or dropped as needed, and returns the position of the next one.
+    const wchar_t *appendCharacter(std::wstring &buffer, const wchar_t *it, const wchar_t *last,
+                                   XmlEscape::Context context) {
+        const wchar_t c = *it;
+        const auto unit = static_cast<std::uint32_t>(c);
+
+        switch (c) {
+            case L'&':
+                buffer += L"&amp;";
+                return it + 1;
+            case L'<':
+                buffer += L"&lt;";
+                return it + 1;
+            case L'>':
+                buffer += L"&gt;";
+                return it + 1;
+            case L'"':
+                if (context == XmlEscape::Context::Attribute) {
+                    buffer += L"&quot;";
+                } else {
+                    buffer += c;
+                }
+                return it + 1;
+            // Attribute value normalization would turn these into spaces, so attributes keep them as character
+            // references, as XmlDocument::GetXml() writes them.
+            case L'\t':
+                if (context == XmlEscape::Context::Attribute) {
+                    buffer += L"&#9;";
+                } else {
+                    buffer += c;
+                }
+                return it + 1;
+            case L'\n':
+                if (context == XmlEscape::Context::Attribute) {
+                    buffer += L"&#10;";
+                } else {
+                    buffer += c;
+                }
+                return it + 1;
+            case L'\r':
+                if (context == XmlEscape::Context::Attribute) {
+                    buffer += L"&#13;";
+                } else {
+                    buffer += c;
+                }
+                return it + 1;
+            default:
+                break;
+        }
+
+        if (unit < 0x20 || unit == 0xFFFE || unit == 0xFFFF) {
+            return it + 1;
+        }
+
+        if (unit >= 0xD800 && unit <= 0xDFFF) {
+            if constexpr (Utf16) {
+                const bool isHigh = unit <= 0xDBFF;
+                if (isHigh && it + 1 != last) {
+                    const auto next = static_cast<std::uint32_t>(it[1]);
+                    if (next >= 0xDC00 && next <= 0xDFFF) {
+                        buffer.append(it, 2);
+                        return it + 2;
+                    }
+                }
+            }
+            return it + 1;
+        }
+
+        if (unit > 0x10FFFF) {
+            return it + 1;
+        }
+
+        buffer += c;
+        return it + 1;
+    }
+}
+
+void XmlEscape::append(std::wstring &buffer, std::wstring_view value, Context context) {
+    const wchar_t *it = value.data();
+    const wchar_t *last = it + value.size();
+
+    while (it != last) {
+        const std::size_t plain = plainPrefix(it, last);
+        buffer.append(it, plain);
+        it += plain;
+
+        if (it != last) {
+            it = appendCharacter(buffer, it, last, context);
+        }
+    }
+}
+
+void XmlEscape::appendScalar(std::wstring &buffer, std::wstring_view value, Context context) {
+    const wchar_t *it = value.data();
+    const wchar_t *last = it + value.size();
+
+    while (it != last) {
+        it = appendCharacter(buffer, it, last, context);
+    }
+}
@@ -0,0 +1,43 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_XML_ESCAPE_H
+#define WINTOAST_XML_ESCAPE_H
+
+#include <string>
+#include <string_view>
+
+namespace WinToastLib::XmlEscape {
+
+    enum class Context {
+        Text, Attribute
+    };
+
+    // Appends value to buffer escaped for the given context: &, < and > always, the double quote, tab, line feed
+    // and carriage return as character references in attributes. Characters XML 1.0 doesn't allow are dropped
+    // (control characters other than tab, line feed and carriage return, unpaired surrogates, U+FFFE and U+FFFF).
+    // Runs of characters needing no care are found with SSE2/AVX2 when available and copied in bulk.
+    void append(std::wstring &buffer, std::wstring_view value, Context context);
+
+    // Character by character reference implementation of append(), producing the same output.
+    void appendScalar(std::wstring &buffer, std::wstring_view value, Context context);
+}
+
+#endif //WINTOAST_XML_ESCAPE_H
@@ -0,0 +1,316 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "activation_dispatcher.h"
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    // The handler of the overflow test holds its worker until released, so the worker's queue fills up.
+    class Gate {
+    public:
+        void enter() {
+            std::unique_lock lock(_mutex);
+            _entered = true;
+            _changed.notify_all();
+            _changed.wait(lock, [this] { return _open; });
+        }
+
+        bool waitEntered() {
+            std::unique_lock lock(_mutex);
+            return _changed.wait_for(lock, std::chrono::seconds(5), [this] { return _entered; });
+        }
+
+        void open() {
+            std::lock_guard lock(_mutex);
+            _open = true;
+            _changed.notify_all();
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        bool _entered = false;
+        bool _open = false;
+    };
+
+    void dispatchUntilAccepted(ActivationDispatcher &dispatcher, const std::wstring &arguments,
+                               const WinToastUserInput *userInput, std::size_t userInputCount) {
+        while (!dispatcher.dispatch(arguments, userInput, userInputCount)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WinToastTests::activationDispatcherTests(Suite &suite) {
+    // Activations with the same arguments reach the handler in the order they were dispatched, even with many
+    // workers and submitters, and every activation is handled once.
+    suite.add("activation_dispatcher/ordering", [] {
+        constexpr int Groups = 32;
+        constexpr int Submitters = 4;
+        constexpr int PerGroup = 500;
+
+        std::mutex mutex;
+        std::map<std::wstring, std::vector<int>> received;
+        std::set<std::thread::id> handlerThreads;
+        std::optional<ActivationDispatcher> dispatcher;
+        dispatcher.emplace(4, 64, [&](const WinToastActivation &activation) {
+            const std::optional<std::wstring_view> sequence = activation.userInput(L"sequence");
+            std::lock_guard lock(mutex);
+            received[activation.arguments().get(L"group")].push_back(std::stoi(std::wstring(*sequence)));
+            handlerThreads.insert(std::this_thread::get_id());
+        });
+
+        // Every submitter owns its own groups, so the dispatch order within a group is known.
+        std::vector<std::thread> submitters;
+        for (int submitter = 0; submitter < Submitters; submitter++) {
+            submitters.emplace_back([&, submitter] {
+                for (int sequence = 0; sequence < PerGroup; sequence++) {
+                    for (int group = submitter; group < Groups; group += Submitters) {
+                        const std::wstring arguments = L"group=" + std::to_wstring(group);
+                        const std::wstring sequenceText = std::to_wstring(sequence);
+                        const WinToastUserInput userInput{L"sequence", sequenceText.c_str()};
+                        dispatchUntilAccepted(*dispatcher, arguments, &userInput, 1);
+                    }
+                }
+            });
+        }
+        for (std::thread &submitter: submitters) {
+            submitter.join();
+        }
+        const std::thread::id submitting = std::this_thread::get_id();
+        // Destroying the dispatcher drains the queues.
+        const WinToast::ActivationDispatchStats before = dispatcher->stats();
+        dispatcher.reset();
+
+        WINTOAST_CHECK_EQUAL(before.dispatched, std::uint64_t{Groups * PerGroup});
+        WINTOAST_CHECK_EQUAL(received.size(), std::size_t{Groups});
+        for (const auto &[group, sequences]: received) {
+            WINTOAST_CHECK_EQUAL(sequences.size(), std::size_t{PerGroup});
+            bool inOrder = true;
+            for (std::size_t i = 0; i < sequences.size(); i++) {
+                inOrder = inOrder && sequences[i] == static_cast<int>(i);
+            }
+            WINTOAST_CHECK(inOrder);
+        }
+        WINTOAST_CHECK(handlerThreads.count(submitting) == 0);
+        WINTOAST_CHECK(!handlerThreads.empty());
+        WINTOAST_CHECK(handlerThreads.size() <= 4);
+    });
+
+    // The handler runs on a worker and sees its own copy of the activation, the submitter's buffers are gone.
+    suite.add("activation_dispatcher/handler_off_thread", [] {
+        std::mutex mutex;
+        std::condition_variable handled;
+        std::optional<std::thread::id> handlerThread;
+        std::wstring arguments;
+        std::wstring reply;
+        ActivationDispatcher dispatcher(2, 16, [&](const WinToastActivation &activation) {
+            std::lock_guard lock(mutex);
+            handlerThread = std::this_thread::get_id();
+            arguments = activation.arguments().get(L"action");
+            reply = std::wstring(activation.userInput(L"reply").value_or(L""));
+            handled.notify_all();
+        });
+
+        {
+            std::wstring submittedArguments = L"action=open;id=7";
+            std::wstring submittedReply = L"hello";
+            const WinToastUserInput userInput{L"reply", submittedReply.c_str()};
+            WINTOAST_CHECK(dispatcher.dispatch(submittedArguments, &userInput, 1));
+            submittedArguments.assign(submittedArguments.size(), L'x');
+            submittedReply.assign(submittedReply.size(), L'x');
+        }
+
+        std::unique_lock lock(mutex);
+        WINTOAST_CHECK(handled.wait_for(lock, std::chrono::seconds(5), [&] { return handlerThread.has_value(); }));
+        WINTOAST_CHECK(*handlerThread != std::this_thread::get_id());
+        WINTOAST_CHECK_EQUAL(arguments, std::wstring(L"open"));
+        WINTOAST_CHECK_EQUAL(reply, std::wstring(L"hello"));
+    });
+
+    // With its worker held up, a queue takes its capacity and then refuses activations, counting each one.
+    suite.add("activation_dispatcher/overflow", [] {
+        constexpr std::size_t Capacity = 8;
+
+        Gate gate;
+        std::mutex mutex;
+        std::vector<std::wstring> received;
+        std::optional<ActivationDispatcher> dispatcher;
+        dispatcher.emplace(1, Capacity, [&](const WinToastActivation &activation) {
+            const std::wstring index = activation.arguments().get(L"index");
+            if (index == L"0") {
+                gate.enter();
+            }
+            std::lock_guard lock(mutex);
+            received.push_back(index);
+        });
+
+        WINTOAST_CHECK(dispatcher->dispatch(L"index=0", nullptr, 0));
+        WINTOAST_CHECK(gate.waitEntered());
+
+        std::size_t accepted = 0;
+        std::size_t refused = 0;
+        for (std::size_t index = 1; index <= Capacity + 5; index++) {
+            if (dispatcher->dispatch(L"index=" + std::to_wstring(index), nullptr, 0)) {
+                accepted++;
+            } else {
+                refused++;
+            }
+        }
+        WINTOAST_CHECK_EQUAL(accepted, Capacity);
+        WINTOAST_CHECK_EQUAL(refused, std::size_t{5});
+
+        const WinToast::ActivationDispatchStats stats = dispatcher->stats();
+        WINTOAST_CHECK_EQUAL(stats.dispatched, std::uint64_t{1 + Capacity});
+        WINTOAST_CHECK_EQUAL(stats.overflows, std::uint64_t{5});
+        WINTOAST_CHECK_EQUAL(stats.handled, std::uint64_t{0});
+
+        gate.open();
+        dispatcher.reset();
+
+        // Only the accepted activations were handled, in the order they were dispatched.
+        WINTOAST_CHECK_EQUAL(received.size(), 1 + Capacity);
+        bool inOrder = true;
+        for (std::size_t i = 0; i < received.size(); i++) {
+            inOrder = inOrder && received[i] == std::to_wstring(i);
+        }
+        WINTOAST_CHECK(inOrder);
+    });
+
+    // The counters agree with what was dispatched and handled, and the latency covers the time spent queued.
+    suite.add("activation_dispatcher/stats", [] {
+        constexpr std::size_t Count = 20;
+        constexpr auto Held = std::chrono::milliseconds(30);
+
+        Gate gate;
+        std::atomic<std::uint64_t> calls{0};
+        ActivationDispatcher dispatcher(1, 64, [&](const WinToastActivation &activation) {
+            if (activation.arguments().get(L"index") == L"0") {
+                gate.enter();
+            }
+            calls++;
+        });
+
+        for (std::size_t index = 0; index < Count; index++) {
+            WINTOAST_CHECK(dispatcher.dispatch(L"index=" + std::to_wstring(index), nullptr, 0));
+        }
+        WINTOAST_CHECK(gate.waitEntered());
+        std::this_thread::sleep_for(Held);
+        gate.open();
+
+        const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (dispatcher.stats().handled < Count && std::chrono::steady_clock::now() < giveUp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const WinToast::ActivationDispatchStats stats = dispatcher.stats();
+        WINTOAST_CHECK_EQUAL(stats.dispatched, std::uint64_t{Count});
+        WINTOAST_CHECK_EQUAL(stats.handled, std::uint64_t{Count});
+        WINTOAST_CHECK_EQUAL(calls.load(), std::uint64_t{Count});
+        WINTOAST_CHECK_EQUAL(stats.overflows, std::uint64_t{0});
+        // The activations behind the held one waited at least as long as it was held.
+        const auto heldNs = static_cast<std::uint64_t>(std::chrono::nanoseconds(Held).count());
+        WINTOAST_CHECK(stats.maxLatencyNs >= heldNs);
+        WINTOAST_CHECK(stats.totalLatencyNs >= heldNs * (Count - 1));
+        WINTOAST_CHECK(stats.totalLatencyNs <= stats.maxLatencyNs * Count);
+    });
+
+    // A handler can replace the dispatcher it runs on: the old one is retired to another thread, which drains its
+    // queue and joins its worker, instead of the worker joining itself.
+    suite.add("activation_dispatcher/replace_from_handler", [] {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::wstring> oldReceived;
+        std::vector<std::wstring> newReceived;
+        std::shared_ptr<ActivationDispatcher> current;
+
+        auto alive = std::make_shared<int>(0);
+        const std::weak_ptr<int> oldHandlerAlive = alive;
+        Gate gate;
+        std::atomic_store(&current, std::make_shared<ActivationDispatcher>(
+                1, 16, [&, alive = std::move(alive)](const WinToastActivation &activation) {
+                    const std::wstring index = activation.arguments().get(L"index");
+                    if (index == L"0") {
+                        gate.enter();
+                        auto replacement = std::make_shared<ActivationDispatcher>(
+                                1, 16, [&](const WinToastActivation &next) {
+                                    std::lock_guard lock(mutex);
+                                    newReceived.push_back(next.arguments().get(L"index"));
+                                    changed.notify_all();
+                                });
+                        ActivationDispatcher::retire(std::atomic_exchange(&current, std::move(replacement)));
+                    }
+                    std::lock_guard lock(mutex);
+                    oldReceived.push_back(index);
+                    changed.notify_all();
+                }));
+
+        WINTOAST_CHECK(std::atomic_load(&current)->dispatch(L"index=0", nullptr, 0));
+        WINTOAST_CHECK(gate.waitEntered());
+        // Queued behind the replacing activation, so the retired dispatcher still has to handle it.
+        WINTOAST_CHECK(std::atomic_load(&current)->dispatch(L"index=1", nullptr, 0));
+        gate.open();
+
+        // Once the retired dispatcher is destroyed its handler is gone too.
+        const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!oldHandlerAlive.expired() && std::chrono::steady_clock::now() < giveUp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        WINTOAST_CHECK(oldHandlerAlive.expired());
+
+        WINTOAST_CHECK(std::atomic_load(&current)->dispatch(L"index=2", nullptr, 0));
+        std::unique_lock lock(mutex);
+        WINTOAST_CHECK(changed.wait_for(lock, std::chrono::seconds(5), [&] { return !newReceived.empty(); }));
+        WINTOAST_CHECK(oldReceived == std::vector<std::wstring>({L"0", L"1"}));
+        WINTOAST_CHECK(newReceived == std::vector<std::wstring>({L"2"}));
+    });
+
+    // Shutting down drains what was queued and refuses what comes after.
+    suite.add("activation_dispatcher/shutdown", [] {
+        std::atomic<int> handled{0};
+        ActivationDispatcher dispatcher(2, 16, [&](const WinToastActivation &) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            handled++;
+        });
+        for (int i = 0; i < 10; i++) {
+            WINTOAST_CHECK(dispatcher.dispatch(L"index=" + std::to_wstring(i), nullptr, 0));
+        }
+        dispatcher.shutdown();
+        WINTOAST_CHECK_EQUAL(handled.load(), 10);
+        WINTOAST_CHECK(!dispatcher.dispatch(L"index=10", nullptr, 0));
+        WINTOAST_CHECK_EQUAL(dispatcher.stats().dispatched, std::uint64_t{10});
+        // The destructor finds nothing left to do.
+    });
+}
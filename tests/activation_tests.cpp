@@ -0,0 +1,110 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+void WinToastTests::activationTests(Suite &suite) {
+    suite.add("activation/no_inputs", [] {
+        const WinToastActivation activation(L"", nullptr, 0);
+        WINTOAST_CHECK(activation.arguments().empty());
+        WINTOAST_CHECK_EQUAL(activation.userInputCount(), std::size_t{0});
+        WINTOAST_CHECK(!activation.userInput(L""));
+        WINTOAST_CHECK(!activation.userInput(L"reply"));
+
+        const WinToastActivation::Data data = activation.materialize();
+        WINTOAST_CHECK(data.arguments.empty());
+        WINTOAST_CHECK(data.userInput.empty());
+
+        const WinToastUserInput inputs[] = {{L"reply", L"hi"}};
+        WINTOAST_CHECK_EQUAL(WinToastActivation(L"a=1", inputs, 0).userInputCount(), std::size_t{0});
+        WINTOAST_CHECK(!WinToastActivation(L"a=1", inputs, 0).userInput(L"reply"));
+    });
+
+    // A null input array counts as no input whatever count comes with it.
+    suite.add("activation/null_user_input", [] {
+        const WinToastActivation activation(L"action=open", nullptr, 3);
+        WINTOAST_CHECK_EQUAL(activation.userInputCount(), std::size_t{0});
+        WINTOAST_CHECK(!activation.userInput(L"reply"));
+        WINTOAST_CHECK_EQUAL(activation.arguments().get(L"action"), std::wstring(L"open"));
+        WINTOAST_CHECK(activation.materialize().userInput.empty());
+    });
+
+    // Null keys and values read as empty strings.
+    suite.add("activation/null_strings", [] {
+        const WinToastUserInput inputs[] = {{nullptr, L"no key"}, {L"no value", nullptr}};
+        const WinToastActivation activation(L"", inputs, 2);
+        using Input = std::pair<std::wstring_view, std::wstring_view>;
+        WINTOAST_CHECK(activation.userInputAt(0) == Input(L"", L"no key"));
+        WINTOAST_CHECK(activation.userInputAt(1) == Input(L"no value", L""));
+        WINTOAST_CHECK_EQUAL(activation.userInput(L""), std::optional<std::wstring_view>(L"no key"));
+        WINTOAST_CHECK_EQUAL(activation.userInput(L"no value"), std::optional<std::wstring_view>(L""));
+
+        const WinToastActivation::Data data = activation.materialize();
+        WINTOAST_CHECK_EQUAL(data.userInput.size(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(data.userInput.at(L""), std::wstring(L"no key"));
+        WINTOAST_CHECK_EQUAL(data.userInput.at(L"no value"), std::wstring());
+    });
+
+    // Repeated keys resolve to the last one, in the arguments and the user input, viewed or materialized.
+    suite.add("activation/duplicate_keys", [] {
+        const WinToastUserInput inputs[] = {{L"reply", L"first"}, {L"choice", L"a"}, {L"reply", L"second"}};
+        const WinToastActivation activation(L"id=1;action=open;id=2", inputs, 3);
+        WINTOAST_CHECK_EQUAL(activation.userInputCount(), std::size_t{3});
+        WINTOAST_CHECK_EQUAL(activation.userInput(L"reply"), std::optional<std::wstring_view>(L"second"));
+        WINTOAST_CHECK_EQUAL(activation.arguments().get<int>(L"id"), std::optional<int>(2));
+
+        const WinToastActivation::Data data = activation.materialize();
+        WINTOAST_CHECK_EQUAL(data.userInput.size(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(data.userInput.at(L"reply"), std::wstring(L"second"));
+        WINTOAST_CHECK_EQUAL(data.arguments.size(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(data.arguments.get(L"id"), std::wstring(L"2"));
+    });
+
+    // What materialize() returns owns its strings, the buffers of the activation can go away.
+    suite.add("activation/materialize_outlives_source", [] {
+        WinToastActivation::Data data;
+        {
+            auto arguments = std::make_unique<std::wstring>(L"action=reply;text=a%3Bb");
+            auto key = std::make_unique<std::wstring>(L"message");
+            auto value = std::make_unique<std::wstring>(L"see you at 8");
+            const WinToastUserInput inputs[] = {{key->c_str(), value->c_str()}};
+            data = WinToastActivation(*arguments, inputs, 1).materialize();
+
+            // Overwrite the sources before freeing them, so reading them later would show.
+            arguments->assign(arguments->size(), L'#');
+            key->assign(key->size(), L'#');
+            value->assign(value->size(), L'#');
+        }
+
+        WINTOAST_CHECK_EQUAL(data.arguments.get(L"action"), std::wstring(L"reply"));
+        WINTOAST_CHECK_EQUAL(data.arguments.get(L"text"), std::wstring(L"a;b"));
+        WINTOAST_CHECK_EQUAL(data.userInput.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(data.userInput.at(L"message"), std::wstring(L"see you at 8"));
+    });
+}
@@ -0,0 +1,147 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    std::vector<std::wstring> keysOf(const WinToastArguments &arguments) {
+        std::vector<std::wstring> keys;
+        for (const auto &pair: arguments) {
+            keys.push_back(pair.first);
+        }
+        return keys;
+    }
+
+    bool throwsOutOfRange(const WinToastArguments &arguments, std::wstring_view key) {
+        try {
+            (void) arguments.get(key);
+        } catch (const std::out_of_range &) {
+            return true;
+        }
+        return false;
+    }
+}
+
+void WinToastTests::argumentsTests(Suite &suite) {
+    suite.add("arguments/subscript", [] {
+        WinToastArguments arguments;
+        arguments[L"b"] = L"2";
+        WINTOAST_CHECK_EQUAL(arguments.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(arguments.get(L"b"), std::wstring(L"2"));
+
+        // Looking a missing key up inserts it with an empty value.
+        WINTOAST_CHECK(arguments[L"a"].empty());
+        WINTOAST_CHECK(arguments.contains(L"a"));
+        WINTOAST_CHECK_EQUAL(arguments.size(), std::size_t{2});
+
+        arguments[L"b"] += L"0";
+        WINTOAST_CHECK_EQUAL(arguments.get(L"b"), std::wstring(L"20"));
+        WINTOAST_CHECK_EQUAL(arguments.size(), std::size_t{2});
+    });
+
+    suite.add("arguments/sorted_iteration", [] {
+        WinToastArguments arguments;
+        arguments.add(L"delta", L"4");
+        arguments[L"alpha"] = L"1";
+        arguments.add(L"charlie", L"3");
+        arguments[L"bravo"] = L"2";
+        arguments.add(L"Zulu", L"0");
+        WINTOAST_CHECK(keysOf(arguments) ==
+                       std::vector<std::wstring>({L"Zulu", L"alpha", L"bravo", L"charlie", L"delta"}));
+
+        WINTOAST_CHECK(arguments.remove(L"bravo"));
+        WINTOAST_CHECK(!arguments.remove(L"bravo"));
+        WINTOAST_CHECK(keysOf(arguments) == std::vector<std::wstring>({L"Zulu", L"alpha", L"charlie", L"delta"}));
+
+        for (auto &pair: arguments) {
+            pair.second += L"!";
+        }
+        WINTOAST_CHECK_EQUAL(arguments.get(L"delta"), std::wstring(L"4!"));
+    });
+
+    suite.add("arguments/to_string", [] {
+        WINTOAST_CHECK_EQUAL(WinToastArguments().toString(), std::wstring());
+
+        WinToastArguments arguments;
+        arguments.add(L"b", L"x;y");
+        arguments.add(L"a", L"1");
+        arguments.add(L"flag", L"");
+        arguments.add(L"k=v", L"100% <\"'&'>");
+        WINTOAST_CHECK_EQUAL(arguments.toString(),
+                             std::wstring(L"a=1;b=x%3By;flag;k%3Dv=100%25 %3C%22%27%26%27%3E"));
+
+        // The overload taking a buffer appends.
+        std::wstring buffer = L"prefix:";
+        arguments.toString(buffer);
+        WINTOAST_CHECK_EQUAL(buffer, L"prefix:" + arguments.toString());
+    });
+
+    suite.add("arguments/round_trip", [] {
+        WinToastArguments arguments;
+        arguments.add(L"action", L"reply");
+        arguments.add(L"empty", L"");
+        arguments.add(L"reserved %;=\"'<>&", L"%;=\"'<>&");
+        arguments.add(L"unicode", L"Café ☕");
+        arguments.add(L"escaped", L"%25");
+
+        const WinToastArguments parsed(arguments.toString());
+        WINTOAST_CHECK_EQUAL(parsed.size(), arguments.size());
+        WINTOAST_CHECK(std::equal(parsed.begin(), parsed.end(), arguments.begin(), arguments.end()));
+        WINTOAST_CHECK_EQUAL(parsed.toString(), arguments.toString());
+        WINTOAST_CHECK_EQUAL(parsed.get(L"escaped"), std::wstring(L"%25"));
+
+        WinToastArguments reparsed;
+        reparsed.add(L"stale", L"1");
+        reparsed.parse(arguments.toString());
+        WINTOAST_CHECK(!reparsed.contains(L"stale"));
+        WINTOAST_CHECK_EQUAL(reparsed.size(), arguments.size());
+    });
+
+    // A key given twice keeps a single entry holding the last value, whether it comes from add() or parse().
+    suite.add("arguments/duplicate_keys", [] {
+        WinToastArguments arguments;
+        arguments.add(L"k", L"1");
+        arguments.add(L"k", L"2");
+        WINTOAST_CHECK_EQUAL(arguments.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(arguments.get(L"k"), std::wstring(L"2"));
+
+        const WinToastArguments parsed(L"k=1;other=x;k=2;k%3D=3;k");
+        WINTOAST_CHECK(keysOf(parsed) == std::vector<std::wstring>({L"k", L"k=", L"other"}));
+        WINTOAST_CHECK_EQUAL(parsed.get(L"k"), std::wstring());
+        WINTOAST_CHECK_EQUAL(parsed.get(L"k="), std::wstring(L"3"));
+        WINTOAST_CHECK_EQUAL(parsed.toString(), std::wstring(L"k;k%3D=3;other=x"));
+    });
+
+    suite.add("arguments/missing_key", [] {
+        const WinToastArguments arguments(L"a=1");
+        WINTOAST_CHECK(!arguments.contains(L"b"));
+        WINTOAST_CHECK(throwsOutOfRange(arguments, L"b"));
+        WINTOAST_CHECK(!throwsOutOfRange(arguments, L"a"));
+        WINTOAST_CHECK(WinToastArguments(L"").empty());
+    });
+}
@@ -0,0 +1,176 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    enum class Action : std::uint8_t {
+        Open = 1, Dismiss = 200
+    };
+
+    enum Level : int {
+        Low = -1, High = 1
+    };
+
+    std::vector<WinToastArgumentsView::Pair> pairsOf(const WinToastArgumentsView &view) {
+        return {view.begin(), view.end()};
+    }
+}
+
+void WinToastTests::argumentsViewTests(Suite &suite) {
+    suite.add("arguments_view/get_integers", [] {
+        const WinToastArgumentsView view(L"i8=-128;u8=255;i16=-32768;u16=65535;i32=-2147483648;u32=4294967295;"
+                                         L"i64=-9223372036854775808;u64=18446744073709551615;zero=-0");
+        WINTOAST_CHECK_EQUAL(view.get<std::int8_t>(L"i8").value(), std::int8_t{-128});
+        WINTOAST_CHECK_EQUAL(view.get<std::uint8_t>(L"u8").value(), std::uint8_t{255});
+        WINTOAST_CHECK_EQUAL(view.get<std::int16_t>(L"i16"), std::optional<std::int16_t>(-32768));
+        WINTOAST_CHECK_EQUAL(view.get<std::uint16_t>(L"u16"), std::optional<std::uint16_t>(65535));
+        WINTOAST_CHECK_EQUAL(view.get<std::int32_t>(L"i32"), std::optional<std::int32_t>(INT32_MIN));
+        WINTOAST_CHECK_EQUAL(view.get<std::uint32_t>(L"u32"), std::optional<std::uint32_t>(UINT32_MAX));
+        WINTOAST_CHECK_EQUAL(view.get<std::int64_t>(L"i64"), std::optional<std::int64_t>(INT64_MIN));
+        WINTOAST_CHECK_EQUAL(view.get<std::uint64_t>(L"u64"), std::optional<std::uint64_t>(UINT64_MAX));
+        WINTOAST_CHECK_EQUAL(view.get<long>(L"zero"), std::optional<long>(0));
+        WINTOAST_CHECK_EQUAL(view.get<unsigned long long>(L"zero"), std::optional<unsigned long long>());
+        WINTOAST_CHECK_EQUAL(view.get<int>(L"missing"), std::optional<int>());
+    });
+
+    suite.add("arguments_view/get_overflow", [] {
+        const WinToastArgumentsView view(L"i8hi=128;i8lo=-129;u8=256;u16=65536;i32=2147483648;u32=4294967296;"
+                                         L"i64hi=9223372036854775808;i64lo=-9223372036854775809;"
+                                         L"u64=18446744073709551616;long=999999999999999999999999");
+        WINTOAST_CHECK(!view.get<std::int8_t>(L"i8hi"));
+        WINTOAST_CHECK(!view.get<std::int8_t>(L"i8lo"));
+        WINTOAST_CHECK(!view.get<std::uint8_t>(L"u8"));
+        WINTOAST_CHECK(!view.get<std::uint16_t>(L"u16"));
+        WINTOAST_CHECK(!view.get<std::int32_t>(L"i32"));
+        WINTOAST_CHECK(!view.get<std::uint32_t>(L"u32"));
+        WINTOAST_CHECK(!view.get<std::int64_t>(L"i64hi"));
+        WINTOAST_CHECK(!view.get<std::int64_t>(L"i64lo"));
+        WINTOAST_CHECK(!view.get<std::uint64_t>(L"u64"));
+        WINTOAST_CHECK(!view.get<std::uint64_t>(L"long"));
+        // Values out of range for one type still parse as a wider one.
+        WINTOAST_CHECK_EQUAL(view.get<std::int16_t>(L"i8hi"), std::optional<std::int16_t>(128));
+        WINTOAST_CHECK_EQUAL(view.get<std::int64_t>(L"i32"), std::optional<std::int64_t>(2147483648LL));
+    });
+
+    // The value has to be a number as a whole, without signs other than a leading minus, spaces or suffixes.
+    suite.add("arguments_view/get_not_numeric", [] {
+        const WinToastArgumentsView view(L"empty=;minus=-;plus=+1;space= 1;trailing=1 ;suffix=12a;hex=0x10;"
+                                         L"word=ten;negative=-5;decimal=1.5;encoded=%31");
+        for (const wchar_t *key: {L"empty", L"minus", L"plus", L"space", L"trailing", L"suffix", L"hex", L"word",
+                                  L"decimal", L"encoded"}) {
+            WINTOAST_CHECK(!view.get<int>(key));
+            WINTOAST_CHECK(!view.get<unsigned>(key));
+        }
+        WINTOAST_CHECK_EQUAL(view.get<int>(L"negative"), std::optional<int>(-5));
+        WINTOAST_CHECK(!view.get<unsigned>(L"negative"));
+        WINTOAST_CHECK(!view.get<std::uint64_t>(L"negative"));
+    });
+
+    suite.add("arguments_view/get_bool_and_enum", [] {
+        const WinToastArgumentsView view(L"t=true;f=false;one=1;nil=0;two=2;upper=TRUE;yes=yes;"
+                                         L"open=1;dismiss=200;big=300;low=-1");
+        WINTOAST_CHECK_EQUAL(view.get<bool>(L"t"), std::optional<bool>(true));
+        WINTOAST_CHECK_EQUAL(view.get<bool>(L"f"), std::optional<bool>(false));
+        WINTOAST_CHECK_EQUAL(view.get<bool>(L"one"), std::optional<bool>(true));
+        WINTOAST_CHECK_EQUAL(view.get<bool>(L"nil"), std::optional<bool>(false));
+        WINTOAST_CHECK(!view.get<bool>(L"two"));
+        WINTOAST_CHECK(!view.get<bool>(L"upper"));
+        WINTOAST_CHECK(!view.get<bool>(L"yes"));
+        WINTOAST_CHECK(!view.get<bool>(L"missing"));
+
+        WINTOAST_CHECK(view.get<Action>(L"open") == Action::Open);
+        WINTOAST_CHECK(view.get<Action>(L"dismiss") == Action::Dismiss);
+        // Enums are range checked against their underlying type.
+        WINTOAST_CHECK(!view.get<Action>(L"big"));
+        WINTOAST_CHECK(!view.get<Action>(L"low"));
+        WINTOAST_CHECK(view.get<Level>(L"low") == Low);
+        WINTOAST_CHECK(!view.get<Level>(L"t"));
+    });
+
+    suite.add("arguments_view/repeated_key", [] {
+        const WinToastArgumentsView view(L"k=1;other=x;k=2;k%3Dx=3;k=%3B");
+        WINTOAST_CHECK_EQUAL(view.find(L"k"), std::optional<std::wstring_view>(L"%3B"));
+        WINTOAST_CHECK_EQUAL(view.get(L"k"), std::wstring(L";"));
+        WINTOAST_CHECK_EQUAL(view.find(L"k=x"), std::optional<std::wstring_view>(L"3"));
+
+        const WinToastArgumentsView numbers(L"n=1;n=2");
+        WINTOAST_CHECK_EQUAL(numbers.get<int>(L"n"), std::optional<int>(2));
+        WINTOAST_CHECK_EQUAL(numbers.materialize().get(L"n"), std::wstring(L"2"));
+        WINTOAST_CHECK_EQUAL(numbers.materialize().size(), std::size_t{1});
+    });
+
+    suite.add("arguments_view/empty_values", [] {
+        const WinToastArgumentsView view(L"a=;b=1;=c");
+        WINTOAST_CHECK(view.contains(L"a"));
+        WINTOAST_CHECK_EQUAL(view.find(L"a"), std::optional<std::wstring_view>(L""));
+        WINTOAST_CHECK_EQUAL(view.get(L"a"), std::wstring());
+        WINTOAST_CHECK(!view.get<int>(L"a"));
+        WINTOAST_CHECK_EQUAL(view.find(L""), std::optional<std::wstring_view>(L"c"));
+        WINTOAST_CHECK(!view.contains(L"c"));
+
+        WINTOAST_CHECK(WinToastArgumentsView().empty());
+        WINTOAST_CHECK(WinToastArgumentsView(L"").empty());
+        WINTOAST_CHECK(WinToastArgumentsView(L"  ").empty());
+        WINTOAST_CHECK(!WinToastArgumentsView(L"").contains(L""));
+        WINTOAST_CHECK(!WinToastArgumentsView(L"x").empty());
+    });
+
+    suite.add("arguments_view/keys_without_value", [] {
+        const WinToastArgumentsView view(L"flag;x=1;;last");
+        const auto pairs = pairsOf(view);
+        WINTOAST_CHECK_EQUAL(pairs.size(), std::size_t{4});
+        WINTOAST_CHECK(pairs[0] == WinToastArgumentsView::Pair(L"flag", L""));
+        WINTOAST_CHECK(pairs[1] == WinToastArgumentsView::Pair(L"x", L"1"));
+        WINTOAST_CHECK(pairs[2] == WinToastArgumentsView::Pair(L"", L""));
+        WINTOAST_CHECK(pairs[3] == WinToastArgumentsView::Pair(L"last", L""));
+
+        WINTOAST_CHECK(view.contains(L"flag"));
+        WINTOAST_CHECK_EQUAL(view.find(L"last"), std::optional<std::wstring_view>(L""));
+        WINTOAST_CHECK(!view.get<bool>(L"flag"));
+    });
+
+    // Values without escape sequences are viewed in place, the others are decoded into the buffer.
+    suite.add("arguments_view/get_buffer", [] {
+        const std::wstring arguments = L"plain=text;encoded=a%3Bb";
+        const WinToastArgumentsView view(arguments);
+        std::wstring buffer;
+
+        const auto plain = view.get(L"plain", buffer);
+        WINTOAST_CHECK_EQUAL(plain, std::optional<std::wstring_view>(L"text"));
+        WINTOAST_CHECK(plain->data() >= arguments.data() && plain->data() < arguments.data() + arguments.size());
+        WINTOAST_CHECK(buffer.empty());
+
+        const auto encoded = view.get(L"encoded", buffer);
+        WINTOAST_CHECK_EQUAL(encoded, std::optional<std::wstring_view>(L"a;b"));
+        WINTOAST_CHECK(encoded->data() == buffer.data());
+
+        WINTOAST_CHECK(!view.get(L"missing", buffer));
+    });
+}
@@ -0,0 +1,284 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "async_submitter.h"
+#include "test.h"
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Clock = AsyncSubmitter::Clock;
+    using Scenario = WinToastTemplate::Scenario;
+
+    // A target recording what ran, in order. A toast whose first line is "gate" holds the submitter thread until
+    // open() is called, so the requests behind it queue up and get ordered.
+    class RecordingTarget {
+    public:
+        AsyncSubmitter::Target target() {
+            return {
+                    [this](const WinToastTemplate &toast, WinToast::WinToastError *error) -> INT64 {
+                        const std::wstring &line = toast.textField(WinToastTemplate::TextField::FirstLine);
+                        if (line == L"throw") {
+                            throw std::runtime_error("show failed");
+                        }
+                        std::unique_lock lock(_mutex);
+                        _ran.push_back(line);
+                        if (line == L"gate") {
+                            _gateReached = true;
+                            _changed.notify_all();
+                            _changed.wait(lock, [this] { return _gateOpen; });
+                        }
+                        *error = WinToast::WinToastError::NoError;
+                        return static_cast<INT64>(_ran.size());
+                    },
+                    [this](INT64 id) {
+                        std::lock_guard lock(_mutex);
+                        _ran.push_back(L"hide " + std::to_wstring(id));
+                        return id > 0;
+                    }
+            };
+        }
+
+        // Waits until the gate toast holds the submitter thread.
+        void waitForGate() {
+            std::unique_lock lock(_mutex);
+            _changed.wait(lock, [this] { return _gateReached; });
+        }
+
+        void open() {
+            {
+                std::lock_guard lock(_mutex);
+                _gateOpen = true;
+            }
+            _changed.notify_all();
+        }
+
+        [[nodiscard]] std::vector<std::wstring> ran() const {
+            std::lock_guard lock(_mutex);
+            return _ran;
+        }
+
+    private:
+        mutable std::mutex _mutex;
+        std::condition_variable _changed;
+        bool _gateReached = false;
+        bool _gateOpen = false;
+        std::vector<std::wstring> _ran;
+    };
+
+    WinToastTemplate makeToast(const wchar_t *text, Scenario scenario = Scenario::Default) {
+        WinToastTemplate toast(WinToastTemplate::WinToastTemplateType::Text01);
+        toast.setFirstLine(text);
+        toast.setScenario(scenario);
+        return toast;
+    }
+
+    std::vector<std::wstring> lines(std::initializer_list<const wchar_t *> texts) {
+        return {texts.begin(), texts.end()};
+    }
+
+    std::string describeLines(const std::vector<std::wstring> &ran) {
+        std::string text;
+        for (const std::wstring &line: ran) {
+            text += (text.empty() ? "" : ", ") + describe(line);
+        }
+        return "[" + text + "]";
+    }
+}
+
+void WinToastTests::asyncSubmitterTests(Suite &suite) {
+    suite.add("async_submitter/results", [] {
+        RecordingTarget recorder;
+        AsyncSubmitter submitter(recorder.target());
+        const WinToast::ShowResult shown = submitter.show(makeToast(L"first")).get();
+        WINTOAST_CHECK_EQUAL(shown.id, INT64{1});
+        WINTOAST_CHECK(shown.error == WinToast::WinToastError::NoError);
+        WINTOAST_CHECK(submitter.hide(shown.id).get());
+        WINTOAST_CHECK(!submitter.hide(-1).get());
+
+        // A throwing target fails the one request, the submitter keeps going.
+        const WinToast::ShowResult failed = submitter.show(makeToast(L"throw")).get();
+        WINTOAST_CHECK_EQUAL(failed.id, INT64{-1});
+        WINTOAST_CHECK(failed.error == WinToast::WinToastError::UnknownError);
+        WINTOAST_CHECK_EQUAL(submitter.show(makeToast(L"last")).get().id, INT64{4});
+    });
+
+    suite.add("async_submitter/fifo", [] {
+        RecordingTarget recorder;
+        std::vector<WinToastAsync<WinToast::ShowResult>> results;
+        {
+            AsyncSubmitter submitter(recorder.target());
+            results.push_back(submitter.show(makeToast(L"gate")));
+            recorder.waitForGate();
+            // Without priorities the scenario and the deadline don't reorder anything.
+            results.push_back(submitter.show(makeToast(L"a")));
+            results.push_back(submitter.show(makeToast(L"b", Scenario::IncomingCall)));
+            submitter.hide(1);
+            results.push_back(submitter.show(makeToast(L"c", Scenario::Alarm), Clock::now() + std::chrono::hours(1)));
+            recorder.open();
+        }
+        const std::vector<std::wstring> ran = recorder.ran();
+        WINTOAST_CHECK_EQUAL(describeLines(ran), describeLines(lines({L"gate", L"a", L"b", L"hide 1", L"c"})));
+        for (const auto &result: results) {
+            WINTOAST_CHECK(result.ready());
+        }
+    });
+
+    suite.add("async_submitter/priority", [] {
+        RecordingTarget recorder;
+        {
+            AsyncSubmitter submitter(recorder.target());
+            submitter.setPrioritized(true);
+            submitter.show(makeToast(L"gate"));
+            recorder.waitForGate();
+
+            const Clock::time_point soon = Clock::now() + std::chrono::hours(1);
+            const Clock::time_point later = soon + std::chrono::hours(1);
+            submitter.show(makeToast(L"default"));
+            submitter.show(makeToast(L"reminder later", Scenario::Reminder), later);
+            submitter.show(makeToast(L"alarm", Scenario::Alarm));
+            submitter.show(makeToast(L"reminder soon", Scenario::Reminder), soon);
+            submitter.show(makeToast(L"reminder", Scenario::Reminder));
+            submitter.show(makeToast(L"call", Scenario::IncomingCall));
+            submitter.hide(1);
+            submitter.hide(2);
+            recorder.open();
+        }
+        // Hides first, in order, then the shows by priority class, within one by deadline and then in order.
+        WINTOAST_CHECK_EQUAL(describeLines(recorder.ran()),
+                             describeLines(lines({L"gate", L"hide 1", L"hide 2", L"call", L"alarm", L"reminder soon",
+                                                  L"reminder later", L"reminder", L"default"})));
+    });
+
+    suite.add("async_submitter/priority_of", [] {
+        WINTOAST_CHECK(AsyncSubmitter::priorityOf(makeToast(L"", Scenario::IncomingCall)) >
+                       AsyncSubmitter::priorityOf(makeToast(L"", Scenario::Alarm)));
+        WINTOAST_CHECK(AsyncSubmitter::priorityOf(makeToast(L"", Scenario::Alarm)) >
+                       AsyncSubmitter::priorityOf(makeToast(L"", Scenario::Reminder)));
+        WINTOAST_CHECK(AsyncSubmitter::priorityOf(makeToast(L"", Scenario::Reminder)) >
+                       AsyncSubmitter::priorityOf(makeToast(L"")));
+    });
+
+    suite.add("async_submitter/deadline", [] {
+        RecordingTarget recorder;
+        AsyncSubmitter submitter(recorder.target());
+        submitter.show(makeToast(L"gate"));
+        recorder.waitForGate();
+        auto expired = submitter.show(makeToast(L"expired"), Clock::now() - std::chrono::seconds(1));
+        auto inTime = submitter.show(makeToast(L"in time"), Clock::now() + std::chrono::hours(1));
+        // Requests count as submitted once queued, before they run.
+        WINTOAST_CHECK_EQUAL(submitter.stats().submitted, std::uint64_t{3});
+        WINTOAST_CHECK_EQUAL(submitter.stats().queueDepth, std::size_t{2});
+        recorder.open();
+
+        WINTOAST_CHECK(expired.get().error == WinToast::WinToastError::DeadlineExpired);
+        WINTOAST_CHECK_EQUAL(expired.get().id, INT64{-1});
+        WINTOAST_CHECK(inTime.get().error == WinToast::WinToastError::NoError);
+        WINTOAST_CHECK_EQUAL(describeLines(recorder.ran()), describeLines(lines({L"gate", L"in time"})));
+
+        const WinToast::SubmissionStats stats = submitter.stats();
+        WINTOAST_CHECK_EQUAL(stats.submitted, std::uint64_t{3});
+        WINTOAST_CHECK_EQUAL(stats.dropped, std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(stats.queueDepth, std::size_t{0});
+        WINTOAST_CHECK_EQUAL(stats.maxQueueDepth, std::size_t{2});
+    });
+
+    suite.add("async_submitter/then", [] {
+        RecordingTarget recorder;
+        AsyncSubmitter submitter(recorder.target());
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<INT64> ids;
+        std::thread::id continuationThread;
+
+        auto pending = submitter.show(makeToast(L"gate"));
+        recorder.waitForGate();
+        pending.then([&](const WinToast::ShowResult &result) {
+            std::lock_guard lock(mutex);
+            ids.push_back(result.id);
+            continuationThread = std::this_thread::get_id();
+            done.notify_all();
+        });
+        recorder.open();
+        {
+            std::unique_lock lock(mutex);
+            done.wait(lock, [&] { return !ids.empty(); });
+        }
+        // Subscribed before the result was there, so the continuation ran on the submitter thread.
+        WINTOAST_CHECK(continuationThread != std::this_thread::get_id());
+
+        // Subscribed afterwards, it runs right away on the calling thread.
+        pending.then([&](const WinToast::ShowResult &result) {
+            ids.push_back(result.id);
+            continuationThread = std::this_thread::get_id();
+        });
+        WINTOAST_CHECK(continuationThread == std::this_thread::get_id());
+        WINTOAST_CHECK_EQUAL(ids.size(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(ids[1], INT64{1});
+    });
+
+    suite.add("async_submitter/future", [] {
+        RecordingTarget recorder;
+        AsyncSubmitter submitter(recorder.target());
+        auto pending = submitter.show(makeToast(L"gate"));
+        recorder.waitForGate();
+        std::future<WinToast::ShowResult> before = pending.future();
+        recorder.open();
+        WINTOAST_CHECK_EQUAL(before.get().id, INT64{1});
+        // Asked for once the result is there, the future is ready right away.
+        std::future<WinToast::ShowResult> after = pending.future();
+        WINTOAST_CHECK(after.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        WINTOAST_CHECK_EQUAL(after.get().id, INT64{1});
+    });
+
+    // A throwing continuation is skipped: the next one still runs and so do the requests behind it.
+    suite.add("async_submitter/throwing_continuation", [] {
+        RecordingTarget recorder;
+        AsyncSubmitter submitter(recorder.target());
+        std::mutex mutex;
+        std::vector<INT64> ids;
+
+        auto pending = submitter.show(makeToast(L"gate"));
+        recorder.waitForGate();
+        pending.then([](const WinToast::ShowResult &) {
+            throw std::runtime_error("continuation failed");
+        });
+        pending.then([&](const WinToast::ShowResult &result) {
+            std::lock_guard lock(mutex);
+            ids.push_back(result.id);
+        });
+        auto later = submitter.show(makeToast(L"later"));
+        recorder.open();
+
+        WINTOAST_CHECK_EQUAL(later.get().id, INT64{2});
+        std::lock_guard lock(mutex);
+        WINTOAST_CHECK_EQUAL(ids.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(ids.empty() ? INT64{-1} : ids[0], INT64{1});
+    });
+}
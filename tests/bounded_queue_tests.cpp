@@ -0,0 +1,119 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "bounded_queue.h"
+#include "test.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    std::uint64_t valueOf(std::size_t producer, std::uint64_t sequence) {
+        return (static_cast<std::uint64_t>(producer) << 32) | sequence;
+    }
+
+    // Producers push numbered values, retrying while the queue is full, and the single consumer checks that
+    // every value arrives exactly once and in the order its producer pushed it.
+    void stress(std::size_t producers, std::size_t capacity, std::uint64_t valuesPerProducer) {
+        BoundedQueue<std::uint64_t> queue(capacity);
+        std::vector<std::thread> threads;
+        for (std::size_t producer = 0; producer < producers; producer++) {
+            threads.emplace_back([&queue, producer, valuesPerProducer] {
+                for (std::uint64_t sequence = 0; sequence < valuesPerProducer; sequence++) {
+                    while (!queue.push(valueOf(producer, sequence))) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<std::uint64_t> next(producers, 0);
+        std::uint64_t outOfOrder = 0;
+        std::uint64_t received = 0;
+        const std::uint64_t total = producers * valuesPerProducer;
+        while (received < total) {
+            std::uint64_t value;
+            if (!queue.pop(value)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const std::size_t producer = static_cast<std::size_t>(value >> 32);
+            if (producer >= producers || (value & 0xffffffffu) != next[producer]) {
+                outOfOrder++;
+            } else {
+                next[producer]++;
+            }
+            received++;
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        WINTOAST_CHECK_EQUAL(outOfOrder, std::uint64_t{0});
+        for (std::size_t producer = 0; producer < producers; producer++) {
+            WINTOAST_CHECK_EQUAL(next[producer], valuesPerProducer);
+        }
+        WINTOAST_CHECK(queue.empty());
+    }
+}
+
+void WinToastTests::boundedQueueTests(Suite &suite) {
+    suite.add("bounded_queue/capacity", [] {
+        WINTOAST_CHECK_EQUAL(BoundedQueue<int>(0).capacity(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(BoundedQueue<int>(2).capacity(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(BoundedQueue<int>(100).capacity(), std::size_t{128});
+    });
+
+    suite.add("bounded_queue/full_and_empty", [] {
+        BoundedQueue<int> queue(4);
+        int value = -1;
+        WINTOAST_CHECK(queue.empty());
+        WINTOAST_CHECK(!queue.pop(value));
+        WINTOAST_CHECK_EQUAL(value, -1);
+
+        // Around the ring a few times, the values come out in order.
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < 4; i++) {
+                WINTOAST_CHECK(queue.push(round * 4 + i));
+            }
+            int rejected = 99;
+            WINTOAST_CHECK(!queue.push(std::move(rejected)));
+            WINTOAST_CHECK(!queue.empty());
+            for (int i = 0; i < 4; i++) {
+                WINTOAST_CHECK(queue.pop(value));
+                WINTOAST_CHECK_EQUAL(value, round * 4 + i);
+            }
+            WINTOAST_CHECK(queue.empty());
+        }
+    });
+
+    suite.add("bounded_queue/concurrent_producers", [] {
+        stress(8, 1024, 20000);
+    });
+
+    // A queue much smaller than the number of values in flight keeps the producers running into a full queue.
+    suite.add("bounded_queue/concurrent_producers_full", [] {
+        stress(8, 16, 5000);
+    });
+}
@@ -0,0 +1,192 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "toast_deduplicator.h"
+#include "toast_pipeline.h"
+#include "loopback_backend.h"
+
+#include <memory>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Clock = ToastDeduplicator::Clock;
+
+    const auto AlwaysLive = [](INT64) { return true; };
+
+    WinToastTemplate makeToast(const wchar_t *text) {
+        WinToastTemplate toast(WinToastTemplate::WinToastTemplateType::Text02);
+        toast.setFirstLine(text);
+        toast.setSecondLine(L"details");
+        return toast;
+    }
+
+    constexpr std::chrono::seconds Window(10);
+
+    // Fails to hide toasts while refuseHide is set, like the platform can, leaving them live.
+    class StubbornBackend : public LoopbackBackend {
+    public:
+        bool hide(INT64 id) override {
+            return !refuseHide && LoopbackBackend::hide(id);
+        }
+
+        bool refuseHide = false;
+    };
+}
+
+void WinToastTests::deduplicatorTests(Suite &suite) {
+    suite.add("deduplicator/hash", [] {
+        const auto first = ToastDeduplicator::hash(makeToast(L"disk full"));
+        const auto same = ToastDeduplicator::hash(makeToast(L"disk full"));
+        const auto other = ToastDeduplicator::hash(makeToast(L"disk fulL"));
+        WINTOAST_CHECK(first.value == same.value && first.check == same.check);
+        WINTOAST_CHECK(first.value != other.value);
+        WINTOAST_CHECK(first.check != other.check);
+
+        // Text moving from one field to the next is a different toast.
+        WinToastTemplate split(WinToastTemplate::WinToastTemplateType::Text02);
+        split.setFirstLine(L"ab");
+        split.setSecondLine(L"c");
+        WinToastTemplate shifted(WinToastTemplate::WinToastTemplateType::Text02);
+        shifted.setFirstLine(L"a");
+        shifted.setSecondLine(L"bc");
+        WINTOAST_CHECK(ToastDeduplicator::hash(split).value != ToastDeduplicator::hash(shifted).value);
+    });
+
+    suite.add("deduplicator/window", [] {
+        ToastDeduplicator deduplicator;
+        deduplicator.setWindow(Window);
+        const auto start = Clock::now();
+        const ToastDeduplicator::Hash hash{1, 2};
+        WINTOAST_CHECK(!deduplicator.find(hash, AlwaysLive, start));
+        deduplicator.remember(hash, 42, start);
+
+        WINTOAST_CHECK_EQUAL(deduplicator.find(hash, AlwaysLive, start + std::chrono::seconds(9)).value_or(-1),
+                             INT64{42});
+        WINTOAST_CHECK(!deduplicator.find(hash, AlwaysLive, start + std::chrono::seconds(10)));
+        WINTOAST_CHECK_EQUAL(deduplicator.suppressed(), std::uint64_t{1});
+    });
+
+    suite.add("deduplicator/collision", [] {
+        // Same first hash, different check: a different toast, which must not be suppressed.
+        ToastDeduplicator deduplicator;
+        deduplicator.setWindow(Window);
+        deduplicator.remember({7, 100}, 1);
+        WINTOAST_CHECK(!deduplicator.find({7, 200}, AlwaysLive));
+        WINTOAST_CHECK_EQUAL(deduplicator.suppressed(), std::uint64_t{0});
+
+        // The colliding toast takes the entry over once shown.
+        deduplicator.remember({7, 200}, 2);
+        WINTOAST_CHECK_EQUAL(deduplicator.find({7, 200}, AlwaysLive).value_or(-1), INT64{2});
+        WINTOAST_CHECK(!deduplicator.find({7, 100}, AlwaysLive));
+
+        // Forgetting the replaced toast leaves its successor alone.
+        deduplicator.forget(1);
+        WINTOAST_CHECK_EQUAL(deduplicator.find({7, 200}, AlwaysLive).value_or(-1), INT64{2});
+    });
+
+    suite.add("deduplicator/forget", [] {
+        ToastDeduplicator deduplicator;
+        deduplicator.setWindow(Window);
+        deduplicator.remember({1, 1}, 10);
+        deduplicator.remember({2, 2}, 20);
+        deduplicator.forget(10);
+        deduplicator.forget(99);
+        WINTOAST_CHECK(!deduplicator.find({1, 1}, AlwaysLive));
+        WINTOAST_CHECK_EQUAL(deduplicator.find({2, 2}, AlwaysLive).value_or(-1), INT64{20});
+
+        deduplicator.forgetAll();
+        WINTOAST_CHECK(!deduplicator.find({2, 2}, AlwaysLive));
+    });
+
+    suite.add("deduplicator/gone", [] {
+        // A toast the backend no longer has, like one the user dismissed, is forgotten on lookup.
+        ToastDeduplicator deduplicator;
+        deduplicator.setWindow(Window);
+        deduplicator.remember({1, 1}, 10);
+        int lookups = 0;
+        WINTOAST_CHECK(!deduplicator.find({1, 1}, [&](INT64 id) {
+            lookups++;
+            return id != 10;
+        }));
+        WINTOAST_CHECK(!deduplicator.find({1, 1}, AlwaysLive));
+        WINTOAST_CHECK_EQUAL(lookups, 1);
+        WINTOAST_CHECK_EQUAL(deduplicator.suppressed(), std::uint64_t{0});
+    });
+
+    suite.add("deduplicator/pipeline", [] {
+        auto backend = std::make_unique<LoopbackBackend>();
+        LoopbackBackend &loopback = *backend;
+        ToastPipeline pipeline(std::move(backend));
+        pipeline.setDeduplicationWindow(std::chrono::hours(1));
+        const WinToastTemplate toast = makeToast(L"disk full");
+        WinToast::WinToastError error;
+
+        const INT64 first = pipeline.show(toast, true, error);
+        WINTOAST_CHECK_EQUAL(pipeline.show(toast, true, error), first);
+        WINTOAST_CHECK_EQUAL(loopback.shownCount(), std::uint64_t{1});
+
+        // Once hidden, the next duplicate is a new toast.
+        WINTOAST_CHECK(pipeline.hide(first));
+        const INT64 second = pipeline.show(toast, true, error);
+        WINTOAST_CHECK(second != first);
+
+        // The same goes for toasts gone behind the pipeline's back.
+        loopback.hide(second);
+        const INT64 third = pipeline.show(toast, true, error);
+        WINTOAST_CHECK(third != second);
+
+        pipeline.clear();
+        const INT64 fourth = pipeline.show(toast, true, error);
+        WINTOAST_CHECK(fourth != third);
+
+        const WinToastTemplate batch[] = {toast, toast, makeToast(L"cpu hot")};
+        const auto results = pipeline.show(batch, 3, true);
+        WINTOAST_CHECK_EQUAL(results[0].id, fourth);
+        WINTOAST_CHECK_EQUAL(results[1].id, fourth);
+        WINTOAST_CHECK(results[2].id != fourth);
+        WINTOAST_CHECK_EQUAL(loopback.shownCount(), std::uint64_t{5});
+        WINTOAST_CHECK_EQUAL(pipeline.suppressedDuplicates(), std::uint64_t{3});
+    });
+
+    // A toast that is still on screen because hiding it failed keeps suppressing its duplicates.
+    suite.add("deduplicator/failed_hide", [] {
+        auto backend = std::make_unique<StubbornBackend>();
+        StubbornBackend &stubborn = *backend;
+        ToastPipeline pipeline(std::move(backend));
+        pipeline.setDeduplicationWindow(std::chrono::hours(1));
+        const WinToastTemplate toast = makeToast(L"disk full");
+        WinToast::WinToastError error;
+
+        const INT64 first = pipeline.show(toast, true, error);
+        stubborn.refuseHide = true;
+        WINTOAST_CHECK(!pipeline.hide(first));
+        WINTOAST_CHECK(stubborn.isLive(first));
+        WINTOAST_CHECK_EQUAL(pipeline.show(toast, true, error), first);
+        WINTOAST_CHECK_EQUAL(stubborn.shownCount(), std::uint64_t{1});
+
+        stubborn.refuseHide = false;
+        WINTOAST_CHECK(pipeline.hide(first));
+        WINTOAST_CHECK(pipeline.show(toast, true, error) != first);
+        WINTOAST_CHECK_EQUAL(stubborn.shownCount(), std::uint64_t{2});
+    });
+}
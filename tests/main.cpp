@@ -0,0 +1,72 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace WinToastTests;
+
+namespace {
+    void printUsage() {
+        std::fprintf(stderr, "WinToastTests [--filter=TEXT]\n"
+                             "\t--filter : Only run the test cases whose name contains TEXT\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string filter;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Test cases report their own failures, and some provoke errors on purpose.
+    WinToastLib::Trace::setFilter(WinToastLib::WinToast::TraceLevel::Off, 0);
+
+    Suite suite(filter);
+    serializerTests(suite);
+    pipelineTests(suite);
+    deduplicatorTests(suite);
+    scheduleIndexTests(suite);
+    registryTests(suite);
+    notifierCacheTests(suite);
+    boundedQueueTests(suite);
+    asyncSubmitterTests(suite);
+    templateTests(suite);
+    traceTests(suite);
+    workerPoolTests(suite);
+    activationDispatcherTests(suite);
+    timingWheelTests(suite);
+    percentCodecTests(suite);
+    argumentsViewTests(suite);
+    argumentsTests(suite);
+    activationTests(suite);
+    pipelineStatsTests(suite);
+
+    return suite.run() == 0 ? 0 : 1;
+}
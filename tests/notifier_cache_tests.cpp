@@ -0,0 +1,100 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "notifier_cache.h"
+#include "test.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    // Stands in for the WinRT notifier: remembers which AUMI it was made for.
+    struct FakeNotifier {
+        std::wstring aumi;
+        int serial;
+    };
+
+    // A cache whose factory counts the notifiers it creates.
+    struct CountingCache {
+        std::shared_ptr<int> created = std::make_shared<int>(0);
+        NotifierCache<FakeNotifier> cache{[created = created](const std::wstring &aumi) {
+            return FakeNotifier{aumi, ++*created};
+        }};
+    };
+}
+
+void WinToastTests::notifierCacheTests(Suite &suite) {
+    suite.add("notifier_cache/reuse", [] {
+        CountingCache counting;
+        for (int i = 0; i < 10; i++) {
+            WINTOAST_CHECK_EQUAL(counting.cache.get(L"App.Id").serial, 1);
+        }
+        WINTOAST_CHECK_EQUAL(*counting.created, 1);
+        WINTOAST_CHECK_EQUAL(counting.cache.misses(), std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(counting.cache.hits(), std::uint64_t{9});
+    });
+
+    suite.add("notifier_cache/aumi_change", [] {
+        CountingCache counting;
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"First.App").aumi, std::wstring(L"First.App"));
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"Second.App").aumi, std::wstring(L"Second.App"));
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"Second.App").serial, 2);
+        // Only the notifier of the current AUMI is kept.
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"First.App").serial, 3);
+        WINTOAST_CHECK_EQUAL(counting.cache.misses(), std::uint64_t{3});
+        WINTOAST_CHECK_EQUAL(counting.cache.hits(), std::uint64_t{1});
+    });
+
+    suite.add("notifier_cache/invalidate", [] {
+        CountingCache counting;
+        counting.cache.get(L"App.Id");
+        counting.cache.invalidate();
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"App.Id").serial, 2);
+        WINTOAST_CHECK_EQUAL(counting.cache.get(L"App.Id").serial, 2);
+        WINTOAST_CHECK_EQUAL(counting.cache.misses(), std::uint64_t{2});
+        WINTOAST_CHECK_EQUAL(counting.cache.hits(), std::uint64_t{1});
+    });
+
+    suite.add("notifier_cache/concurrent", [] {
+        constexpr int Threads = 8;
+        constexpr int CallsPerThread = 1000;
+        CountingCache counting;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < Threads; i++) {
+            threads.emplace_back([&counting] {
+                for (int call = 0; call < CallsPerThread; call++) {
+                    counting.cache.get(L"App.Id");
+                }
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        // However the calls interleave, the notifier is made once and every other call is a hit.
+        WINTOAST_CHECK_EQUAL(*counting.created, 1);
+        WINTOAST_CHECK_EQUAL(counting.cache.misses(), std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(counting.cache.hits(), std::uint64_t{Threads * CallsPerThread - 1});
+    });
+}
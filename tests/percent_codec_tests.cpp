@@ -0,0 +1,134 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "percent_codec.h"
+#include "test.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    constexpr std::wstring_view Reserved = L"%;=\"'<>&";
+
+    // One character at a time, what the vectorized scan in the codec has to agree with.
+    std::wstring encodeScalar(std::wstring_view value) {
+        std::wstring encoded;
+        for (const wchar_t c: value) {
+            switch (c) {
+                case L'%': encoded += L"%25"; break;
+                case L';': encoded += L"%3B"; break;
+                case L'=': encoded += L"%3D"; break;
+                case L'"': encoded += L"%22"; break;
+                case L'\'': encoded += L"%27"; break;
+                case L'<': encoded += L"%3C"; break;
+                case L'>': encoded += L"%3E"; break;
+                case L'&': encoded += L"%26"; break;
+                default: encoded += c; break;
+            }
+        }
+        return encoded;
+    }
+
+    void checkRoundTrip(std::wstring_view value) {
+        const std::wstring encoded = PercentCodec::encode(value);
+        WINTOAST_CHECK_EQUAL(encoded, encodeScalar(value));
+        WINTOAST_CHECK_EQUAL(PercentCodec::encodedSize(value), encoded.size());
+        WINTOAST_CHECK_EQUAL(PercentCodec::decode(encoded), std::wstring(value));
+        WINTOAST_CHECK_EQUAL(PercentCodec::decodedSize(encoded), value.size());
+        WINTOAST_CHECK(PercentCodec::equalsDecoded(encoded, value));
+    }
+}
+
+void WinToastTests::percentCodecTests(Suite &suite) {
+    suite.add("percent_codec/round_trip", [] {
+        checkRoundTrip(L"");
+        checkRoundTrip(L"plain");
+        checkRoundTrip(Reserved);
+        checkRoundTrip(L"action=reply;text=\"100% <sure> & 'done'\"");
+        checkRoundTrip(L"%25 is already encoded");
+        checkRoundTrip(L"Café ☕ \U0001F600");
+        WINTOAST_CHECK_EQUAL(PercentCodec::encode(L"a=b;c"), std::wstring(L"a%3Db%3Bc"));
+    });
+
+    // Only the eight uppercase sequences the encoder writes are decoded, anything else stays as it is.
+    suite.add("percent_codec/malformed", [] {
+        const std::wstring_view untouched[] = {L"%", L"%%", L"%G1", L"%2", L"ab%4", L"%3b", L"%2F", L"100%", L"%%3"};
+        for (const std::wstring_view value: untouched) {
+            WINTOAST_CHECK_EQUAL(PercentCodec::decode(value), std::wstring(value));
+            WINTOAST_CHECK_EQUAL(PercentCodec::decodedSize(value), value.size());
+            WINTOAST_CHECK(PercentCodec::equalsDecoded(value, value));
+        }
+
+        const std::pair<std::wstring_view, std::wstring_view> decoded[] = {
+                {L"%%25", L"%%"},
+                {L"%2525", L"%25"},
+                {L"x%3D%4", L"x=%4"},
+                {L"%3C%3E%26%27%22", L"<>&'\""},
+        };
+        for (const auto &[encoded, expected]: decoded) {
+            WINTOAST_CHECK_EQUAL(PercentCodec::decode(encoded), std::wstring(expected));
+            WINTOAST_CHECK_EQUAL(PercentCodec::decodedSize(encoded), expected.size());
+            WINTOAST_CHECK(PercentCodec::equalsDecoded(encoded, expected));
+        }
+    });
+
+    suite.add("percent_codec/equals_decoded", [] {
+        WINTOAST_CHECK(PercentCodec::equalsDecoded(L"a%3Db", L"a=b"));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"a%3Db", L"a%3Db"));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"a%3Db", L"a=c"));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"a%3Db", L"a="));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"a%3D", L"a=b"));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"abc", L"ab"));
+        WINTOAST_CHECK(!PercentCodec::equalsDecoded(L"ab", L"abc"));
+        WINTOAST_CHECK(PercentCodec::equalsDecoded(L"", L""));
+        WINTOAST_CHECK(!PercentCodec::needsDecoding(L"plain"));
+        WINTOAST_CHECK(PercentCodec::needsDecoding(L"%"));
+    });
+
+    // The scan for reserved characters runs over 16 or 32 byte vectors and finishes one character at a time, a
+    // reserved character at any position of any length around those widths has to be found.
+    suite.add("percent_codec/vector_boundaries", [] {
+        for (std::size_t length = 0; length <= 40; length++) {
+            for (std::size_t pos = 0; pos < length; pos++) {
+                for (const wchar_t c: Reserved) {
+                    std::wstring value(length, L'a');
+                    value[pos] = c;
+                    checkRoundTrip(value);
+                }
+            }
+        }
+
+        std::mt19937 random(12345);
+        std::uniform_int_distribution<int> pick(0, 15);
+        for (int round = 0; round < 2000; round++) {
+            std::wstring value(random() % 100, L'x');
+            for (wchar_t &c: value) {
+                const int choice = pick(random);
+                c = choice < 8 ? Reserved[static_cast<std::size_t>(choice)] : static_cast<wchar_t>(L'0' + choice);
+            }
+            checkRoundTrip(value);
+        }
+    });
+}
@@ -0,0 +1,128 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "pipeline_stats.h"
+#include "test.h"
+
+#include <cstdint>
+#include <future>
+#include <thread>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Stage = WinToast::Stage;
+
+    // What was recorded between two snapshots, the counters are shared by everything in the process.
+    WinToast::Stats difference(const WinToast::Stats &after, const WinToast::Stats &before) {
+        WinToast::Stats stats{};
+        for (std::size_t stage = 0; stage < WinToast::StageCount; stage++) {
+            for (std::size_t bucket = 0; bucket < stats.stages[stage].buckets.size(); bucket++) {
+                stats.stages[stage].buckets[bucket] =
+                        after.stages[stage].buckets[bucket] - before.stages[stage].buckets[bucket];
+            }
+            stats.stages[stage].count = after.stages[stage].count - before.stages[stage].count;
+            stats.stages[stage].totalNs = after.stages[stage].totalNs - before.stages[stage].totalNs;
+        }
+        return stats;
+    }
+}
+
+void WinToastTests::pipelineStatsTests(Suite &suite) {
+    suite.add("pipeline_stats/percentiles", [] {
+        WinToast::LatencyHistogram histogram{};
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(0.5), std::uint64_t{0});
+
+        histogram.buckets[3] = 1;
+        histogram.buckets[5] = 2;
+        histogram.buckets[63] = 1;
+        histogram.count = 4;
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(0), std::uint64_t{8});
+        // The p-th percentile is sample p * (count - 1) in order, counting from zero and rounding down.
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(0.33), std::uint64_t{8});
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(0.34), std::uint64_t{32});
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(0.99), std::uint64_t{32});
+        WINTOAST_CHECK_EQUAL(histogram.percentileNs(1), std::uint64_t{UINT64_MAX});
+    });
+
+    // One thread records and exits before the snapshot, the other is still running when it is taken: the
+    // snapshot has to hold both, the first through what finished threads left behind.
+    suite.add("pipeline_stats/threads", [] {
+        const WinToast::Stats before = PipelineStats::snapshot();
+
+        std::thread([] {
+            PipelineStats::record(Stage::Serialize, 0);
+            PipelineStats::record(Stage::Serialize, 1);
+            for (int i = 0; i < 3; i++) {
+                PipelineStats::record(Stage::Serialize, 1000);
+            }
+            PipelineStats::record(Stage::Show, 5);
+        }).join();
+
+        std::promise<void> recorded;
+        std::promise<void> release;
+        std::thread running([&recorded, released = release.get_future()] {
+            PipelineStats::record(Stage::Serialize, 1023);
+            PipelineStats::record(Stage::Serialize, 1024);
+            PipelineStats::record(Stage::Serialize, std::uint64_t{1} << 40);
+            PipelineStats::record(Stage::Serialize, std::uint64_t{1} << 62);
+            recorded.set_value();
+            released.wait();
+        });
+        recorded.get_future().wait();
+
+        const WinToast::Stats stats = difference(PipelineStats::snapshot(), before);
+        release.set_value();
+        running.join();
+
+        const WinToast::LatencyHistogram &serialize = stats[Stage::Serialize];
+        WINTOAST_CHECK_EQUAL(serialize.count, std::uint64_t{9});
+        WINTOAST_CHECK_EQUAL(serialize.totalNs,
+                             std::uint64_t{1 + 3 * 1000 + 1023 + 1024} + (std::uint64_t{1} << 40) +
+                             (std::uint64_t{1} << 62));
+        // Bucket i holds [2^(i-1), 2^i), the last one everything from 2^62 up.
+        WINTOAST_CHECK_EQUAL(serialize.buckets[0], std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(serialize.buckets[1], std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(serialize.buckets[10], std::uint64_t{4});
+        WINTOAST_CHECK_EQUAL(serialize.buckets[11], std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(serialize.buckets[41], std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(serialize.buckets[63], std::uint64_t{1});
+
+        WINTOAST_CHECK_EQUAL(serialize.percentileNs(0), std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(serialize.percentileNs(0.5), std::uint64_t{1024});
+        WINTOAST_CHECK_EQUAL(serialize.percentileNs(0.75), std::uint64_t{2048});
+        WINTOAST_CHECK_EQUAL(serialize.percentileNs(0.9), std::uint64_t{1} << 41);
+        WINTOAST_CHECK_EQUAL(serialize.percentileNs(1), std::uint64_t{UINT64_MAX});
+
+        const WinToast::LatencyHistogram &show = stats[Stage::Show];
+        WINTOAST_CHECK_EQUAL(show.count, std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(show.totalNs, std::uint64_t{5});
+        WINTOAST_CHECK_EQUAL(show.buckets[3], std::uint64_t{1});
+        WINTOAST_CHECK_EQUAL(stats[Stage::Register].count, std::uint64_t{0});
+        WINTOAST_CHECK_EQUAL(stats[Stage::Register].percentileNs(0.5), std::uint64_t{0});
+
+        // Once the second thread exited too, its counters moved over without being lost or counted twice.
+        const WinToast::Stats finished = difference(PipelineStats::snapshot(), before);
+        WINTOAST_CHECK_EQUAL(finished[Stage::Serialize].count, std::uint64_t{9});
+        WINTOAST_CHECK_EQUAL(finished[Stage::Serialize].totalNs, serialize.totalNs);
+        WINTOAST_CHECK(finished[Stage::Serialize].buckets == serialize.buckets);
+    });
+}
@@ -0,0 +1,186 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "toast_pipeline.h"
+#include "loopback_backend.h"
+#include "toast_xml_serializer.h"
+#include "file_time.h"
+
+#include <memory>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+
+    // A pipeline over a loopback backend, which stays reachable for inspection.
+    struct LoopbackPipeline {
+        LoopbackPipeline() : LoopbackPipeline(std::make_unique<LoopbackBackend>()) {}
+
+        LoopbackBackend &loopback;
+        ToastPipeline pipeline;
+
+    private:
+        explicit LoopbackPipeline(std::unique_ptr<LoopbackBackend> backend)
+                : loopback(*backend), pipeline(std::move(backend)) {}
+    };
+
+    WinToastTemplate makeToast(const wchar_t *text) {
+        WinToastTemplate toast(Type::Text01);
+        toast.setFirstLine(text);
+        return toast;
+    }
+
+    std::wstring payloadOf(const WinToastTemplate &toast) {
+        std::wstring buffer;
+        ToastXmlSerializer::serialize(toast, true, buffer);
+        return buffer;
+    }
+}
+
+void WinToastTests::pipelineTests(Suite &suite) {
+    suite.add("pipeline/show_and_hide", [] {
+        LoopbackPipeline loopback;
+        const WinToastTemplate toast = makeToast(L"Hello");
+        WinToast::WinToastError error = WinToast::WinToastError::UnknownError;
+        const INT64 id = loopback.pipeline.show(toast, true, error);
+        WINTOAST_CHECK(id >= 0);
+        WINTOAST_CHECK(error == WinToast::WinToastError::NoError);
+
+        const auto record = loopback.loopback.find(id);
+        WINTOAST_CHECK(record.has_value());
+        WINTOAST_CHECK_EQUAL(record->xml, payloadOf(toast));
+        WINTOAST_CHECK_EQUAL(record->expiration, INT64{0});
+
+        WINTOAST_CHECK(loopback.pipeline.hide(id));
+        WINTOAST_CHECK(!loopback.pipeline.hide(id));
+        WINTOAST_CHECK_EQUAL(loopback.loopback.liveCount(), std::size_t{0});
+        WINTOAST_CHECK_EQUAL(loopback.loopback.hiddenCount(), std::uint64_t{1});
+    });
+
+    suite.add("pipeline/legacy_payload", [] {
+        LoopbackPipeline loopback;
+        WinToastTemplate toast = makeToast(L"Hello");
+        toast.addAction(L"Open");
+        WinToast::WinToastError error;
+        const INT64 id = loopback.pipeline.show(toast, false, error);
+
+        std::wstring legacy;
+        ToastXmlSerializer::serialize(toast, false, legacy);
+        WINTOAST_CHECK_EQUAL(loopback.loopback.find(id)->xml, legacy);
+    });
+
+    suite.add("pipeline/expiration", [] {
+        LoopbackPipeline loopback;
+        WinToastTemplate toast = makeToast(L"Soon gone");
+        toast.setExpiration(60000);
+        const INT64 before = FileTime::now();
+        WinToast::WinToastError error;
+        const INT64 id = loopback.pipeline.show(toast, true, error);
+        const INT64 after = FileTime::now();
+
+        // The expiration is handed to the backend as an absolute FILETIME.
+        const INT64 expiration = loopback.loopback.find(id)->expiration;
+        WINTOAST_CHECK(expiration >= before + 60000 * 10000);
+        WINTOAST_CHECK(expiration <= after + 60000 * 10000);
+    });
+
+    suite.add("pipeline/payload_error", [] {
+        LoopbackPipeline loopback;
+        WinToastTemplate toast(Type::ImageAndText01);
+        toast.setImagePath(std::wstring(300, L'a'));
+        WinToast::WinToastError error = WinToast::WinToastError::NoError;
+        WINTOAST_CHECK_EQUAL(loopback.pipeline.show(toast, true, error), INT64{-1});
+        WINTOAST_CHECK(error == WinToast::WinToastError::UnknownError);
+        WINTOAST_CHECK_EQUAL(loopback.loopback.shownCount(), std::uint64_t{0});
+    });
+
+    suite.add("pipeline/batch", [] {
+        LoopbackPipeline loopback;
+        std::vector<WinToastTemplate> toasts;
+        for (int i = 0; i < 32; i++) {
+            toasts.push_back(makeToast(std::to_wstring(i).c_str()));
+        }
+        toasts[7] = WinToastTemplate(Type::ImageAndText01);
+        toasts[7].setImagePath(std::wstring(300, L'a'));
+
+        const auto results = loopback.pipeline.show(toasts.data(), toasts.size(), true);
+        WINTOAST_CHECK_EQUAL(results.size(), toasts.size());
+        for (std::size_t i = 0; i < results.size(); i++) {
+            if (i == 7) {
+                WINTOAST_CHECK_EQUAL(results[i].id, INT64{-1});
+                WINTOAST_CHECK(results[i].error == WinToast::WinToastError::UnknownError);
+                continue;
+            }
+            WINTOAST_CHECK(results[i].error == WinToast::WinToastError::NoError);
+            WINTOAST_CHECK_EQUAL(loopback.loopback.find(results[i].id)->xml, payloadOf(toasts[i]));
+        }
+        WINTOAST_CHECK_EQUAL(loopback.loopback.liveCount(), toasts.size() - 1);
+    });
+
+    suite.add("pipeline/schedule", [] {
+        LoopbackPipeline loopback;
+        const auto now = std::chrono::system_clock::now();
+        WinToast::WinToastError error;
+        const INT64 first = loopback.pipeline.schedule(makeToast(L"1"), now + std::chrono::hours(1), true, error);
+        const INT64 second = loopback.pipeline.schedule(makeToast(L"2"), now + std::chrono::hours(2), true, error);
+        loopback.pipeline.schedule(makeToast(L"3"), now + std::chrono::hours(3), true, error);
+        WINTOAST_CHECK(first >= 0 && second >= 0);
+        WINTOAST_CHECK_EQUAL(loopback.loopback.scheduledCount(), std::size_t{3});
+
+        WINTOAST_CHECK(loopback.pipeline.cancelScheduled(first));
+        WINTOAST_CHECK(!loopback.pipeline.cancelScheduled(first));
+        WINTOAST_CHECK_EQUAL(loopback.pipeline.cancelScheduled(now, now + std::chrono::hours(3)), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(loopback.loopback.scheduledCount(), std::size_t{1});
+    });
+
+    suite.add("pipeline/clear", [] {
+        LoopbackPipeline loopback;
+        WinToast::WinToastError error;
+        for (int i = 0; i < 10; i++) {
+            loopback.pipeline.show(makeToast(std::to_wstring(i).c_str()), true, error);
+        }
+        loopback.pipeline.clear();
+        WINTOAST_CHECK_EQUAL(loopback.loopback.liveCount(), std::size_t{0});
+        WINTOAST_CHECK_EQUAL(loopback.loopback.hiddenCount(), std::uint64_t{10});
+    });
+
+    suite.add("pipeline/set_backend", [] {
+        LoopbackPipeline loopback;
+        loopback.pipeline.setAppUserModelId(L"Company.Product");
+        loopback.pipeline.setLiveToastLimit(64);
+        WINTOAST_CHECK_EQUAL(loopback.loopback.appUserModelId(), std::wstring(L"Company.Product"));
+
+        // The replacement gets the settings made before it.
+        auto replacement = std::make_unique<LoopbackBackend>();
+        LoopbackBackend &backend = *replacement;
+        loopback.pipeline.setBackend(std::move(replacement));
+        WINTOAST_CHECK_EQUAL(backend.appUserModelId(), std::wstring(L"Company.Product"));
+
+        WinToast::WinToastError error;
+        for (int i = 0; i < 100; i++) {
+            loopback.pipeline.show(makeToast(std::to_wstring(i).c_str()), true, error);
+        }
+        WINTOAST_CHECK_EQUAL(backend.shownCount(), std::uint64_t{100});
+        WINTOAST_CHECK_EQUAL(backend.liveCount(), std::size_t{64});
+    });
+}
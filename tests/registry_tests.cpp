@@ -0,0 +1,263 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "toast_registry.h"
+#include "file_time.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    constexpr std::size_t Producers = 16;
+    constexpr std::size_t Hiders = 4;
+    constexpr std::size_t Readers = 2;
+    constexpr std::uint64_t ToastsPerProducer = 2000;
+
+    // Ids shown but not hidden yet, shared by the producers and the hiders.
+    class PendingIds {
+    public:
+        void push(INT64 id, std::uint64_t value) {
+            std::lock_guard lock(_mutex);
+            _ids.emplace_back(id, value);
+        }
+
+        bool pop(std::pair<INT64, std::uint64_t> &entry) {
+            std::lock_guard lock(_mutex);
+            if (_ids.empty()) {
+                return false;
+            }
+            entry = _ids.back();
+            _ids.pop_back();
+            return true;
+        }
+
+        bool peek(std::size_t index, std::pair<INT64, std::uint64_t> &entry) {
+            std::lock_guard lock(_mutex);
+            if (_ids.empty()) {
+                return false;
+            }
+            entry = _ids[index % _ids.size()];
+            return true;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::pair<INT64, std::uint64_t>> _ids;
+    };
+
+    std::uint64_t valueOf(std::size_t producer, std::uint64_t sequence) {
+        return (static_cast<std::uint64_t>(producer) << 32) | sequence;
+    }
+
+    // 16 producers show toasts while hiders take them and readers look them up, every entry has to leave the
+    // registry exactly once: hidden, evicted or drained at the end.
+    void stress(std::size_t limit, bool expectEvictions) {
+        ToastRegistry<std::uint64_t> registry(limit);
+        PendingIds pending;
+        std::atomic<std::size_t> producing{Producers};
+        std::atomic<std::uint64_t> taken{0};
+        std::atomic<std::uint64_t> failures{0};
+        std::mutex seenMutex;
+        std::unordered_set<std::uint64_t> seen;
+
+        const auto remember = [&](std::uint64_t value) {
+            std::lock_guard lock(seenMutex);
+            if (!seen.insert(value).second) {
+                failures++;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < Producers; p++) {
+            threads.emplace_back([&, p] {
+                for (std::uint64_t i = 0; i < ToastsPerProducer; i++) {
+                    const INT64 id = registry.insert(valueOf(p, i));
+                    if (id <= 0) {
+                        failures++;
+                        continue;
+                    }
+                    pending.push(id, valueOf(p, i));
+                }
+                producing--;
+            });
+        }
+        for (std::size_t h = 0; h < Hiders; h++) {
+            threads.emplace_back([&] {
+                std::pair<INT64, std::uint64_t> entry;
+                for (;;) {
+                    const bool produced = producing.load() == 0;
+                    if (!pending.pop(entry)) {
+                        if (produced) {
+                            break;
+                        }
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    // The entry may have been evicted already, but never replaced by another one.
+                    if (const auto value = registry.take(entry.first)) {
+                        if (*value != entry.second) {
+                            failures++;
+                        }
+                        remember(*value);
+                        taken++;
+                    }
+                    if (registry.take(entry.first)) {
+                        failures++;
+                    }
+                }
+            });
+        }
+        for (std::size_t r = 0; r < Readers; r++) {
+            threads.emplace_back([&, r] {
+                std::pair<INT64, std::uint64_t> entry;
+                for (std::size_t i = r; producing.load() > 0; i += 7) {
+                    if (!pending.peek(i, entry)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    const auto value = registry.find(entry.first);
+                    if (value && *value != entry.second) {
+                        failures++;
+                    }
+                }
+            });
+        }
+        for (std::thread &thread: threads) {
+            thread.join();
+        }
+
+        std::uint64_t drained = 0;
+        for (const std::uint64_t value: registry.drain()) {
+            remember(value);
+            drained++;
+        }
+        const WinToast::LiveToastStats stats = registry.stats();
+
+        WINTOAST_CHECK_EQUAL(failures.load(), std::uint64_t{0});
+        WINTOAST_CHECK_EQUAL(taken.load() + drained + stats.evicted, Producers * ToastsPerProducer);
+        WINTOAST_CHECK_EQUAL(stats.resident, std::size_t{0});
+        WINTOAST_CHECK_EQUAL(stats.approximateBytes, std::size_t{0});
+        WINTOAST_CHECK_EQUAL(stats.evicted > 0, expectEvictions);
+    }
+}
+
+void WinToastTests::registryTests(Suite &suite) {
+    suite.add("registry/ids", [] {
+        ToastRegistry<int> registry;
+        const INT64 first = registry.insert(1);
+        WINTOAST_CHECK(first > 0);
+        WINTOAST_CHECK(registry.erase(first));
+
+        // A reused slot hands out a new id, the stale one finds nothing.
+        std::vector<INT64> ids;
+        for (int i = 0; i < 64; i++) {
+            ids.push_back(registry.insert(i));
+        }
+        WINTOAST_CHECK(std::find(ids.begin(), ids.end(), first) == ids.end());
+        WINTOAST_CHECK(!registry.find(first));
+        WINTOAST_CHECK(!registry.contains(first));
+        WINTOAST_CHECK_EQUAL(registry.find(ids[5]).value_or(-1), 5);
+        WINTOAST_CHECK(!registry.contains(-1));
+        WINTOAST_CHECK(!registry.contains(0x7fffffffffffffffLL));
+    });
+
+    suite.add("registry/restore", [] {
+        // A toast that failed to hide goes back under the id its owner knows.
+        ToastRegistry<int> registry;
+        const INT64 id = registry.insert(7);
+        const INT64 other = registry.insert(8);
+        auto value = registry.take(id);
+        WINTOAST_CHECK(value.has_value());
+        WINTOAST_CHECK(!registry.contains(id));
+        WINTOAST_CHECK(registry.restore(id, *value));
+        WINTOAST_CHECK_EQUAL(registry.find(id).value_or(-1), 7);
+        WINTOAST_CHECK_EQUAL(registry.size(), std::size_t{2});
+
+        // Only a taken id can be restored, and only once.
+        WINTOAST_CHECK(!registry.restore(id, 9));
+        WINTOAST_CHECK(!registry.restore(other, 9));
+        WINTOAST_CHECK(!registry.restore(-1, 9));
+        WINTOAST_CHECK_EQUAL(registry.find(other).value_or(-1), 8);
+
+        // Once the slot went to another toast, the old id can't come back.
+        ToastRegistry<int> reused;
+        const INT64 first = reused.insert(1);
+        reused.take(first);
+        // One insert per shard, so the shard of first hands its freed slot out again.
+        for (std::size_t i = 0; i < reused.shardCount(); i++) {
+            reused.insert(2);
+        }
+        WINTOAST_CHECK(!reused.restore(first, 1));
+        WINTOAST_CHECK(!reused.contains(first));
+        WINTOAST_CHECK_EQUAL(reused.size(), reused.shardCount());
+    });
+
+    suite.add("registry/restore_expiration", [] {
+        // A restored toast still expires when it was due to.
+        ToastRegistry<int> registry;
+        const INT64 id = registry.insert(1, FileTime::now() + 50 * 10000);
+        auto value = registry.take(id);
+        WINTOAST_CHECK(registry.restore(id, *value));
+        WINTOAST_CHECK(registry.contains(id));
+        for (int i = 0; i < 200 && registry.contains(id); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        WINTOAST_CHECK(!registry.contains(id));
+        WINTOAST_CHECK_EQUAL(registry.stats().expired, std::uint64_t{1});
+    });
+
+    suite.add("registry/limit", [] {
+        ToastRegistry<int> registry(64);
+        for (int i = 0; i < 1000; i++) {
+            registry.insert(i);
+        }
+        // The oldest entries made room for the newer ones.
+        WINTOAST_CHECK_EQUAL(registry.size(), std::size_t{64});
+        WINTOAST_CHECK_EQUAL(registry.stats().evicted, std::uint64_t{1000 - 64});
+        std::vector<int> values = registry.drain();
+        std::sort(values.begin(), values.end());
+        WINTOAST_CHECK_EQUAL(values.front(), 1000 - 64);
+    });
+
+    suite.add("registry/shard_count", [] {
+        const std::size_t shards = ToastRegistry<int>(1).shardCount();
+        WINTOAST_CHECK(shards >= 1 && shards <= ToastRegistry<int>::MaxShardCount);
+        WINTOAST_CHECK_EQUAL(shards & (shards - 1), std::size_t{0});
+        WINTOAST_CHECK(shards >= std::min<std::size_t>(std::thread::hardware_concurrency(),
+                                                       ToastRegistry<int>::MaxShardCount));
+    });
+
+    suite.add("registry/concurrent_show_hide", [] {
+        stress(2 * Producers * ToastsPerProducer, false);
+    });
+
+    suite.add("registry/concurrent_show_hide_evicting", [] {
+        stress(256, true);
+    });
+}
@@ -0,0 +1,96 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "schedule_index.h"
+
+#include <string>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+void WinToastTests::scheduleIndexTests(Suite &suite) {
+    suite.add("schedule_index/take", [] {
+        ScheduleIndex<std::string> index;
+        const INT64 id = index.insert(100, "first", 0);
+        index.insert(200, "second", 0);
+
+        const auto entry = index.take(id, 0);
+        WINTOAST_CHECK(entry.has_value());
+        WINTOAST_CHECK_EQUAL(entry->id, id);
+        WINTOAST_CHECK_EQUAL(entry->due, INT64{100});
+        WINTOAST_CHECK_EQUAL(entry->value, std::string("first"));
+        WINTOAST_CHECK(!index.take(id, 0));
+        WINTOAST_CHECK_EQUAL(index.size(), std::size_t{1});
+    });
+
+    suite.add("schedule_index/restore", [] {
+        // A toast the OS refused to cancel goes back under the same id and due time.
+        ScheduleIndex<std::string> index;
+        const INT64 id = index.insert(100, "reminder", 0);
+        auto entry = index.take(id, 0);
+        index.restore(std::move(*entry));
+        WINTOAST_CHECK_EQUAL(index.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(index.takeRange(100, 101, 0).size(), std::size_t{1});
+
+        index.restore({id, 100, "reminder"});
+        const auto restored = index.take(id, 0);
+        WINTOAST_CHECK(restored.has_value());
+        WINTOAST_CHECK_EQUAL(restored->value, std::string("reminder"));
+
+        // Ids handed out later don't collide with the restored one.
+        index.restore({id, 100, "reminder"});
+        WINTOAST_CHECK(index.insert(300, "later", 0) != id);
+    });
+
+    suite.add("schedule_index/take_range", [] {
+        ScheduleIndex<int> index;
+        for (int i = 0; i < 10; i++) {
+            index.insert(100 * (i + 1), i, 0);
+        }
+        const auto entries = index.takeRange(300, 600, 0);
+        WINTOAST_CHECK_EQUAL(entries.size(), std::size_t{3});
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            WINTOAST_CHECK_EQUAL(entries[i].value, static_cast<int>(i) + 2);
+        }
+        WINTOAST_CHECK_EQUAL(index.size(), std::size_t{7});
+    });
+
+    suite.add("schedule_index/reversed_range", [] {
+        // Swapped bounds, or an empty range, take nothing and leave the index intact.
+        ScheduleIndex<int> index;
+        index.insert(100, 1, 0);
+        index.insert(200, 2, 0);
+        index.insert(300, 3, 0);
+        WINTOAST_CHECK(index.takeRange(300, 100, 0).empty());
+        WINTOAST_CHECK(index.takeRange(200, 200, 0).empty());
+        WINTOAST_CHECK_EQUAL(index.size(), std::size_t{3});
+        WINTOAST_CHECK_EQUAL(index.takeRange(100, 301, 0).size(), std::size_t{3});
+    });
+
+    suite.add("schedule_index/due", [] {
+        // Entries whose due time passed are gone, the OS has shown them.
+        ScheduleIndex<int> index;
+        const INT64 id = index.insert(100, 1, 0);
+        index.insert(200, 2, 0);
+        WINTOAST_CHECK(!index.take(id, 150));
+        WINTOAST_CHECK_EQUAL(index.size(), std::size_t{1});
+    });
+}
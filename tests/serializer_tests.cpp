@@ -0,0 +1,444 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "toast_xml_serializer.h"
+#include "xml_escape.h"
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <winrt/Windows.Data.Xml.Dom.h>
+#include <winrt/Windows.UI.Notifications.h>
+#endif
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+
+    // The golden documents below follow what the DOM based showToast produced: the GetTemplateContent template
+    // of the type with its text and image filled in, then the attribution, the actions, the audio, the duration
+    // and the scenario added in that order, as returned by XmlDocument::GetXml(). They are written out so the
+    // tests run anywhere, on Windows serializer/matches_dom diffs the serializer against the DOM itself.
+    std::wstring serialize(const WinToastTemplate &toast, bool modernFeatures = true) {
+        std::wstring buffer;
+        WINTOAST_CHECK(ToastXmlSerializer::serialize(toast, modernFeatures, buffer));
+        return buffer;
+    }
+
+    WinToastTemplate makeToast(Type type) {
+        WinToastTemplate toast(type);
+        const wchar_t *lines[] = {L"Line 1", L"Line 2", L"Line 3"};
+        for (std::size_t i = 0; i < WinToastTemplate::textFieldsCountOf(type); i++) {
+            toast.setTextField(lines[i], WinToastTemplate::TextField(i));
+        }
+        if (WinToastTemplate::hasImageOf(type)) {
+            toast.setImagePath(LR"(C:\icons\app.png)");
+        }
+        return toast;
+    }
+
+    void checkEscapeMatchesScalar(std::wstring_view value) {
+        for (const XmlEscape::Context context: {XmlEscape::Context::Text, XmlEscape::Context::Attribute}) {
+            std::wstring escaped;
+            std::wstring scalar;
+            XmlEscape::append(escaped, value, context);
+            XmlEscape::appendScalar(scalar, value, context);
+            WINTOAST_CHECK_EQUAL(escaped, scalar);
+        }
+    }
+
+    struct Golden {
+        Type type;
+        const wchar_t *modern;
+        const wchar_t *legacy;
+    };
+
+    const Golden TypeGoldens[] = {
+            {Type::ImageAndText01,
+             LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText01"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastImageAndText01"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text></binding></visual></toast>)"},
+            {Type::ImageAndText02,
+             LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText02"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastImageAndText02"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual></toast>)"},
+            {Type::ImageAndText03,
+             LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText03"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastImageAndText03"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual></toast>)"},
+            {Type::ImageAndText04,
+             LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText04"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastImageAndText04"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text></binding></visual></toast>)"},
+            {Type::Text01,
+             LR"(<toast scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual></toast>)"},
+            {Type::Text02,
+             LR"(<toast scenario="Default"><visual><binding template="ToastText02"><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastText02"><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual></toast>)"},
+            {Type::Text03,
+             LR"(<toast scenario="Default"><visual><binding template="ToastText03"><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastText03"><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual></toast>)"},
+            {Type::Text04,
+             LR"(<toast scenario="Default"><visual><binding template="ToastText04"><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text></binding></visual><audio/></toast>)",
+             LR"(<toast><visual><binding template="ToastText04"><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text></binding></visual></toast>)"},
+    };
+
+#ifdef _WIN32
+    using namespace winrt::Windows::Data::Xml::Dom;
+    using namespace winrt::Windows::UI::Notifications;
+
+    // The payload the DOM based showToast built before the serializer replaced it, step by step.
+    std::wstring domPayloadOf(const WinToastTemplate &toast, bool modernFeatures) {
+        // ToastTemplateType lists the legacy templates in the order of WinToastTemplateType.
+        XmlDocument xml = ToastNotificationManager::GetTemplateContent(static_cast<ToastTemplateType>(toast.type()));
+
+        XmlNodeList textFields = xml.GetElementsByTagName(L"text");
+        for (std::uint32_t i = 0; i < toast.textFieldsCount(); i++) {
+            textFields.Item(i).InnerText(toast.textField(WinToastTemplate::TextField(i)));
+        }
+
+        if (modernFeatures) {
+            if (!toast.attributionText().empty()) {
+                XmlElement attribution = xml.CreateElement(L"text");
+                xml.SelectSingleNode(L"//binding[1]").AppendChild(attribution);
+                attribution.SetAttribute(L"placement", L"attribution");
+                attribution.InnerText(toast.attributionText());
+            }
+
+            XmlElement toastElement = xml.SelectSingleNode(L"//toast[1]").as<XmlElement>();
+            for (std::size_t i = 0; i < toast.actionsCount(); i++) {
+                IXmlNode actions = xml.SelectSingleNode(L"//actions[1]");
+                if (!actions) {
+                    toastElement.SetAttribute(L"template", L"ToastGeneric");
+                    toastElement.SetAttribute(L"duration", L"long");
+                    actions = xml.CreateElement(L"actions");
+                    toastElement.AppendChild(actions);
+                }
+                XmlElement action = xml.CreateElement(L"action");
+                action.SetAttribute(L"content", toast.actionLabel(i));
+                action.SetAttribute(L"arguments", L"actionId=" + std::to_wstring(i));
+                actions.AppendChild(action);
+            }
+
+            if (toast.audioPath().empty() && toast.audioOption() == WinToastTemplate::AudioOption::Default) {
+                toastElement.AppendChild(xml.CreateElement(L"audio"));
+            }
+            if (toast.duration() != WinToastTemplate::Duration::System) {
+                toastElement.SetAttribute(L"duration",
+                                          toast.duration() == WinToastTemplate::Duration::Short ? L"short" : L"long");
+            }
+            toastElement.SetAttribute(L"scenario", toast.scenario());
+        }
+
+        if (toast.hasImage()) {
+            xml.SelectSingleNode(L"//image[1]").as<XmlElement>().SetAttribute(L"src", L"file:///" + toast.imagePath());
+        }
+
+        const winrt::hstring payload = xml.GetXml();
+        return {payload.begin(), payload.end()};
+    }
+#endif
+}
+
+void WinToastTests::serializerTests(Suite &suite) {
+    suite.add("serializer/every_type", [] {
+        static_assert(std::size(TypeGoldens) == 8, "Every template type needs a golden document");
+        for (const Golden &golden: TypeGoldens) {
+            WINTOAST_CHECK_EQUAL(serialize(makeToast(golden.type)), std::wstring(golden.modern));
+        }
+    });
+
+    suite.add("serializer/every_type_legacy", [] {
+        for (const Golden &golden: TypeGoldens) {
+            WINTOAST_CHECK_EQUAL(serialize(makeToast(golden.type), false), std::wstring(golden.legacy));
+        }
+    });
+
+    suite.add("serializer/unset_fields", [] {
+        // The template keeps its empty text elements, and the image gets the bare prefix.
+        WINTOAST_CHECK_EQUAL(serialize(WinToastTemplate(Type::ImageAndText04)),
+                             std::wstring(LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText04"><image id="1" src="file:///"/><text id="1"/><text id="2"/><text id="3"/></binding></visual><audio/></toast>)"));
+
+        // A field left empty once the characters XML doesn't allow are dropped is written the same way.
+        WinToastTemplate toast(Type::Text02);
+        toast.setFirstLine(L"\x01\x02");
+        toast.setSecondLine(L"Line 2");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast scenario="Default"><visual><binding template="ToastText02"><text id="1"/><text id="2">Line 2</text></binding></visual><audio/></toast>)"));
+    });
+
+    suite.add("serializer/actions", [] {
+        WinToastTemplate toast = makeToast(Type::Text02);
+        toast.addAction(L"Yes");
+        toast.addAction(L"No");
+        toast.addAction(L"Later");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast template="ToastGeneric" duration="long" scenario="Default"><visual><binding template="ToastText02"><text id="1">Line 1</text><text id="2">Line 2</text></binding></visual><actions><action content="Yes" arguments="actionId=0"/><action content="No" arguments="actionId=1"/><action content="Later" arguments="actionId=2"/></actions><audio/></toast>)"));
+    });
+
+    suite.add("serializer/actions_with_duration", [] {
+        // Adding the first action set duration="long", an explicit duration overwrites it in place.
+        WinToastTemplate toast = makeToast(Type::Text01);
+        toast.addAction(L"Open");
+        toast.setDuration(WinToastTemplate::Duration::Short);
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast template="ToastGeneric" duration="short" scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><actions><action content="Open" arguments="actionId=0"/></actions><audio/></toast>)"));
+    });
+
+    suite.add("serializer/duration", [] {
+        WinToastTemplate toast = makeToast(Type::Text01);
+        toast.setDuration(WinToastTemplate::Duration::Long);
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast duration="long" scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)"));
+        toast.setDuration(WinToastTemplate::Duration::Short);
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast duration="short" scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)"));
+    });
+
+    suite.add("serializer/scenario", [] {
+        const std::pair<WinToastTemplate::Scenario, const wchar_t *> goldens[] = {
+                {WinToastTemplate::Scenario::Alarm,
+                 LR"(<toast scenario="Alarm"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)"},
+                {WinToastTemplate::Scenario::IncomingCall,
+                 LR"(<toast scenario="IncomingCall"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)"},
+                {WinToastTemplate::Scenario::Reminder,
+                 LR"(<toast scenario="Reminder"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)"},
+        };
+        for (const auto &[scenario, golden]: goldens) {
+            WinToastTemplate toast = makeToast(Type::Text01);
+            toast.setScenario(scenario);
+            WINTOAST_CHECK_EQUAL(serialize(toast), std::wstring(golden));
+        }
+    });
+
+    suite.add("serializer/attribution", [] {
+        WinToastTemplate toast = makeToast(Type::ImageAndText02);
+        toast.setAttributionText(L"via SMS");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast scenario="Default"><visual><binding template="ToastImageAndText02"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text><text placement="attribution">via SMS</text></binding></visual><audio/></toast>)"));
+    });
+
+    suite.add("serializer/audio", [] {
+        // The empty audio element is only added when neither a sound nor an audio option was chosen, every other
+        // combination leaves the audio to the system.
+        const std::wstring withAudio(
+                LR"(<toast scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual><audio/></toast>)");
+        const std::wstring withoutAudio(
+                LR"(<toast scenario="Default"><visual><binding template="ToastText01"><text id="1">Line 1</text></binding></visual></toast>)");
+
+        WinToastTemplate toast = makeToast(Type::Text01);
+        toast.setAudioOption(WinToastTemplate::AudioOption::Default);
+        WINTOAST_CHECK_EQUAL(serialize(toast), withAudio);
+
+        toast.setAudioOption(WinToastTemplate::AudioOption::Silent);
+        WINTOAST_CHECK_EQUAL(serialize(toast), withoutAudio);
+
+        toast.setAudioOption(WinToastTemplate::AudioOption::Loop);
+        WINTOAST_CHECK_EQUAL(serialize(toast), withoutAudio);
+
+        toast.setAudioOption(WinToastTemplate::AudioOption::Default);
+        toast.setAudioPath(WinToastTemplate::AudioSystemFile::Mail);
+        WINTOAST_CHECK_EQUAL(serialize(toast), withoutAudio);
+
+        toast.setAudioPath(L"ms-appx:///sounds/alert.wav");
+        toast.setAudioOption(WinToastTemplate::AudioOption::Silent);
+        WINTOAST_CHECK_EQUAL(serialize(toast), withoutAudio);
+    });
+
+    suite.add("serializer/everything", [] {
+        WinToastTemplate toast = makeToast(Type::ImageAndText04);
+        toast.setAttributionText(L"via Chat");
+        toast.addAction(L"Answer");
+        toast.addAction(L"Decline");
+        toast.setScenario(WinToastTemplate::Scenario::IncomingCall);
+        toast.setDuration(WinToastTemplate::Duration::Long);
+        toast.setAudioPath(WinToastTemplate::AudioSystemFile::Call);
+        toast.setAudioOption(WinToastTemplate::AudioOption::Loop);
+        toast.setExpiration(60000);
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast template="ToastGeneric" duration="long" scenario="IncomingCall"><visual><binding template="ToastImageAndText04"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text><text placement="attribution">via Chat</text></binding></visual><actions><action content="Answer" arguments="actionId=0"/><action content="Decline" arguments="actionId=1"/></actions></toast>)"));
+
+        // Without modern features only the text fields and the image are written.
+        WINTOAST_CHECK_EQUAL(serialize(toast, false),
+                             std::wstring(LR"(<toast><visual><binding template="ToastImageAndText04"><image id="1" src="file:///C:\icons\app.png"/><text id="1">Line 1</text><text id="2">Line 2</text><text id="3">Line 3</text></binding></visual></toast>)"));
+    });
+
+    suite.add("serializer/escaping", [] {
+        // Text nodes escape &, < and >, attributes also escape the double quote. Characters XML 1.0 doesn't
+        // allow are dropped instead of making Show fail.
+        WinToastTemplate toast(Type::ImageAndText01);
+        toast.setFirstLine(L"Tom & \"Jerry\" <3 'cheese' >_<\ttab\x01\x1f");
+        toast.setImagePath(LR"(C:\a&b\"quoted"<1>.png)");
+        toast.setAttributionText(L"R&D <team>");
+        toast.addAction(L"Say \"hi\" & <wave>");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(LR"(<toast template="ToastGeneric" duration="long" scenario="Default"><visual><binding template="ToastImageAndText01"><image id="1" src="file:///C:\a&amp;b\&quot;quoted&quot;&lt;1&gt;.png"/><text id="1">Tom &amp; "Jerry" &lt;3 'cheese' &gt;_&lt;)"
+                                          L"\ttab"
+                                          LR"(</text><text placement="attribution">R&amp;D &lt;team&gt;</text></binding></visual><actions><action content="Say &quot;hi&quot; &amp; &lt;wave&gt;" arguments="actionId=0"/></actions><audio/></toast>)"));
+    });
+
+    // Attribute values keep tab, line feed and carriage return as character references, normalization would
+    // turn them into spaces. Text nodes keep them as they are.
+    suite.add("serializer/attribute_whitespace", [] {
+        WinToastTemplate toast(Type::ImageAndText01);
+        toast.setFirstLine(L"a\tb > c");
+        toast.setImagePath(L"C:\\a\tb>c.png");
+        toast.addAction(L"Line 1\r\nLine 2\t> end");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(L"<toast template=\"ToastGeneric\" duration=\"long\" scenario=\"Default\"><visual>"
+                                          L"<binding template=\"ToastImageAndText01\">"
+                                          L"<image id=\"1\" src=\"file:///C:\\a&#9;b&gt;c.png\"/>"
+                                          L"<text id=\"1\">a\tb &gt; c</text></binding></visual><actions>"
+                                          L"<action content=\"Line 1&#13;&#10;Line 2&#9;&gt; end\" arguments=\"actionId=0\"/>"
+                                          L"</actions><audio/></toast>"));
+    });
+
+    // append() skips over plain runs 16 or 32 bytes at a time, every character needing care has to be found at
+    // every position around those widths, for both 16 and 32 bit wchar_t.
+    suite.add("serializer/escape_matches_scalar", [] {
+        std::vector<wchar_t> alphabet = {L'a', L'Z', L' ', L'&', L'<', L'>', L'"', L'\'', L'\t', L'\n', L'\r', 0,
+                                         0x08, 0x1f, 0x20, 0x7f, 0xe9, 0x2615, 0xd7ff, 0xd800, 0xdbff, 0xdc00,
+                                         0xdfff, 0xe000, 0xfffd, 0xfffe, 0xffff};
+        if constexpr (sizeof(wchar_t) == 4) {
+            for (const std::uint32_t unit: {0x1F600u, 0x10FFFFu, 0x110000u, 0x7FFFFFFFu}) {
+                alphabet.push_back(static_cast<wchar_t>(unit));
+            }
+        }
+
+        for (std::size_t length = 1; length <= 70; length++) {
+            for (std::size_t pos = 0; pos < length; pos++) {
+                for (const wchar_t c: alphabet) {
+                    std::wstring value(length, L'a');
+                    value[pos] = c;
+                    checkEscapeMatchesScalar(value);
+                }
+            }
+        }
+
+        std::mt19937 random(2022);
+        std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+        std::uniform_int_distribution<int> plain(0, 3);
+        for (std::size_t length = 0; length <= 100; length++) {
+            for (int round = 0; round < 50; round++) {
+                // Mostly plain characters, so runs long enough for the vector path come up.
+                std::wstring value(length, L'x');
+                for (wchar_t &c: value) {
+                    if (plain(random) == 0) {
+                        c = alphabet[pick(random)];
+                    }
+                }
+                checkEscapeMatchesScalar(value);
+            }
+        }
+    });
+
+    suite.add("serializer/non_ascii", [] {
+        WinToastTemplate toast(Type::Text02);
+        toast.setFirstLine(L"Caf\u00e9 \u2615");
+        toast.setSecondLine(L"\U0001F600 \uFFFE\uFFFF end");
+        WINTOAST_CHECK_EQUAL(serialize(toast),
+                             std::wstring(L"<toast scenario=\"Default\"><visual><binding template=\"ToastText02\">"
+                                          L"<text id=\"1\">Caf\u00e9 \u2615</text><text id=\"2\">\U0001F600  end</text>"
+                                          L"</binding></visual><audio/></toast>"));
+    });
+
+    suite.add("serializer/image_path_limit", [] {
+        // The DOM path built the image source in a MAX_PATH buffer holding the "file:///" prefix.
+        WinToastTemplate toast(Type::ImageAndText01);
+        toast.setImagePath(std::wstring(251, L'a'));
+        std::wstring buffer;
+        WINTOAST_CHECK(ToastXmlSerializer::serialize(toast, true, buffer));
+
+        toast.setImagePath(std::wstring(252, L'a'));
+        WINTOAST_CHECK(!ToastXmlSerializer::serialize(toast, true, buffer));
+    });
+
+#ifdef _WIN32
+    // The goldens above are checked against the DOM the serializer replaced, including the form of empty elements.
+    suite.add("serializer/matches_dom", [] {
+        winrt::init_apartment();
+
+        std::vector<WinToastTemplate> toasts;
+        for (const Golden &golden: TypeGoldens) {
+            toasts.push_back(makeToast(golden.type));
+            toasts.emplace_back(golden.type);
+        }
+
+        WinToastTemplate partial(Type::Text04);
+        partial.setSecondLine(L"Line 2");
+        toasts.push_back(partial);
+
+        WinToastTemplate everything = makeToast(Type::ImageAndText04);
+        everything.setAttributionText(L"via Chat");
+        everything.addAction(L"Answer");
+        everything.addAction(L"Decline");
+        everything.setScenario(WinToastTemplate::Scenario::IncomingCall);
+        everything.setDuration(WinToastTemplate::Duration::Short);
+        toasts.push_back(everything);
+
+        for (const WinToastTemplate::Scenario scenario: {WinToastTemplate::Scenario::Alarm,
+                                                         WinToastTemplate::Scenario::Reminder}) {
+            for (const WinToastTemplate::Duration duration: {WinToastTemplate::Duration::System,
+                                                             WinToastTemplate::Duration::Long}) {
+                WinToastTemplate toast = makeToast(Type::Text02);
+                toast.setScenario(scenario);
+                toast.setDuration(duration);
+                toast.setAudioOption(WinToastTemplate::AudioOption::Silent);
+                toasts.push_back(toast);
+            }
+        }
+
+        // Only characters XML allows, the DOM path didn't drop the others.
+        WinToastTemplate escaped(Type::ImageAndText02);
+        escaped.setFirstLine(L"Tom & \"Jerry\" <3 'cheese' >_<\ttab");
+        escaped.setSecondLine(L"Caf\u00e9 \u2615 \U0001F600");
+        escaped.setImagePath(LR"(C:\a&b\'quoted'<1>.png)");
+        escaped.setAttributionText(L"R&D <team>");
+        escaped.addAction(L"Say \"hi\" & <wave>");
+        toasts.push_back(escaped);
+
+        WinToastTemplate whitespace(Type::ImageAndText01);
+        whitespace.setFirstLine(L"a\tb > c");
+        whitespace.setImagePath(L"C:\\a\tb>c.png");
+        whitespace.addAction(L"Line 1\r\nLine 2\t> end");
+        toasts.push_back(whitespace);
+
+        for (const WinToastTemplate &toast: toasts) {
+            WINTOAST_CHECK_EQUAL(serialize(toast), domPayloadOf(toast, true));
+            WINTOAST_CHECK_EQUAL(serialize(toast, false), domPayloadOf(toast, false));
+        }
+    });
+#endif
+
+    suite.add("serializer/reused_buffer", [] {
+        std::wstring buffer;
+        WinToastTemplate first = makeToast(Type::ImageAndText04);
+        first.setAttributionText(L"first");
+        first.addAction(L"Open");
+        WINTOAST_CHECK(ToastXmlSerializer::serialize(first, true, buffer));
+
+        WINTOAST_CHECK(ToastXmlSerializer::serialize(makeToast(Type::Text01), true, buffer));
+        WINTOAST_CHECK_EQUAL(buffer, std::wstring(TypeGoldens[4].modern));
+    });
+}
@@ -0,0 +1,212 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "toast_xml_serializer.h"
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Type = WinToastTemplate::WinToastTemplateType;
+    using TextField = WinToastTemplate::TextField;
+
+    static_assert(std::is_nothrow_move_constructible_v<WinToastTemplate>);
+    static_assert(std::is_nothrow_move_assignable_v<WinToastTemplate>);
+    // A typed template is handed over through get(), never converted behind the caller's back.
+    static_assert(!std::is_convertible_v<const TypedToastTemplate<Type::Text02> &, const WinToastTemplate &>);
+
+    // Longer than any small string buffer, so a moved string keeps its characters where they were.
+    const std::wstring LongLine(64, L'x');
+
+    std::wstring payloadOf(const WinToastTemplate &toast) {
+        std::wstring buffer;
+        ToastXmlSerializer::serialize(toast, true, buffer);
+        return buffer;
+    }
+
+    WinToastTemplate makeWithSetters() {
+        WinToastTemplate toast(Type::ImageAndText04);
+        toast.setFirstLine(L"Build finished");
+        toast.setSecondLine(L"All tests passed");
+        toast.setTextField(L"In 3 minutes", TextField::ThirdLine);
+        toast.setImagePath(L"C:\\build.png");
+        toast.setAttributionText(L"via CI");
+        toast.setAudioPath(WinToastTemplate::AudioSystemFile::Mail);
+        toast.setAudioOption(WinToastTemplate::AudioOption::Loop);
+        toast.setDuration(WinToastTemplate::Duration::Long);
+        toast.setExpiration(60000);
+        toast.setScenario(WinToastTemplate::Scenario::Reminder);
+        toast.addAction(L"Open");
+        toast.addAction(L"Dismiss");
+        return toast;
+    }
+
+    WinToastTemplate makeWithBuilder() {
+        return WinToastTemplate::Builder(Type::ImageAndText04)
+                .firstLine(L"Build finished")
+                .secondLine(L"All tests passed")
+                .textField(L"In 3 minutes", TextField::ThirdLine)
+                .imagePath(L"C:\\build.png")
+                .attributionText(L"via CI")
+                .audioPath(WinToastTemplate::AudioSystemFile::Mail)
+                .audioOption(WinToastTemplate::AudioOption::Loop)
+                .duration(WinToastTemplate::Duration::Long)
+                .expiration(60000)
+                .scenario(WinToastTemplate::Scenario::Reminder)
+                .reserveActions(2)
+                .action(L"Open")
+                .action(L"Dismiss")
+                .build();
+    }
+}
+
+void WinToastTests::templateTests(Suite &suite) {
+    suite.add("template/builder_matches_setters", [] {
+        const WinToastTemplate built = makeWithBuilder();
+        const WinToastTemplate set = makeWithSetters();
+        WINTOAST_CHECK_EQUAL(payloadOf(built), payloadOf(set));
+        WINTOAST_CHECK(built.type() == set.type());
+        WINTOAST_CHECK_EQUAL(built.textFieldsCount(), set.textFieldsCount());
+        WINTOAST_CHECK_EQUAL(built.textFieldsView().size(), built.textFieldsCount());
+        WINTOAST_CHECK(std::equal(built.textFieldsView().begin(), built.textFieldsView().end(),
+                                  set.textFieldsView().begin(), set.textFieldsView().end()));
+        WINTOAST_CHECK_EQUAL(built.actionsCount(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(built.actionLabel(1), std::wstring(L"Dismiss"));
+        WINTOAST_CHECK_EQUAL(built.audioPath(), set.audioPath());
+        WINTOAST_CHECK_EQUAL(built.scenario(), std::wstring(L"Reminder"));
+        WINTOAST_CHECK(built.scenarioKind() == WinToastTemplate::Scenario::Reminder);
+        WINTOAST_CHECK_EQUAL(built.expiration(), INT64{60000});
+        WINTOAST_CHECK(built.duration() == WinToastTemplate::Duration::Long);
+        WINTOAST_CHECK(built.audioOption() == WinToastTemplate::AudioOption::Loop);
+    });
+
+    suite.add("template/builder_default_type", [] {
+        const WinToastTemplate built = WinToastTemplate::Builder().firstLine(L"Hello").build();
+        WinToastTemplate set;
+        set.setFirstLine(L"Hello");
+        WINTOAST_CHECK(built.type() == set.type());
+        WINTOAST_CHECK_EQUAL(payloadOf(built), payloadOf(set));
+    });
+
+    suite.add("template/move_construct", [] {
+        WinToastTemplate source = makeWithSetters();
+        const std::wstring expected = payloadOf(source);
+        source.setFirstLine(LongLine);
+        const wchar_t *characters = source.textField(TextField::FirstLine).data();
+
+        WinToastTemplate moved(std::move(source));
+        // The text fields change hands without a copy.
+        WINTOAST_CHECK(moved.textField(TextField::FirstLine).data() == characters);
+        WINTOAST_CHECK_EQUAL(moved.textField(TextField::FirstLine), LongLine);
+        moved.setFirstLine(L"Build finished");
+        WINTOAST_CHECK_EQUAL(payloadOf(moved), expected);
+    });
+
+    suite.add("template/move_assign", [] {
+        WinToastTemplate source = makeWithSetters();
+        const std::wstring expected = payloadOf(source);
+
+        WinToastTemplate target(Type::Text01);
+        target.setFirstLine(L"Overwritten");
+        target.addAction(L"Gone");
+        target = std::move(source);
+        WINTOAST_CHECK_EQUAL(payloadOf(target), expected);
+        WINTOAST_CHECK_EQUAL(target.actionsCount(), std::size_t{2});
+
+        // A moved from template can be assigned to and used again.
+        source = makeWithBuilder();
+        WINTOAST_CHECK_EQUAL(payloadOf(source), expected);
+    });
+
+    // Moved from templates and spent builders keep their type, so every text field of the type can be set again.
+    suite.add("template/moved_from", [] {
+        WinToastTemplate source = makeWithSetters();
+        const WinToastTemplate moved(std::move(source));
+        WINTOAST_CHECK(source.type() == Type::ImageAndText04);
+        WINTOAST_CHECK_EQUAL(source.textFieldsCount(), std::size_t{3});
+        WINTOAST_CHECK_EQUAL(source.textField(TextField::ThirdLine), std::wstring());
+        WINTOAST_CHECK_EQUAL(source.actionsCount(), std::size_t{0});
+        WINTOAST_CHECK_EQUAL(source.imagePath(), std::wstring());
+        source.setFirstLine(L"Build finished");
+        source.setSecondLine(L"All tests passed");
+        source.setThirdLine(L"In 3 minutes");
+        WINTOAST_CHECK_EQUAL(source.textField(TextField::ThirdLine), std::wstring(L"In 3 minutes"));
+
+        WinToastTemplate assigned(Type::Text02);
+        assigned = std::move(source);
+        WINTOAST_CHECK_EQUAL(source.textField(TextField::FirstLine), std::wstring());
+        source.setThirdLine(L"Again");
+        WINTOAST_CHECK_EQUAL(source.textField(TextField::ThirdLine), std::wstring(L"Again"));
+
+        WinToastTemplate::Builder builder(Type::Text04);
+        const WinToastTemplate built = builder.firstLine(L"First").build();
+        const WinToastTemplate rebuilt = builder.thirdLine(L"Third").build();
+        WINTOAST_CHECK(rebuilt.type() == Type::Text04);
+        WINTOAST_CHECK_EQUAL(rebuilt.textField(TextField::FirstLine), std::wstring());
+        WINTOAST_CHECK_EQUAL(rebuilt.textField(TextField::ThirdLine), std::wstring(L"Third"));
+        WINTOAST_CHECK_EQUAL(built.textField(TextField::FirstLine), std::wstring(L"First"));
+
+        // The same holds for a typed template whose template was moved out.
+        TypedToastTemplate<Type::Text02> typed;
+        typed.setFirstLine(L"Build finished");
+        const WinToastTemplate taken = std::move(typed).get();
+        typed.setSecondLine(L"All tests passed");
+        WINTOAST_CHECK_EQUAL(typed.textField<TextField::FirstLine>(), std::wstring());
+        WINTOAST_CHECK_EQUAL(typed.textField<TextField::SecondLine>(), std::wstring(L"All tests passed"));
+        WINTOAST_CHECK_EQUAL(taken.textField(TextField::FirstLine), std::wstring(L"Build finished"));
+    });
+
+    suite.add("template/copy", [] {
+        const WinToastTemplate original = makeWithSetters();
+        WinToastTemplate copy = original;
+        copy.setFirstLine(L"Changed");
+        copy.addAction(L"Snooze");
+        WINTOAST_CHECK_EQUAL(original.textField(TextField::FirstLine), std::wstring(L"Build finished"));
+        WINTOAST_CHECK_EQUAL(original.actionsCount(), std::size_t{2});
+        WINTOAST_CHECK_EQUAL(copy.actionsCount(), std::size_t{3});
+        WINTOAST_CHECK_EQUAL(payloadOf(WinToastTemplate(original)), payloadOf(makeWithBuilder()));
+    });
+
+    suite.add("template/sink_setters", [] {
+        WinToastTemplate toast(Type::Text02);
+        std::wstring line = LongLine;
+        const wchar_t *characters = line.data();
+        toast.setSecondLine(std::move(line));
+        WINTOAST_CHECK(toast.textField(TextField::SecondLine).data() == characters);
+    });
+
+    suite.add("template/typed_matches_untyped", [] {
+        TypedToastTemplate<Type::Text02> typed;
+        typed.setFirstLine(L"Build finished").setSecondLine(L"All tests passed").addAction(L"Open");
+        WinToastTemplate untyped(Type::Text02);
+        untyped.setFirstLine(L"Build finished");
+        untyped.setSecondLine(L"All tests passed");
+        untyped.addAction(L"Open");
+        WINTOAST_CHECK_EQUAL(payloadOf(typed.get()), payloadOf(untyped));
+        const WinToastTemplate moved = std::move(typed).get();
+        WINTOAST_CHECK_EQUAL(payloadOf(moved), payloadOf(untyped));
+    });
+}
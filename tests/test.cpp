@@ -0,0 +1,77 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+
+#include <cstdio>
+#include <exception>
+
+using namespace WinToastTests;
+
+void WinToastTests::fail(const char *file, int line, const std::string &message) {
+    throw Failure{std::string(file) + ":" + std::to_string(line) + ": " + message};
+}
+
+std::string WinToastTests::describe(std::wstring_view value) {
+    std::string text = "\"";
+    char escaped[16];
+    for (const wchar_t c: value) {
+        const auto unit = static_cast<unsigned long>(c);
+        if (unit >= 0x20 && unit < 0x7F && c != L'\\') {
+            text += static_cast<char>(c);
+        } else {
+            std::snprintf(escaped, sizeof(escaped), "\\x{%lx}", unit);
+            text += escaped;
+        }
+    }
+    return text + "\"";
+}
+
+Suite::Suite(std::string filter) : _filter(std::move(filter)) {}
+
+void Suite::add(const std::string &name, std::function<void()> body) {
+    if (_filter.empty() || name.find(_filter) != std::string::npos) {
+        _testCases.push_back(TestCase{name, std::move(body)});
+    }
+}
+
+int Suite::run() const {
+    if (_testCases.empty()) {
+        std::fprintf(stderr, "No test case matches \"%s\"\n", _filter.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    for (const TestCase &testCase: _testCases) {
+        try {
+            testCase.body();
+            std::fprintf(stderr, "[  OK  ] %s\n", testCase.name.c_str());
+        } catch (const Failure &failure) {
+            failures++;
+            std::fprintf(stderr, "[FAILED] %s\n%s\n", testCase.name.c_str(), failure.message.c_str());
+        } catch (const std::exception &e) {
+            failures++;
+            std::fprintf(stderr, "[FAILED] %s\nunexpected exception: %s\n", testCase.name.c_str(), e.what());
+        }
+    }
+
+    std::fprintf(stderr, "%zu test cases, %d failed\n", _testCases.size(), failures);
+    return failures;
+}
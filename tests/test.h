@@ -0,0 +1,138 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef WINTOAST_TEST_H
+#define WINTOAST_TEST_H
+
+#include <functional>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "wintoastlib.h"
+
+namespace WinToastTests {
+
+    // Thrown by a failed check, it ends the running test case.
+    struct Failure {
+        std::string message;
+    };
+
+    [[noreturn]] void fail(const char *file, int line, const std::string &message);
+
+    // Readable form of a value for failure messages, wide strings are written with non ASCII characters escaped.
+    std::string describe(std::wstring_view value);
+
+    inline std::string describe(const std::wstring &value) {
+        return describe(std::wstring_view(value));
+    }
+
+    template<typename T>
+    std::string describe(const T &value) {
+        std::ostringstream stream;
+        stream << value;
+        return stream.str();
+    }
+
+    template<typename T>
+    std::string describe(const std::optional<T> &value) {
+        return value ? describe(*value) : "nullopt";
+    }
+
+    class Suite {
+    public:
+        // Only test cases whose name contains filter run.
+        explicit Suite(std::string filter);
+
+        void add(const std::string &name, std::function<void()> body);
+
+        // Runs the selected test cases, reports the failures and returns how many there were. Selecting no test
+        // case at all counts as a failure, so a mistyped filter doesn't pass silently.
+        int run() const;
+
+    private:
+        struct TestCase {
+            std::string name;
+            std::function<void()> body;
+        };
+
+        std::string _filter;
+        std::vector<TestCase> _testCases;
+    };
+
+    void serializerTests(Suite &suite);
+
+    void pipelineTests(Suite &suite);
+
+    void deduplicatorTests(Suite &suite);
+
+    void scheduleIndexTests(Suite &suite);
+
+    void registryTests(Suite &suite);
+
+    void notifierCacheTests(Suite &suite);
+
+    void boundedQueueTests(Suite &suite);
+
+    void asyncSubmitterTests(Suite &suite);
+
+    void templateTests(Suite &suite);
+
+    void traceTests(Suite &suite);
+
+    void workerPoolTests(Suite &suite);
+
+    void activationDispatcherTests(Suite &suite);
+
+    void timingWheelTests(Suite &suite);
+
+    void percentCodecTests(Suite &suite);
+
+    void argumentsViewTests(Suite &suite);
+
+    void argumentsTests(Suite &suite);
+
+    void activationTests(Suite &suite);
+
+    void pipelineStatsTests(Suite &suite);
+}
+
+#define WINTOAST_CHECK(condition)                                                                   \
+    do {                                                                                            \
+        if (!(condition)) {                                                                         \
+            ::WinToastTests::fail(__FILE__, __LINE__, "WINTOAST_CHECK(" #condition ") failed");     \
+        }                                                                                           \
+    } while (false)
+
+#define WINTOAST_CHECK_EQUAL(actual, expected)                                                      \
+    do {                                                                                            \
+        const auto actualValue_ = (actual);                                                         \
+        const auto expectedValue_ = (expected);                                                     \
+        if (!(actualValue_ == expectedValue_)) {                                                    \
+            ::WinToastTests::fail(__FILE__, __LINE__,                                               \
+                                  "WINTOAST_CHECK_EQUAL(" #actual ", " #expected ") failed\n"       \
+                                  "    actual:   " + ::WinToastTests::describe(actualValue_) +      \
+                                  "\n    expected: " + ::WinToastTests::describe(expectedValue_));  \
+        }                                                                                           \
+    } while (false)
+
+#endif //WINTOAST_TEST_H
@@ -0,0 +1,218 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "expiry_scheduler.h"
+#include "test.h"
+#include "timing_wheel.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    constexpr std::uint64_t RangeTicks = std::uint64_t{1} << 36;
+
+    std::vector<std::uint64_t> advance(TimingWheel &wheel, std::uint64_t now) {
+        std::vector<std::uint64_t> expired;
+        wheel.advance(now, expired);
+        return expired;
+    }
+
+    // Collects what an ExpiryScheduler reports.
+    class Expirations {
+    public:
+        ExpiryScheduler::Callback callback() {
+            return [this](const std::vector<std::uint64_t> &keys) {
+                std::lock_guard lock(_mutex);
+                _keys.insert(_keys.end(), keys.begin(), keys.end());
+                _changed.notify_all();
+            };
+        }
+
+        bool waitFor(std::size_t count) {
+            std::unique_lock lock(_mutex);
+            return _changed.wait_for(lock, std::chrono::seconds(5), [&] { return _keys.size() >= count; });
+        }
+
+        std::vector<std::uint64_t> keys() {
+            std::lock_guard lock(_mutex);
+            return _keys;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::condition_variable _changed;
+        std::vector<std::uint64_t> _keys;
+    };
+}
+
+void WinToastTests::timingWheelTests(Suite &suite) {
+    suite.add("timing_wheel/same_tick", [] {
+        TimingWheel wheel;
+        wheel.schedule(1, 10);
+        wheel.schedule(5, 50);
+        wheel.schedule(5, 51);
+        wheel.schedule(63, 630);
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{4});
+
+        std::vector<std::uint64_t> expired = advance(wheel, 5);
+        WINTOAST_CHECK_EQUAL(expired.size(), std::size_t{3});
+        WINTOAST_CHECK_EQUAL(expired[0], std::uint64_t{10});
+        // Timers sharing a tick expire together, in no particular order.
+        WINTOAST_CHECK((expired[1] == 50 && expired[2] == 51) || (expired[1] == 51 && expired[2] == 50));
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{1});
+        WINTOAST_CHECK(advance(wheel, 62).empty());
+        WINTOAST_CHECK(advance(wheel, 63) == std::vector<std::uint64_t>{630});
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{0});
+    });
+
+    // Deadlines in the buckets of every level cascade down and expire exactly at their tick.
+    suite.add("timing_wheel/cascade", [] {
+        const std::uint64_t deadlines[] = {64, 100, 4095, 4096, 8262, 262143, 262145, 16777300, RangeTicks - 1};
+        TimingWheel wheel;
+        for (const std::uint64_t deadline: deadlines) {
+            wheel.schedule(deadline, deadline);
+        }
+        for (const std::uint64_t deadline: deadlines) {
+            WINTOAST_CHECK(advance(wheel, deadline - 1).empty());
+            WINTOAST_CHECK(advance(wheel, deadline) == std::vector<std::uint64_t>{deadline});
+        }
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{0});
+
+        // One large step expires them all, in deadline order.
+        TimingWheel jumping;
+        for (auto it = std::rbegin(deadlines); it != std::rend(deadlines); ++it) {
+            jumping.schedule(*it, *it);
+        }
+        WINTOAST_CHECK(advance(jumping, RangeTicks) == std::vector<std::uint64_t>(std::begin(deadlines),
+                                                                                    std::end(deadlines)));
+    });
+
+    // Deadlines past the six levels wait in the overflow bucket until the top level wraps.
+    suite.add("timing_wheel/beyond_range", [] {
+        TimingWheel wheel;
+        wheel.schedule(RangeTicks + 5, 1);
+        wheel.schedule(2 * RangeTicks + 1, 2);
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(RangeTicks));
+
+        WINTOAST_CHECK(advance(wheel, RangeTicks + 4).empty());
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(RangeTicks + 5));
+        WINTOAST_CHECK(advance(wheel, RangeTicks + 5) == std::vector<std::uint64_t>{1});
+
+        WINTOAST_CHECK(advance(wheel, 2 * RangeTicks).empty());
+        WINTOAST_CHECK(advance(wheel, 2 * RangeTicks + 1) == std::vector<std::uint64_t>{2});
+        WINTOAST_CHECK(!wheel.nextTick().has_value());
+    });
+
+    suite.add("timing_wheel/cancel", [] {
+        TimingWheel wheel;
+        const TimingWheel::Handle expiring = wheel.schedule(3, 3);
+        const TimingWheel::Handle cancelled = wheel.schedule(200, 200);
+        WINTOAST_CHECK(!wheel.cancel(TimingWheel::InvalidHandle));
+
+        WINTOAST_CHECK(wheel.cancel(cancelled));
+        WINTOAST_CHECK(!wheel.cancel(cancelled));
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{1});
+
+        WINTOAST_CHECK(advance(wheel, 3) == std::vector<std::uint64_t>{3});
+        WINTOAST_CHECK(!wheel.cancel(expiring));
+
+        // A new timer reusing the slot of an old one isn't reachable through the old handle.
+        const TimingWheel::Handle reused = wheel.schedule(10, 10);
+        WINTOAST_CHECK(reused != expiring && reused != cancelled);
+        WINTOAST_CHECK(!wheel.cancel(expiring));
+        WINTOAST_CHECK(!wheel.cancel(cancelled));
+        WINTOAST_CHECK_EQUAL(wheel.size(), std::size_t{1});
+        WINTOAST_CHECK(advance(wheel, 200) == std::vector<std::uint64_t>{10});
+        WINTOAST_CHECK(advance(wheel, 400).empty());
+    });
+
+    // Deadlines that already passed, zero included, expire on the next tick.
+    suite.add("timing_wheel/past_deadlines", [] {
+        TimingWheel wheel(100);
+        wheel.schedule(0, 1);
+        wheel.schedule(50, 2);
+        wheel.schedule(100, 3);
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(101));
+        WINTOAST_CHECK(advance(wheel, 100).empty());
+        WINTOAST_CHECK_EQUAL(advance(wheel, 101).size(), std::size_t{3});
+
+        TimingWheel fresh;
+        fresh.schedule(0, 1);
+        WINTOAST_CHECK(fresh.nextTick() == std::optional<std::uint64_t>(1));
+        WINTOAST_CHECK(advance(fresh, 1) == std::vector<std::uint64_t>{1});
+    });
+
+    suite.add("timing_wheel/next_tick", [] {
+        TimingWheel wheel;
+        WINTOAST_CHECK(!wheel.nextTick().has_value());
+
+        // A timer on level 1 is reported at the start of its bucket, where it cascades down.
+        wheel.schedule(200, 200);
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(192));
+        WINTOAST_CHECK(advance(wheel, 192).empty());
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(200));
+
+        // An earlier timer on level 0 comes first.
+        wheel.schedule(195, 195);
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(195));
+        advance(wheel, 195);
+        WINTOAST_CHECK(wheel.nextTick() == std::optional<std::uint64_t>(200));
+        advance(wheel, 200);
+        WINTOAST_CHECK(!wheel.nextTick().has_value());
+    });
+
+    suite.add("timing_wheel/scheduler_expires", [] {
+        Expirations expirations;
+        ExpiryScheduler scheduler(expirations.callback(), std::chrono::milliseconds(1));
+        const auto now = ExpiryScheduler::Clock::now();
+        scheduler.schedule(now + std::chrono::milliseconds(20), 2);
+        scheduler.schedule(now + std::chrono::milliseconds(5), 1);
+        const TimingWheel::Handle cancelled = scheduler.schedule(now + std::chrono::milliseconds(10), 3);
+        WINTOAST_CHECK(scheduler.cancel(cancelled));
+
+        WINTOAST_CHECK(expirations.waitFor(2));
+        WINTOAST_CHECK(expirations.keys() == std::vector<std::uint64_t>({1, 2}));
+        // Deadlines are rounded up to a tick, never down.
+        WINTOAST_CHECK(ExpiryScheduler::Clock::now() >= now + std::chrono::milliseconds(20));
+        WINTOAST_CHECK_EQUAL(scheduler.pending(), std::size_t{0});
+    });
+
+    // Destroying the scheduler with deadlines pending stops its thread without reporting them.
+    suite.add("timing_wheel/scheduler_stop", [] {
+        Expirations expirations;
+        const auto start = ExpiryScheduler::Clock::now();
+        {
+            ExpiryScheduler scheduler(expirations.callback(), std::chrono::milliseconds(1));
+            scheduler.schedule(start + std::chrono::hours(1), 1);
+            scheduler.schedule(start + std::chrono::milliseconds(30), 2);
+            WINTOAST_CHECK_EQUAL(scheduler.pending(), std::size_t{2});
+        }
+        WINTOAST_CHECK(ExpiryScheduler::Clock::now() - start < std::chrono::seconds(1));
+        WINTOAST_CHECK(expirations.keys().empty());
+    });
+}
@@ -0,0 +1,121 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "test.h"
+#include "trace.h"
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    using Level = WinToast::TraceLevel;
+    using Category = WinToast::TraceCategory;
+
+    // What a sink received, and on which threads.
+    struct Received {
+        std::mutex mutex;
+        std::vector<std::wstring> messages;
+        std::vector<std::thread::id> threads;
+
+        void add(const WinToast::TraceRecord &record) {
+            std::lock_guard lock(mutex);
+            messages.push_back(record.message);
+            threads.push_back(std::this_thread::get_id());
+        }
+    };
+
+    // Puts back the state main() set up, whatever a test case did to the sink and the filter.
+    struct RestoreTrace {
+        ~RestoreTrace() {
+            Trace::setSink(nullptr);
+            Trace::setFilter(Level::Off, 0);
+        }
+    };
+}
+
+void WinToastTests::traceTests(Suite &suite) {
+    suite.add("trace/flush", [] {
+        RestoreTrace restore;
+        auto received = std::make_shared<Received>();
+        Trace::setSink([received](const WinToast::TraceRecord &record) { received->add(record); });
+        for (int i = 0; i < 100; i++) {
+            Trace::submit(Level::Info, Category::Toast, L"record " + std::to_wstring(i));
+        }
+        Trace::flush();
+
+        std::lock_guard lock(received->mutex);
+        WINTOAST_CHECK_EQUAL(received->messages.size(), std::size_t{100});
+        WINTOAST_CHECK_EQUAL(received->messages.back(), std::wstring(L"record 99"));
+        // The sink runs on the drain thread, not on the one flushing.
+        for (const std::thread::id thread: received->threads) {
+            WINTOAST_CHECK(thread != std::this_thread::get_id());
+        }
+    });
+
+    suite.add("trace/reentrant_sink", [] {
+        RestoreTrace restore;
+        auto received = std::make_shared<Received>();
+        auto replacement = std::make_shared<Received>();
+        Trace::setSink([received, replacement](const WinToast::TraceRecord &record) {
+            received->add(record);
+            // None of these may wait for the drain that is calling the sink.
+            Trace::flush();
+            Trace::setFilter(Level::Warning, WinToast::AllTraceCategories);
+            if (record.message == L"switch") {
+                Trace::setSink([replacement](const WinToast::TraceRecord &next) { replacement->add(next); });
+            }
+        });
+        Trace::submit(Level::Warning, Category::Toast, L"first");
+        Trace::submit(Level::Warning, Category::Toast, L"switch");
+        Trace::flush();
+        Trace::submit(Level::Warning, Category::Toast, L"after");
+        Trace::flush();
+
+        {
+            std::lock_guard lock(received->mutex);
+            WINTOAST_CHECK_EQUAL(received->messages.size(), std::size_t{2});
+        }
+        std::lock_guard lock(replacement->mutex);
+        WINTOAST_CHECK_EQUAL(replacement->messages.size(), std::size_t{1});
+        WINTOAST_CHECK_EQUAL(replacement->messages.front(), std::wstring(L"after"));
+    });
+
+    suite.add("trace/throwing_sink", [] {
+        RestoreTrace restore;
+        auto received = std::make_shared<Received>();
+        Trace::setSink([received](const WinToast::TraceRecord &record) {
+            received->add(record);
+            throw std::runtime_error("sink failed");
+        });
+        Trace::submit(Level::Error, Category::Platform, L"lost");
+        Trace::submit(Level::Error, Category::Platform, L"kept going");
+        Trace::flush();
+
+        std::lock_guard lock(received->mutex);
+        WINTOAST_CHECK_EQUAL(received->messages.size(), std::size_t{2});
+    });
+}
@@ -0,0 +1,124 @@
+/* * Copyright (c) 2022 Roee Hershberg <roihershberg@protonmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "worker_pool.h"
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace WinToastLib;
+using namespace WinToastTests;
+
+namespace {
+    struct TaskError : std::runtime_error {
+        explicit TaskError(std::size_t index) : std::runtime_error("task failed"), index(index) {}
+
+        std::size_t index;
+    };
+
+    // Runs a loop that must fail and returns the index the rethrown TaskError carries, or count if nothing was
+    // thrown.
+    template<typename Task>
+    std::size_t failingLoop(WorkerPool &pool, std::size_t count, Task task) {
+        try {
+            pool.parallelFor(count, task);
+        } catch (const TaskError &error) {
+            return error.index;
+        }
+        return count;
+    }
+
+    void checkEveryIndexOnce(WorkerPool &pool, std::size_t count) {
+        std::vector<std::atomic<int>> calls(count);
+        pool.parallelFor(count, [&](std::size_t i) { calls[i]++; });
+        for (std::size_t i = 0; i < count; i++) {
+            WINTOAST_CHECK_EQUAL(calls[i].load(), 1);
+        }
+    }
+}
+
+void WinToastTests::workerPoolTests(Suite &suite) {
+    suite.add("worker_pool/every_index_once", [] {
+        WorkerPool pool(3);
+        checkEveryIndexOnce(pool, 0);
+        checkEveryIndexOnce(pool, 1);
+        checkEveryIndexOnce(pool, 1000);
+
+        WorkerPool inlinePool(0);
+        checkEveryIndexOnce(inlinePool, 100);
+    });
+
+    suite.add("worker_pool/throw_inline", [] {
+        WorkerPool pool(0);
+        std::atomic<std::size_t> calls{0};
+        const std::size_t failed = failingLoop(pool, 10, [&](std::size_t i) {
+            calls++;
+            if (i == 3) {
+                throw TaskError(i);
+            }
+        });
+        WINTOAST_CHECK_EQUAL(failed, std::size_t{3});
+        // The indices after the failing one are skipped.
+        WINTOAST_CHECK_EQUAL(calls.load(), std::size_t{4});
+    });
+
+    // The exception of a task on a pool thread reaches the caller instead of terminating the process.
+    suite.add("worker_pool/throw_on_worker", [] {
+        WorkerPool pool(2);
+        const std::thread::id caller = std::this_thread::get_id();
+        std::atomic<bool> workerThrew{false};
+        const std::size_t failed = failingLoop(pool, 100, [&](std::size_t i) {
+            if (std::this_thread::get_id() != caller) {
+                workerThrew = true;
+                throw TaskError(i);
+            }
+            // Hold the caller back until a worker took an index.
+            const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!workerThrew && std::chrono::steady_clock::now() < giveUp) {
+                std::this_thread::yield();
+            }
+        });
+        WINTOAST_CHECK(workerThrew.load());
+        WINTOAST_CHECK(failed < 100);
+
+        checkEveryIndexOnce(pool, 1000);
+    });
+
+    // The caller's own exception waits for the workers to leave the loop, which lives on the caller's stack.
+    suite.add("worker_pool/throw_on_caller", [] {
+        WorkerPool pool(2);
+        const std::thread::id caller = std::this_thread::get_id();
+        for (int round = 0; round < 20; round++) {
+            const std::size_t failed = failingLoop(pool, 50, [&](std::size_t i) {
+                if (std::this_thread::get_id() == caller) {
+                    throw TaskError(i);
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            });
+            WINTOAST_CHECK(failed < 50);
+        }
+
+        checkEveryIndexOnce(pool, 1000);
+    });
+}